@@ -4,6 +4,7 @@
 
 Buffer::Buffer()
 {
+    this->capacity = 0;
 }
 
 
@@ -53,6 +54,13 @@ size_t Buffer_Map::getSize()
 }
 
 
+// One tree node per entry: color, parent, left and right links next to the entry.
+size_t Buffer_Map::getMemoryUsage()
+{
+    return this->entries.size() * getAllocationSize(4*sizeof(void*) + sizeof(pair<const RecordId, Timestamp>));
+}
+
+
 void Buffer_Map::print(char c)
 {
     cout << "{";
@@ -64,19 +72,36 @@ void Buffer_Map::print(char c)
 }
 
 
+// Entries are written in id order and appended back at the end of the map, in constant time each.
+void Buffer_Map::save(SnapshotWriter &writer)
+{
+    vector<pair<RecordId, Timestamp> > entries(this->entries.begin(), this->entries.end());
+
+    writer.write(this->capacity);
+    writer.write(entries);
+}
+
+
+void Buffer_Map::load(Snapshot &snapshot)
+{
+    size_t size;
+
+    this->capacity = snapshot.read<size_t>();
+
+    const pair<RecordId, Timestamp> *entries = snapshot.view<pair<RecordId, Timestamp> >(size);
+
+    this->entries.clear();
+    for (size_t i = 0; i < size; i++)
+        this->entries.emplace_hint(this->entries.end(), entries[i]);
+}
+
+
 // Querying
 size_t Buffer_Map::execute_gOverlaps(RangeQuery Q)
 {
     size_t result = 0;
-    map<RecordId, Timestamp>::iterator iter, iterEnd = this->entries.end();
 
-    for (iter = this->entries.begin(); iter != iterEnd; iter++)
-    {
-        if (iter->second > Q.end)
-            break;
-
-        result ^= iter->first;
-    }
+    this->execute_gOverlaps<WorkloadAggregator>(Q, result);
 
     return result;
 }
@@ -85,11 +110,9 @@ size_t Buffer_Map::execute_gOverlaps(RangeQuery Q)
 size_t Buffer_Map::execute_gOverlaps()
 {
     size_t result = 0;
-    map<RecordId, Timestamp>::iterator iter, iterEnd = this->entries.end();
-    
-    for (iter = this->entries.begin(); iter != iterEnd; iter++)
-        result ^= iter->first;
-    
+
+    this->execute_gOverlaps<WorkloadAggregator>(result);
+
     return result;
 }
 
@@ -152,6 +175,13 @@ size_t Buffer_Vector::getSize()
 }
 
 
+// Removed entries are only marked, the vector never shrinks.
+size_t Buffer_Vector::getMemoryUsage()
+{
+    return getAllocationSize(this->entries);
+}
+
+
 void Buffer_Vector::print(char c)
 {
     cout << "{";
@@ -163,34 +193,39 @@ void Buffer_Vector::print(char c)
 }
 
 
+void Buffer_Vector::save(SnapshotWriter &writer)
+{
+    writer.write(this->capacity);
+    writer.write(this->minRecordId);
+    writer.write(this->entries);
+}
+
+
+void Buffer_Vector::load(Snapshot &snapshot)
+{
+    this->capacity    = snapshot.read<size_t>();
+    this->minRecordId = snapshot.read<RecordId>();
+    this->entries.reserve(this->capacity);
+    snapshot.read(this->entries);
+}
+
+
 size_t Buffer_Vector::execute_gOverlaps(RangeQuery Q)
 {
-    size_t result = 0, size = this->entries.size();
+    size_t result = 0;
+
+    this->execute_gOverlaps<WorkloadAggregator>(Q, result);
 
-    for (auto i = 0; i < size; i++)
-    {
-        auto &start = this->entries[i];
-        if (start > Q.end)
-            break;
-        
-        if (start != -1)
-            result ^= i+this->minRecordId;
-    }
-    
     return result;
 }
 
 
 size_t Buffer_Vector::execute_gOverlaps()
 {
-    size_t result = 0, size = this->entries.size();
+    size_t result = 0;
+
+    this->execute_gOverlaps<WorkloadAggregator>(result);
 
-    for (auto i = 0; i < size; i++)
-    {
-        if (this->entries[i] != -1)
-            result ^= i+this->minRecordId;
-    }
-    
     return result;
 }
 
@@ -230,6 +265,13 @@ size_t Buffer_List::getSize()
 }
 
 
+// One node per entry: previous and next links next to the entry.
+size_t Buffer_List::getMemoryUsage()
+{
+    return this->entries.size() * getAllocationSize(2*sizeof(void*) + sizeof(pair<RecordId, Timestamp>));
+}
+
+
 void Buffer_List::print(char c)
 {
     cout << "{";
@@ -241,37 +283,60 @@ void Buffer_List::print(char c)
 }
 
 
-size_t Buffer_List::execute_gOverlaps(RangeQuery Q){
-    // cout << "mphka3" << endl;
+void Buffer_List::save(SnapshotWriter &writer)
+{
+    vector<pair<RecordId, Timestamp> > entries(this->entries.begin(), this->entries.end());
+
+    writer.write(this->capacity);
+    writer.write(entries);
+}
+
+
+void Buffer_List::load(Snapshot &snapshot)
+{
+    size_t size;
+
+    this->capacity = snapshot.read<size_t>();
+
+    const pair<RecordId, Timestamp> *entries = snapshot.view<pair<RecordId, Timestamp> >(size);
+
+    this->entries.assign(entries, entries+size);
+}
+
+
+size_t Buffer_List::execute_gOverlaps(RangeQuery Q)
+{
     size_t result = 0;
-    list<pair<RecordId, Timestamp> >::iterator iter, iterStart, iterEnd;
-    iterStart = this->entries.begin();
-    iterEnd = this->entries.end();
-    for (iter = iterStart; iter != iterEnd; iter++)
-    {
-        if (iter->second > Q.end)
-            break;
-        
-        result ^= iter->first;
-    }
-    
+
+    this->execute_gOverlaps<WorkloadAggregator>(Q, result);
+
     return result;
 }
 
 
+size_t Buffer_List::execute_gOverlaps()
+{
+    size_t result = 0;
+
+    this->execute_gOverlaps<WorkloadAggregator>(result);
+
+    return result;
+}
+
 
 
-Buffer_ICDE16::Buffer_ICDE16()
+
+Buffer_ICDE16::Buffer_ICDE16() : Buffer(MAX_ICDE16_CAPACITY)
 {
     this->entries = new UnorderedHashMap<RecordId, pair<RecordId, Timestamp> >(MAX_ICDE16_CAPACITY);
-    this->secAttrs = new UnorderedHashMap<RecordId, pair<RecordId, Timestamp> >(MAX_ICDE16_CAPACITY);
+    this->secAttrs = new UnorderedHashMap<RecordId, pair<RecordId, int> >(MAX_ICDE16_CAPACITY);
 }
 
 
 Buffer_ICDE16::Buffer_ICDE16(size_t capacity) : Buffer(capacity)
 {
     this->entries = new UnorderedHashMap<RecordId, pair<RecordId, Timestamp> >(this->capacity);
-    this->secAttrs = new UnorderedHashMap<RecordId, pair<RecordId, Timestamp> >(this->capacity);
+    this->secAttrs = new UnorderedHashMap<RecordId, pair<RecordId, int> >(this->capacity);
 }
 
 
@@ -341,6 +406,12 @@ size_t Buffer_ICDE16::getSize()
 }
 
 
+size_t Buffer_ICDE16::getMemoryUsage()
+{
+    return getAllocationSize(sizeof(*this->entries)) + this->entries->getMemoryUsage() + getAllocationSize(sizeof(*this->secAttrs)) + this->secAttrs->getMemoryUsage();
+}
+
+
 void Buffer_ICDE16::print(char c)
 {
     cout << "{";
@@ -353,6 +424,32 @@ void Buffer_ICDE16::print(char c)
 }
 
 
+void Buffer_ICDE16::save(SnapshotWriter &writer)
+{
+    writer.write(this->capacity);
+    this->entries->save(writer);
+    this->secAttrs->save(writer);
+}
+
+
+// The hash maps are copied as they are, no entry is inserted again.
+void Buffer_ICDE16::load(Snapshot &snapshot)
+{
+    size_t capacity = snapshot.read<size_t>();
+
+    if (capacity != this->capacity)
+    {
+        delete this->entries;
+        delete this->secAttrs;
+        this->capacity = capacity;
+        this->entries  = new UnorderedHashMap<RecordId, pair<RecordId, Timestamp> >(this->capacity);
+        this->secAttrs = new UnorderedHashMap<RecordId, pair<RecordId, int> >(this->capacity);
+    }
+    this->entries->load(snapshot);
+    this->secAttrs->load(snapshot);
+}
+
+
 void Buffer_ICDE16::destroy()
 {
     delete this->entries;
@@ -370,40 +467,18 @@ Buffer_ICDE16::~Buffer_ICDE16()
 size_t Buffer_ICDE16::execute_gOverlaps(RangeQuery Q)
 {
     size_t result = 0;
-    auto iter = this->entries->begin(), iterEnd = this->entries->end();
-//    auto iter = this->entries.begin(), iterEnd = this->entries.end();
 
-    while (iter != iterEnd)
-    {
-        if (iter->second <= Q.end){
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->first;
-#endif
-            }
-        iter++;
-    }
-    
+    this->execute_gOverlaps<WorkloadAggregator>(Q, result);
+
     return result;
 }
 
 size_t Buffer_ICDE16::execute_gOverlaps()
 {
     size_t result = 0;
-    auto iter = this->entries->begin(), iterEnd = this->entries->end();
-//    auto iter = this->entries.begin(), iterEnd = this->entries.end();
 
-    while (iter != iterEnd)
-    {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->first;
-#endif
-        iter++;
-    }
-    
+    this->execute_gOverlaps<WorkloadAggregator>(result);
+
     return result;
 }
 
@@ -417,11 +492,7 @@ size_t Buffer_ICDE16::executeTimeTravel(RangeQuery Q, int secondAttrLowerConstra
     {
         if (iter->second <= Q.end)
             if((iterA->second) > secondAttrLowerConstraint && (iterA->second) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= iter->first;
-#endif
+                WorkloadAggregator::add(result, iter->first);
             }
         iter++;
         iterA++;
@@ -439,11 +510,7 @@ size_t Buffer_ICDE16::executeTimeTravel(int secondAttrLowerConstraint, int secon
     while (iter != iterEnd)
     {
         if((iterA->second) > secondAttrLowerConstraint && (iterA->second) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->first;
-#endif
+            WorkloadAggregator::add(result, iter->first);
         }
         iter++;
         iterA++;
@@ -462,11 +529,7 @@ size_t Buffer_ICDE16::executeTimeTravel_greaterthan(RangeQuery Q, int secondAttr
     {
         if (iter->second <= Q.end)
             if((iterA->second) > secondAttrLowerConstraint){
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->first;
-#endif
+            WorkloadAggregator::add(result, iter->first);
             }
         iter++;
         iterA++;
@@ -484,11 +547,7 @@ size_t Buffer_ICDE16::executeTimeTravel_greaterthan(int secondAttrLowerConstrain
     while (iter != iterEnd)
     {
         if((iterA->second) > secondAttrLowerConstraint){
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->first;
-#endif
+            WorkloadAggregator::add(result, iter->first);
         }
         iter++;
         iterA++;
@@ -507,11 +566,7 @@ size_t Buffer_ICDE16::executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUp
     {
         if (iter->second <= Q.end)
             if((iterA->second) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= iter->first;
-#endif            
+                WorkloadAggregator::add(result, iter->first);
         }
         iter++;
         iterA++;
@@ -529,11 +584,7 @@ size_t Buffer_ICDE16::executeTimeTravel_lowerthan(int secondAttrUpperConstraint)
     while (iter != iterEnd)
     {
         if((iterA->second) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->first;
-#endif
+            WorkloadAggregator::add(result, iter->first);
         }
         iter++;
         iterA++;
@@ -8,6 +8,7 @@
 #include <map>
 #include <list>
 #include "../containers/enhanced_HashMap.h"
+#include "../containers/snapshot.h"
 
 
 class Buffer
@@ -25,10 +26,17 @@ public:
     virtual Timestamp getMaxStart() {};
     virtual RecordId getMaxRecordId() {};
     virtual size_t getSize() {};
+    virtual size_t getMemoryUsage() { return 0; };
     virtual void print(char c) {};
     virtual void destroy() {};
 
-    // Querying
+    // Checkpointing, the contents are read back into a buffer constructed with the same capacity
+    virtual void save(SnapshotWriter &writer) {};
+    virtual void load(Snapshot &snapshot) {};
+
+    // Querying, through WorkloadAggregator; the buffers also offer the queries as templates on the aggregation policy,
+    // execute_gOverlaps<A>(Q, result) and execute_gOverlaps<A>(result) which add to result, called on the concrete type;
+    // visit_gOverlaps(qend, visit) calls visit(id, start) on the entries started by qend, for the cursors
     virtual size_t execute_gOverlaps(RangeQuery Q) { return 0; };
     virtual size_t execute_gOverlaps() { return 0; };
 
@@ -59,11 +67,45 @@ public:
     Timestamp remove_secAttr(RecordId id){};
     Timestamp remove(RecordId id);
     size_t getSize();
+    size_t getMemoryUsage();
     void print(char c);
+    void save(SnapshotWriter &writer);
+    void load(Snapshot &snapshot);
 
     // Querying
     size_t execute_gOverlaps(RangeQuery Q);
     size_t execute_gOverlaps();
+
+    template <class A>
+    void execute_gOverlaps(RangeQuery Q, typename A::Result &result)
+    {
+        for (auto iter = this->entries.begin(), iterEnd = this->entries.end(); iter != iterEnd; iter++)
+        {
+            if (iter->second > Q.end)
+                break;
+
+            A::add(result, iter->first);
+        }
+    };
+
+    template <class A>
+    void execute_gOverlaps(typename A::Result &result)
+    {
+        for (auto iter = this->entries.begin(), iterEnd = this->entries.end(); iter != iterEnd; iter++)
+            A::add(result, iter->first);
+    };
+
+    template <class Visit>
+    void visit_gOverlaps(Timestamp qend, Visit visit)
+    {
+        for (auto iter = this->entries.begin(), iterEnd = this->entries.end(); iter != iterEnd; iter++)
+        {
+            if (iter->second > qend)
+                break;
+
+            visit(iter->first, iter->second);
+        }
+    };
 };
 
 
@@ -84,11 +126,55 @@ public:
     Timestamp remove_secAttr(RecordId id){};
     Timestamp remove(RecordId id);
     size_t getSize();
+    size_t getMemoryUsage();
     void print(char c);
+    void save(SnapshotWriter &writer);
+    void load(Snapshot &snapshot);
 
     // Querying
     size_t execute_gOverlaps(RangeQuery Q);
     size_t execute_gOverlaps();
+
+    // Removed entries keep their slot with start -1
+    template <class A>
+    void execute_gOverlaps(RangeQuery Q, typename A::Result &result)
+    {
+        for (size_t i = 0; i < this->entries.size(); i++)
+        {
+            Timestamp start = this->entries[i];
+
+            if (start > Q.end)
+                break;
+
+            if (start != -1)
+                A::add(result, i+this->minRecordId);
+        }
+    };
+
+    template <class A>
+    void execute_gOverlaps(typename A::Result &result)
+    {
+        for (size_t i = 0; i < this->entries.size(); i++)
+        {
+            if (this->entries[i] != -1)
+                A::add(result, i+this->minRecordId);
+        }
+    };
+
+    template <class Visit>
+    void visit_gOverlaps(Timestamp qend, Visit visit)
+    {
+        for (size_t i = 0; i < this->entries.size(); i++)
+        {
+            Timestamp start = this->entries[i];
+
+            if (start > qend)
+                break;
+
+            if (start != -1)
+                visit(i+this->minRecordId, start);
+        }
+    };
 };
 
 
@@ -100,18 +186,52 @@ private:
 
 public:
     Buffer_List() {};
-    Buffer_List(size_t capacity) {};
+    Buffer_List(size_t capacity) : Buffer(capacity) {};
     void insert(RecordId id, Timestamp start);
 //    bool operator< (pair<RecordId, Timestamp> lhs, pair<RecordId, Timestamp> rhs);
     void insert_secAttr(RecordId id, Timestamp start, int secAttr){};
     Timestamp remove_secAttr(RecordId id){};
     Timestamp remove(RecordId id);
     size_t getSize();
+    size_t getMemoryUsage();
     void print(char c);
+    void save(SnapshotWriter &writer);
+    void load(Snapshot &snapshot);
 
     // Querying
     size_t execute_gOverlaps(RangeQuery Q);
-    size_t execute_gOverlaps() { return 0; };
+    size_t execute_gOverlaps();
+
+    template <class A>
+    void execute_gOverlaps(RangeQuery Q, typename A::Result &result)
+    {
+        for (auto iter = this->entries.begin(), iterEnd = this->entries.end(); iter != iterEnd; iter++)
+        {
+            if (iter->second > Q.end)
+                break;
+
+            A::add(result, iter->first);
+        }
+    };
+
+    template <class A>
+    void execute_gOverlaps(typename A::Result &result)
+    {
+        for (auto iter = this->entries.begin(), iterEnd = this->entries.end(); iter != iterEnd; iter++)
+            A::add(result, iter->first);
+    };
+
+    template <class Visit>
+    void visit_gOverlaps(Timestamp qend, Visit visit)
+    {
+        for (auto iter = this->entries.begin(), iterEnd = this->entries.end(); iter != iterEnd; iter++)
+        {
+            if (iter->second > qend)
+                break;
+
+            visit(iter->first, iter->second);
+        }
+    };
 };
 
 
@@ -133,7 +253,10 @@ public:
     Timestamp remove(RecordId id);
     Timestamp remove_secAttr(RecordId id);
     size_t getSize();
+    size_t getMemoryUsage();
     void print(char c);
+    void save(SnapshotWriter &writer);
+    void load(Snapshot &snapshot);
     void destroy();
     ~Buffer_ICDE16();
 
@@ -141,6 +264,34 @@ public:
     size_t execute_gOverlaps(RangeQuery Q);
     size_t execute_gOverlaps();
 
+    // Entries are not sorted on start, every one is compared
+    template <class A>
+    void execute_gOverlaps(RangeQuery Q, typename A::Result &result)
+    {
+        for (auto iter = this->entries->begin(), iterEnd = this->entries->end(); iter != iterEnd; iter++)
+        {
+            if (iter->second <= Q.end)
+                A::add(result, iter->first);
+        }
+    };
+
+    template <class A>
+    void execute_gOverlaps(typename A::Result &result)
+    {
+        for (auto iter = this->entries->begin(), iterEnd = this->entries->end(); iter != iterEnd; iter++)
+            A::add(result, iter->first);
+    };
+
+    template <class Visit>
+    void visit_gOverlaps(Timestamp qend, Visit visit)
+    {
+        for (auto iter = this->entries->begin(), iterEnd = this->entries->end(); iter != iterEnd; iter++)
+        {
+            if (iter->second <= qend)
+                visit(iter->first, iter->second);
+        }
+    };
+
     size_t executeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint);
     size_t executeTimeTravel(int secondAttrLowerConstraint, int secondAttrUpperConstraint);
 
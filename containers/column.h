@@ -0,0 +1,384 @@
+#ifndef _COLUMN_H_
+#define _COLUMN_H_
+
+#include "../def_global.h"
+#include "snapshot.h"
+#include <memory>
+#include <immintrin.h>
+
+
+
+// Contiguous column of a compacted layout, either owned or mapped from a snapshot.
+// Reading never copies; a mapped column is copied into memory of its own by the first change.
+// An owned column grows by an eighth at a time rather than doubling, so it never holds much more than its entries,
+// and shrinkToFit() drops the rest once the column receives no more of them.
+static const size_t COLUMN_GROWTH_DIVISOR = 8;
+
+template <class T>
+class Column
+{
+private:
+    vector<T> entries;
+    shared_ptr<Snapshot> snapshot;      // Keeps the mapping alive while the column is mapped
+    const T *mapped;
+    size_t numMapped;
+
+    void own()
+    {
+        if (!this->mapped)
+            return;
+
+        this->entries.assign(this->mapped, this->mapped+this->numMapped);
+        this->snapshot.reset();
+        this->mapped = NULL;
+    }
+
+    // Makes room for size entries.
+    void grow(size_t size)
+    {
+        if (size > this->entries.capacity())
+            this->entries.reserve(max(size, this->entries.capacity()+this->entries.capacity()/COLUMN_GROWTH_DIVISOR));
+    }
+
+public:
+    Column() : mapped(NULL), numMapped(0) {};
+
+    const T* data() const
+    {
+        return (this->mapped)? this->mapped: this->entries.data();
+    }
+
+    size_t size() const
+    {
+        return (this->mapped)? this->numMapped: this->entries.size();
+    }
+
+    bool empty() const
+    {
+        return (this->size() == 0);
+    }
+
+    const T& operator[](size_t i) const
+    {
+        return this->data()[i];
+    }
+
+    // Write access to the entries.
+    T* modify()
+    {
+        this->own();
+
+        return this->entries.data();
+    }
+
+    void push_back(const T &value)
+    {
+        this->own();
+        this->grow(this->entries.size()+1);
+        this->entries.push_back(value);
+    }
+
+    void append(const T *first, const T *last)
+    {
+        this->own();
+        this->grow(this->entries.size()+(last-first));
+        this->entries.insert(this->entries.end(), first, last);
+    }
+
+    void resize(size_t size)
+    {
+        this->own();
+        this->grow(size);
+        this->entries.resize(size);
+    }
+
+    // Drops entries [first, last).
+    void erase(size_t first, size_t last)
+    {
+        this->own();
+        this->entries.erase(this->entries.begin()+first, this->entries.begin()+last);
+    }
+
+    // Replaces the first n entries with [first, last), moving the others once.
+    void replace(size_t n, const T *first, const T *last)
+    {
+        size_t m = last-first, size;
+
+        this->own();
+        size = this->entries.size();
+        if (m > n)
+        {
+            this->grow(size+m-n);
+            this->entries.resize(size+m-n);
+            move_backward(this->entries.begin()+n, this->entries.begin()+size, this->entries.end());
+        }
+        else if (m < n)
+        {
+            move(this->entries.begin()+n, this->entries.end(), this->entries.begin()+m);
+            this->entries.resize(size-(n-m));
+        }
+        copy(first, last, this->entries.begin());
+    }
+
+    // Takes over the contents of entries, leaving it with the previous ones.
+    void assign(vector<T> &entries)
+    {
+        this->own();
+        this->entries.swap(entries);
+    }
+
+    // Gives the memory back once the column is down to half of it.
+    void shrink()
+    {
+        if (this->entries.size() <= this->entries.capacity()/2)
+            this->entries.shrink_to_fit();
+    }
+
+    // Gives back all the memory the entries do not occupy.
+    void shrinkToFit()
+    {
+        if (this->entries.size() < this->entries.capacity())
+            this->entries.shrink_to_fit();
+    }
+
+    void save(SnapshotWriter &writer) const
+    {
+        writer.write(this->data(), this->size());
+    }
+
+    void load(const shared_ptr<Snapshot> &snapshot)
+    {
+        this->entries.clear();
+        this->entries.shrink_to_fit();
+        this->mapped = snapshot->view<T>(this->numMapped);
+        this->snapshot = snapshot;
+    }
+
+    // Mapped entries count with their size, they occupy the page cache rather than the heap.
+    size_t getMemoryUsage() const
+    {
+        return (this->mapped)? this->numMapped*sizeof(T): getAllocationSize(this->entries);
+    }
+};
+
+
+
+// Column of 32-bit values bit-packed in blocks of PACKED_BLOCK_SIZE, each against its own frame of reference (FOR):
+// a block keeps its values minus the least of them, in just as many bits as the largest difference needs.
+// With Delta set, the differences between consecutive values are packed instead, which suits ids that lie close in arrival order.
+// Every block also keeps the range of its values, so a scan can take or skip a block as a whole without unpacking it.
+// Values are appended a whole block at a time; two spare words after the last block keep the 64-bit loads of unpacking in bounds.
+static const size_t PACKED_BLOCK_SIZE  = 128;
+static const size_t PACKED_SPARE_WORDS = 2;
+
+static inline bool detectPackedAvx2()
+{
+    __builtin_cpu_init();
+
+    return __builtin_cpu_supports("avx2");
+}
+
+static const bool packedAvx2 = detectPackedAvx2();
+
+template <bool Delta>
+class PackedColumn
+{
+public:
+    struct Block
+    {
+        int32_t min, max;       // Range of the values
+        int32_t first;          // First value, the differences are added to it
+        int32_t reference;      // Least packed value (or difference)
+        uint64_t offset;        // First word of the packed bits
+        uint32_t width;         // Bits per value
+    };
+
+private:
+    Column<Block> blocks;
+    Column<uint32_t> words;
+
+    // Bits of value i start at bit i*width of the block; arithmetic wraps around in 32 bits, as in packing.
+    static void decode_scalar(const Block &block, const uint32_t *words, int32_t *values)
+    {
+        uint64_t mask = (1ULL << block.width)-1;
+        uint32_t value = block.first;
+
+        for (size_t i = 0, bit = 0; i < PACKED_BLOCK_SIZE; i++, bit += block.width)
+        {
+            uint64_t bits;
+
+            memcpy(&bits, words+(bit >> 5), sizeof(bits));
+            if (Delta)
+                value += (uint32_t)((bits >> (bit & 31)) & mask) + (uint32_t)block.reference;
+            else
+                value = (uint32_t)((bits >> (bit & 31)) & mask) + (uint32_t)block.reference;
+            values[i] = value;
+        }
+    }
+
+    // AVX2, 8 values per iteration: each lane gathers the 64 bits holding its value, shifts and masks them,
+    // and the differences are summed up in the register before the carry of the previous 8 is added.
+    __attribute__((target("avx2")))
+    static void decode_avx2(const Block &block, const uint32_t *words, int32_t *values)
+    {
+        const __m256i lanes     = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i width     = _mm256_set1_epi32(block.width);
+        const __m256i mask      = _mm256_set1_epi64x((1ULL << block.width)-1);
+        const __m256i reference = _mm256_set1_epi32(block.reference);
+        const __m256i low       = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+        __m256i carry = _mm256_set1_epi32(block.first);
+
+        for (size_t i = 0; i < PACKED_BLOCK_SIZE; i += 8)
+        {
+            __m256i bit    = _mm256_mullo_epi32(_mm256_add_epi32(_mm256_set1_epi32(i), lanes), width);
+            __m256i word   = _mm256_srli_epi32(bit, 5);
+            __m256i shift  = _mm256_and_si256(bit, _mm256_set1_epi32(31));
+            __m256i first4 = _mm256_i32gather_epi64((const long long*)words, _mm256_castsi256_si128(word), 4);
+            __m256i last4  = _mm256_i32gather_epi64((const long long*)words, _mm256_extracti128_si256(word, 1), 4);
+
+            first4 = _mm256_and_si256(_mm256_srlv_epi64(first4, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(shift))), mask);
+            last4  = _mm256_and_si256(_mm256_srlv_epi64(last4, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(shift, 1))), mask);
+            first4 = _mm256_permutevar8x32_epi32(first4, low);
+            last4  = _mm256_permutevar8x32_epi32(last4, low);
+
+            __m256i v = _mm256_add_epi32(_mm256_permute2x128_si256(first4, last4, 0x20), reference);
+
+            if (Delta)
+            {
+                v = _mm256_add_epi32(v, _mm256_slli_si256(v, 4));
+                v = _mm256_add_epi32(v, _mm256_slli_si256(v, 8));
+                v = _mm256_add_epi32(v, _mm256_blend_epi32(_mm256_setzero_si256(), _mm256_permutevar8x32_epi32(v, _mm256_set1_epi32(3)), 0xF0));
+                v = _mm256_add_epi32(v, carry);
+                carry = _mm256_permutevar8x32_epi32(v, _mm256_set1_epi32(7));
+            }
+            _mm256_storeu_si256((__m256i*)(values+i), v);
+        }
+    }
+
+public:
+    size_t size() const
+    {
+        return this->blocks.size()*PACKED_BLOCK_SIZE;
+    }
+
+    bool empty() const
+    {
+        return this->blocks.empty();
+    }
+
+    const Block& getBlock(size_t b) const
+    {
+        return this->blocks[b];
+    }
+
+    // Packs the PACKED_BLOCK_SIZE values as a new block.
+    void append(const int32_t *values)
+    {
+        uint32_t packed[PACKED_BLOCK_SIZE], bits = 0;
+        Block block;
+
+        block.min = block.max = block.first = values[0];
+        block.reference = (Delta)? 0: values[0];
+        for (size_t i = 1; i < PACKED_BLOCK_SIZE; i++)
+        {
+            block.min = min(block.min, values[i]);
+            block.max = max(block.max, values[i]);
+            block.reference = min(block.reference, (Delta)? (int32_t)((uint32_t)values[i]-(uint32_t)values[i-1]): values[i]);
+        }
+        for (size_t i = 0; i < PACKED_BLOCK_SIZE; i++)
+        {
+            uint32_t value = (Delta)? ((i > 0)? (uint32_t)values[i]-(uint32_t)values[i-1]: 0): (uint32_t)values[i];
+
+            packed[i] = value-(uint32_t)block.reference;
+            bits |= packed[i];
+        }
+        block.width  = (bits)? 32-__builtin_clz(bits): 0;
+        block.offset = (this->words.empty())? 0: this->words.size()-PACKED_SPARE_WORDS;
+
+        // The spare words are zero and become the first of the block
+        this->words.resize(block.offset+PACKED_BLOCK_SIZE*block.width/32+PACKED_SPARE_WORDS);
+
+        uint32_t *words = this->words.modify()+block.offset;
+
+        for (size_t i = 0, bit = 0; i < PACKED_BLOCK_SIZE; i++, bit += block.width)
+        {
+            uint64_t value = (uint64_t)packed[i] << (bit & 31);
+
+            words[bit >> 5] |= (uint32_t)value;
+            if ((bit & 31)+block.width > 32)
+                words[(bit >> 5)+1] |= (uint32_t)(value >> 32);
+        }
+        this->blocks.push_back(block);
+    }
+
+    // Unpacks block b into values.
+    void decode(size_t b, int32_t *values) const
+    {
+        const Block &block = this->blocks[b];
+
+        if (packedAvx2)
+            decode_avx2(block, this->words.data()+block.offset, values);
+        else
+            decode_scalar(block, this->words.data()+block.offset, values);
+    }
+
+    // Replaces the first numBlocks blocks with those of front; the other blocks and their words are moved once.
+    void replaceFront(size_t numBlocks, const PackedColumn &front)
+    {
+        size_t from, numFrontWords;
+
+        if ((numBlocks == 0) && (front.empty()))
+            return;
+        if ((numBlocks == this->blocks.size()) && (front.empty()))
+        {
+            this->clear();
+            return;
+        }
+
+        // Blocks take whole words; the spare words after the last block stay, unless no block is left
+        from = (numBlocks < this->blocks.size())? this->blocks[numBlocks].offset: this->words.size();
+        if (front.empty())
+            numFrontWords = 0;
+        else if (numBlocks < this->blocks.size())
+            numFrontWords = front.words.size()-PACKED_SPARE_WORDS;
+        else
+            numFrontWords = front.words.size();
+        this->words.replace(from, front.words.data(), front.words.data()+numFrontWords);
+        this->blocks.replace(numBlocks, front.blocks.data(), front.blocks.data()+front.blocks.size());
+
+        Block *blocks = this->blocks.modify();
+
+        for (size_t b = front.blocks.size(); b < this->blocks.size(); b++)
+            blocks[b].offset = blocks[b].offset-from+numFrontWords;
+    }
+
+    void clear()
+    {
+        this->blocks = Column<Block>();
+        this->words  = Column<uint32_t>();
+    }
+
+    void shrinkToFit()
+    {
+        this->blocks.shrinkToFit();
+        this->words.shrinkToFit();
+    }
+
+    void save(SnapshotWriter &writer) const
+    {
+        this->blocks.save(writer);
+        this->words.save(writer);
+    }
+
+    void load(const shared_ptr<Snapshot> &snapshot)
+    {
+        this->blocks.load(snapshot);
+        this->words.load(snapshot);
+    }
+
+    size_t getMemoryUsage() const
+    {
+        return this->blocks.getMemoryUsage() + this->words.getMemoryUsage();
+    }
+};
+#endif // _COLUMN_H_
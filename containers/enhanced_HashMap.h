@@ -1,6 +1,8 @@
 #pragma once
 
 #include "Util.h"
+#include "../def_global.h"
+#include "snapshot.h"
 
 
 
@@ -176,6 +178,43 @@ public:
 	}
 
 
+	// The table, nodes and values are allocated once for the capacity, so the memory does not change with the contents.
+	size_t getMemoryUsage() const noexcept
+	{
+		size_t capacity = bound - nodes;
+
+		return getAllocationSize(tableSize * sizeof(Ref)) + getAllocationSize(capacity * sizeof(Node)) + getAllocationSize(capacity * sizeof(V));
+	}
+
+
+	// Nodes link by index, so the table and the used nodes and values are written and read back as they are;
+	// the map read into must have the capacity of the one written.
+	void save(SnapshotWriter &writer) const noexcept
+	{
+		writer.write(table, tableSize);
+		writer.write(nodes, size_t(tail - nodes));
+		writer.write(values, size());
+	}
+
+
+	void load(Snapshot &snapshot)
+	{
+		size_t numSlots, numNodes, numValues;
+		const Ref*  slots       = snapshot.view<Ref>(numSlots);
+		const Node* savedNodes  = snapshot.view<Node>(numNodes);
+		const V*    savedValues = snapshot.view<V>(numValues);
+
+		if ((numSlots != tableSize) || (numNodes > size_t(bound - nodes)) || (numValues != numNodes))
+			throw std::runtime_error("Snapshot of a hash map with another capacity");
+
+		std::memcpy(table, slots, numSlots * sizeof(Ref));
+		std::memcpy(nodes, savedNodes, numNodes * sizeof(Node));
+		std::memcpy(values, savedValues, numValues * sizeof(V));
+		tail       = nodes + numNodes;
+		valuesTail = values + numValues;
+	}
+
+
 
 	UnorderedHashMap& operator=(const UnorderedHashMap&) = delete;
 	UnorderedHashMap(const UnorderedHashMap&) = delete;
@@ -79,4 +79,26 @@ typedef Offsets_ALL_OrgsIn::const_iterator  Offsets_ALL_OrgsIn_Iterator;
 typedef Offsets_ALL_OrgsAft::const_iterator Offsets_ALL_OrgsAft_Iterator;
 typedef Offsets_ALL_RepsIn::const_iterator  Offsets_ALL_RepsIn_Iterator;
 typedef Offsets_ALL_RepsAft::const_iterator Offsets_ALL_RepsAft_Iterator;
+
+
+
+// Entry of the directory of a compacted level of HINT_M_Dynamic (see FrozenPartitions), laid out as OffsetEntry_ALL:
+// the position of the partition in the columns stands for both iterI and iterT, as the ids and timestamps are aligned,
+// and stays valid while the columns are reallocated or mapped from a snapshot. Compared inline, on the partition id.
+class OffsetEntry_ALL_Frozen
+{
+public:
+    PartitionId pid;
+    size_t offset;
+
+    bool operator < (const OffsetEntry_ALL_Frozen &rhs) const
+    {
+        return this->pid < rhs.pid;
+    }
+
+    bool operator >= (const OffsetEntry_ALL_Frozen &rhs) const
+    {
+        return this->pid >= rhs.pid;
+    }
+};
 #endif //_OFFSETS_H_
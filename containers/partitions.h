@@ -0,0 +1,984 @@
+#ifndef _PARTITIONS_H_
+#define _PARTITIONS_H_
+
+#include "../def_global.h"
+#include "relation.h"
+#include "offsets.h"
+#include "column.h"
+#include <type_traits>
+#include <memory>
+
+
+
+// The partitions of one HINT level, allocated lazily in fixed-size blocks on first touch.
+// Growing the level only extends the directory of block pointers; existing partitions are never moved or reallocated.
+// Partitions that were never touched (or lie beyond the directory) read as empty (value-initialized).
+// The memory of the directory and the blocks is kept up to date, the memory the partitions own on the heap is left to the caller.
+template <class T>
+class PartitionBlocks
+{
+private:
+    static const size_t BLOCK_BITS = 6;
+    static const size_t BLOCK_SIZE = 1 << BLOCK_BITS;
+    static const size_t BLOCK_MASK = BLOCK_SIZE-1;
+
+    vector<T*> blocks;
+    size_t memoryUsage;
+
+    // new[] keeps the number of elements in front of an array that needs destructors
+    static size_t getBlockMemoryUsage()
+    {
+        return getAllocationSize(BLOCK_SIZE*sizeof(T) + (is_trivially_destructible<T>::value? 0: sizeof(size_t)));
+    }
+
+    static const T& empty()
+    {
+        static const T e{};
+
+        return e;
+    }
+
+    void destroy()
+    {
+        for (auto b : this->blocks)
+            delete[] b;
+        this->blocks.clear();
+        this->memoryUsage = getAllocationSize(this->blocks);
+    }
+
+public:
+    PartitionBlocks() : memoryUsage(0) {};
+
+    PartitionBlocks(const PartitionBlocks &P)
+    {
+        this->blocks.resize(P.blocks.size(), NULL);
+        this->memoryUsage = getAllocationSize(this->blocks);
+        for (size_t i = 0; i < P.blocks.size(); i++)
+        {
+            if (P.blocks[i])
+            {
+                this->blocks[i] = new T[BLOCK_SIZE];
+                copy(P.blocks[i], P.blocks[i]+BLOCK_SIZE, this->blocks[i]);
+                this->memoryUsage += getBlockMemoryUsage();
+            }
+        }
+    }
+
+    PartitionBlocks(PartitionBlocks &&P) noexcept : blocks(move(P.blocks)), memoryUsage(P.memoryUsage)
+    {
+        P.blocks.clear();
+        P.memoryUsage = getAllocationSize(P.blocks);
+    };
+
+    PartitionBlocks& operator=(PartitionBlocks P) noexcept
+    {
+        swap(this->blocks, P.blocks);
+        swap(this->memoryUsage, P.memoryUsage);
+
+        return *this;
+    }
+
+    ~PartitionBlocks()
+    {
+        this->destroy();
+    }
+
+
+    // Read access, does not allocate.
+    const T& operator[](size_t pid) const
+    {
+        size_t bid = pid >> BLOCK_BITS;
+
+        if ((bid >= this->blocks.size()) || (!this->blocks[bid]))
+            return empty();
+
+        return this->blocks[bid][pid & BLOCK_MASK];
+    }
+
+    // Write access, allocates the block that holds pid on first touch.
+    T& touch(size_t pid)
+    {
+        size_t bid = pid >> BLOCK_BITS;
+
+        if (bid >= this->blocks.size())
+        {
+            this->memoryUsage -= getAllocationSize(this->blocks);
+            this->blocks.resize(bid+1, NULL);
+            this->memoryUsage += getAllocationSize(this->blocks);
+        }
+        if (!this->blocks[bid])
+        {
+            this->blocks[bid] = new T[BLOCK_SIZE]();
+            this->memoryUsage += getBlockMemoryUsage();
+        }
+
+        return this->blocks[bid][pid & BLOCK_MASK];
+    }
+
+    // Drops the contents of partitions [0, numPartitions), whole blocks are freed.
+    void release(size_t numPartitions)
+    {
+        size_t numBlocks = min(numPartitions >> BLOCK_BITS, this->blocks.size());
+
+        for (size_t bid = 0; bid < numBlocks; bid++)
+        {
+            if (this->blocks[bid])
+                this->memoryUsage -= getBlockMemoryUsage();
+            delete[] this->blocks[bid];
+            this->blocks[bid] = NULL;
+        }
+        for (size_t pid = numBlocks << BLOCK_BITS; pid < min(numPartitions, this->size()); pid++)
+        {
+            if (this->isAllocated(pid))
+                this->touch(pid) = T();
+        }
+    }
+
+    bool isAllocated(size_t pid) const
+    {
+        size_t bid = pid >> BLOCK_BITS;
+
+        return ((bid < this->blocks.size()) && (this->blocks[bid]));
+    }
+
+    // Upper bound on the ids of the touched partitions.
+    size_t size() const
+    {
+        return this->blocks.size()*BLOCK_SIZE;
+    }
+
+    size_t getMemoryUsage() const
+    {
+        return this->memoryUsage;
+    }
+};
+
+
+
+// Skewness & sparsity: ascending ids of the non-empty partitions of one level of a subdivision,
+// so that a range of partitions is visited by jumping between non-empty ones (cf. Offsets_SS_*).
+class PartitionDirectory
+{
+public:
+    vector<PartitionId> pids;
+
+    // Position of the first non-empty partition at or after pid.
+    size_t find(PartitionId pid) const
+    {
+        return lower_bound(this->pids.begin(), this->pids.end(), pid)-this->pids.begin();
+    }
+
+    // Registers partition pid, which just received its first entry; the streams mostly append at the end.
+    void insert(PartitionId pid)
+    {
+        if ((this->pids.empty()) || (this->pids.back() < pid))
+            this->pids.push_back(pid);
+        else
+        {
+            auto iter = lower_bound(this->pids.begin(), this->pids.end(), pid);
+
+            if (*iter != pid)
+                this->pids.insert(iter, pid);
+        }
+    }
+
+    // Drops partitions [0, numPartitions).
+    void release(PartitionId numPartitions)
+    {
+        this->pids.erase(this->pids.begin(), this->pids.begin()+this->find(numPartitions));
+    }
+
+    size_t getMemoryUsage() const
+    {
+        return getAllocationSize(this->pids);
+    }
+};
+
+
+
+// Timestamp c of an entry: the start (0) or the end (1) of a pair, or the endpoint itself.
+static inline LocalTimestamp getTimestampComponent(const pair<LocalTimestamp, LocalTimestamp> &timestamp, int c)
+{
+    return (c == 0)? timestamp.first: timestamp.second;
+}
+
+static inline LocalTimestamp getTimestampComponent(LocalTimestamp timestamp, int)
+{
+    return timestamp;
+}
+
+static inline void setTimestampComponent(pair<LocalTimestamp, LocalTimestamp> &timestamp, int c, LocalTimestamp value)
+{
+    ((c == 0)? timestamp.first: timestamp.second) = value;
+}
+
+static inline void setTimestampComponent(LocalTimestamp &timestamp, int, LocalTimestamp value)
+{
+    timestamp = value;
+}
+
+
+
+// Zone map of a partition: the lowest and the highest value of each component of its timestamp entries,
+// e.g., the range of the starts and the range of the ends for a pair. The zone of an empty partition is empty,
+// its lowest values lie above its highest, so every comparison against it skips the partition.
+template <class T>
+struct ZoneMap
+{
+    static const int NUM_COMPONENTS = sizeof(T)/sizeof(LocalTimestamp);
+    T min, max;
+
+    ZoneMap()
+    {
+        for (int c = 0; c < NUM_COMPONENTS; c++)
+        {
+            setTimestampComponent(this->min, c, numeric_limits<LocalTimestamp>::max());
+            setTimestampComponent(this->max, c, numeric_limits<LocalTimestamp>::min());
+        }
+    }
+
+    void add(const T &timestamp)
+    {
+        for (int c = 0; c < NUM_COMPONENTS; c++)
+        {
+            setTimestampComponent(this->min, c, std::min(getTimestampComponent(this->min, c), getTimestampComponent(timestamp, c)));
+            setTimestampComponent(this->max, c, std::max(getTimestampComponent(this->max, c), getTimestampComponent(timestamp, c)));
+        }
+    }
+
+    LocalTimestamp getMin(int c) const
+    {
+        return getTimestampComponent(this->min, c);
+    }
+
+    LocalTimestamp getMax(int c) const
+    {
+        return getTimestampComponent(this->max, c);
+    }
+};
+
+
+
+// Aggregates of a run of (start, end) entries sorted on start, which count or XOR the entries overlapping a query in O(log n).
+// An entry starting after qend also ends after qstart, so the overlapping entries are the ones starting by qend
+// minus the ones ending before qstart, which all start by qend; both are prefixes, of the run and of its ends in ascending order.
+// Only the policies with HAS_AGGREGATES use them, see def_global.h.
+class OverlapAggregates
+{
+private:
+    vector<RecordId> startXors;     // XOR of the ids before each entry of the run, plus of all
+    vector<LocalTimestamp> ends;    // Ends of the run, ascending
+    vector<RecordId> endXors;       // XOR of the ids before each of the ends, plus of all
+
+public:
+    // Length of the run the aggregates were built from.
+    size_t size() const
+    {
+        return this->ends.size();
+    }
+
+    // The ids are offsets from idBase; the XORs are of the ids themselves.
+    void build(RecordId idBase, const LocalRecordId *ids, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size)
+    {
+        vector<pair<LocalTimestamp, LocalRecordId> > entries;
+
+        entries.reserve(size);
+        this->startXors.assign(1, 0);
+        this->startXors.reserve(size+1);
+        for (size_t i = 0; i < size; i++)
+        {
+            this->startXors.push_back(this->startXors.back() ^ (idBase+ids[i]));
+            entries.emplace_back(timestamps[i].second, ids[i]);
+        }
+        sort(entries.begin(), entries.end());
+
+        this->ends.resize(size);
+        this->endXors.assign(1, 0);
+        this->endXors.reserve(size+1);
+        for (size_t i = 0; i < size; i++)
+        {
+            this->ends[i] = entries[i].first;
+            this->endXors.push_back(this->endXors.back() ^ (idBase+entries[i].second));
+        }
+        this->ends.shrink_to_fit();
+    }
+
+    void clear()
+    {
+        vector<RecordId>().swap(this->startXors);
+        vector<LocalTimestamp>().swap(this->ends);
+        vector<RecordId>().swap(this->endXors);
+    }
+
+    // Number and XOR of the ids of the entries overlapping [qstart, qend]; timestamps is the run the aggregates were built from.
+    void aggregate(const pair<LocalTimestamp, LocalTimestamp> *timestamps, LocalTimestamp qstart, LocalTimestamp qend, size_t &count, RecordId &idsXor) const
+    {
+        size_t numStarted = upper_bound(timestamps, timestamps+this->size(), qend, [](LocalTimestamp t, const pair<LocalTimestamp, LocalTimestamp> &p) { return t < p.first; })-timestamps;
+        size_t numEnded = lower_bound(this->ends.begin(), this->ends.end(), qstart)-this->ends.begin();
+
+        count  = numStarted-numEnded;
+        idsXor = this->startXors[numStarted]^this->endXors[numEnded];
+    }
+
+    size_t getMemoryUsage() const
+    {
+        return getAllocationSize(this->startXors) + getAllocationSize(this->ends) + getAllocationSize(this->endXors);
+    }
+};
+
+inline size_t getAllocationSize(const OverlapAggregates &aggregates)
+{
+    return aggregates.getMemoryUsage();
+}
+
+
+
+// Payloads of the entries of a hot partition, in the order of its ids, and their aggregate, kept up to date with them.
+struct PartitionPayloads
+{
+    vector<Payload> values;
+    PayloadAggregate aggregate;
+
+    void add(Payload payload)
+    {
+        this->values.push_back(payload);
+        this->aggregate.add(payload);
+    }
+
+    void updateAggregate()
+    {
+        this->aggregate = PayloadAggregate();
+        for (Payload payload : this->values)
+            this->aggregate.add(payload);
+    }
+};
+
+inline size_t getAllocationSize(const PartitionPayloads &payloads)
+{
+    return getAllocationSize(payloads.values);
+}
+
+
+
+// Endpoints of the entries of a hot partition that its subdivision does not keep, in the order of its ids: the ends in OrgsAft,
+// the starts in RepsIn and both in RepsAft, as offsets from the start of the partition like the kept ones; the other vector stays empty.
+// Unlike the kept ones they lie outside the partition, as far from it as the record is long, hence their 64 bits.
+struct PartitionEndpoints
+{
+    vector<Timestamp> starts, ends;
+};
+
+inline size_t getAllocationSize(const PartitionEndpoints &endpoints)
+{
+    return getAllocationSize(endpoints.starts) + getAllocationSize(endpoints.ends);
+}
+
+
+
+// Compacted (CSR) layout of the leading partitions [0, numPartitions) of one HINT level that no longer receive inserts.
+// The layout is that of the static HINT^m with all optimizations (HINT_M_ALL): only the non-empty partitions are stored,
+// in ascending order, and the k-th of them occupies [ioffsets[k].offset, ioffsets[k+1].offset) of the contiguous id and timestamp columns,
+// so a run of consecutive partitions is a single range of both columns. The directory ioffsets holds an OffsetEntry_ALL_Frozen
+// per non-empty partition, sorted on its id, plus a closing one; getBounds() locates a partition in it with a binary search.
+// The XOR of the ids is kept as a prefix over the non-empty partitions as well, so a run of partitions is counted or XORed in O(1),
+// and so is the zone map of each non-empty partition, unless the subdivision keeps ids only.
+// T is the timestamp entry the subdivision keeps (pair, start or end); a subdivision keeping ids only leaves the column empty.
+// Once compressed, whole blocks of PACKED_BLOCK_SIZE entries move from the columns to packed ones as they are appended:
+// entries [numHead, numHead+numPacked) are packed, ids and timestamps keep the head before them and less than a block after them;
+// offsets count all alike. The head, less than a block as well, is what removeIf() leaves of the blocks it rewrites.
+// The packed timestamps are one column per component of T, the start before the end.
+// If the index keeps payloads, the payloads of the entries are a further column, never packed, with the aggregate of each non-empty partition;
+// if it keeps endpoints, so are the endpoints the subdivision does not keep (see PartitionEndpoints).
+template <class T>
+class FrozenPartitions
+{
+public:
+    PartitionId numPartitions;
+    Column<OffsetEntry_ALL_Frozen> ioffsets;    // Id and offset of each non-empty partition, plus the end of the columns under the largest id
+    Column<RecordId> xors;      // XOR of the ids of the non-empty partitions before each, plus of all
+    Column<ZoneMap<T> > zones;  // Zone map of each non-empty partition
+    Column<LocalRecordId> ids;
+    Column<T> timestamps;
+    Column<Payload> payloads;                       // Payload of each entry, the packed ones included
+    Column<PayloadAggregate> payloadAggregates;     // Aggregate of the payloads of each non-empty partition
+    Column<Timestamp> starts, ends;                 // Endpoints of each entry that the subdivision does not keep, the packed ones included
+
+    static const int NUM_COMPONENTS = sizeof(T)/sizeof(LocalTimestamp);
+    bool compressed;
+    size_t numHead, numPacked;
+    PackedColumn<true> packedIds;
+    PackedColumn<false> packedTimestamps[NUM_COMPONENTS];
+
+    FrozenPartitions() : numPartitions(0), compressed(false), numHead(0), numPacked(0)
+    {
+        this->ioffsets.push_back({numeric_limits<PartitionId>::max(), 0});
+        this->xors.push_back(0);
+    };
+
+    size_t size() const
+    {
+        return this->numPacked+this->ids.size();
+    }
+
+    bool hasTimestamps() const
+    {
+        return ((!this->timestamps.empty()) || (!this->packedTimestamps[0].empty()));
+    }
+
+    // Entries from offset on, which lies before or past the packed ones.
+    const LocalRecordId* getIds(size_t offset) const
+    {
+        return this->ids.data()+((offset < this->numHead)? offset: offset-this->numPacked);
+    }
+
+    const T* getTimestamps(size_t offset) const
+    {
+        return this->timestamps.data()+((offset < this->numHead)? offset: offset-this->numPacked);
+    }
+
+    // Whether entries [offset, offset+size) lie in the columns, all together.
+    bool isUnpacked(size_t offset, size_t size) const
+    {
+        return ((this->numPacked == 0) || (offset+size <= this->numHead) || (offset >= this->numHead+this->numPacked));
+    }
+
+    bool hasPayloads() const
+    {
+        return !this->payloads.empty();
+    }
+
+    // Entries from offset on, which may lie among the packed ones.
+    const Payload* getPayloads(size_t offset) const
+    {
+        return this->payloads.data()+offset;
+    }
+
+    // Same for the endpoints the subdivision does not keep, null for the ones it keeps or if the index keeps none.
+    const Timestamp* getStarts(size_t offset) const
+    {
+        return (this->starts.empty())? NULL: this->starts.data()+offset;
+    }
+
+    const Timestamp* getEnds(size_t offset) const
+    {
+        return (this->ends.empty())? NULL: this->ends.data()+offset;
+    }
+
+    size_t getNumPartitions() const
+    {
+        return this->numPartitions;
+    }
+
+    size_t getNumNonEmptyPartitions() const
+    {
+        return this->ioffsets.size()-1;
+    }
+
+    // Number of non-empty partitions before pid, searching the directory from entry next_from on.
+    size_t rank(PartitionId pid, size_t next_from = 0) const
+    {
+        const OffsetEntry_ALL_Frozen *first = this->ioffsets.data(), *last = first+this->getNumNonEmptyPartitions();
+
+        return lower_bound(first+next_from, last, OffsetEntry_ALL_Frozen{pid, 0})-first;
+    }
+
+    // As getBounds() of HINT_M_SubsSort_SS_CM: locates partition pid in the directory from entry next_from on,
+    // and moves next_from past it, for a later partition of the level. False if pid is empty;
+    // otherwise it is the (next_from-1)-th non-empty partition and occupies [offset, offset+size).
+    bool getBounds(PartitionId pid, size_t &next_from, size_t &offset, size_t &size) const
+    {
+        size_t k = this->rank(pid, next_from);
+
+        offset = this->ioffsets[k].offset;
+        if (this->ioffsets[k].pid != pid)
+        {
+            next_from = k;
+            size = 0;
+
+            return false;
+        }
+        next_from = k+1;
+        size = this->ioffsets[k+1].offset-offset;
+
+        return true;
+    }
+
+    // Offset of the contents of partition pid, or of the next non-empty one if pid is empty.
+    size_t getOffset(PartitionId pid) const
+    {
+        return this->ioffsets[this->rank(pid)].offset;
+    }
+
+    // Zone map of partition pid, empty if pid is.
+    ZoneMap<T> getZone(PartitionId pid) const
+    {
+        size_t next_from = 0, offset, size;
+
+        return (this->getBounds(pid, next_from, offset, size))? this->zones[next_from-1]: ZoneMap<T>();
+    }
+
+    // Number and XOR of the ids of partitions [from, to).
+    void aggregate(PartitionId from, PartitionId to, size_t &count, RecordId &idsXor) const
+    {
+        size_t first = this->rank(from), last = this->rank(to, first);
+
+        count  = this->ioffsets[last].offset-this->ioffsets[first].offset;
+        idsXor = this->xors[last]^this->xors[first];
+    }
+
+    // Aggregate of the payloads of partitions [from, to), one step per non-empty partition.
+    void aggregatePayloads(PartitionId from, PartitionId to, PayloadAggregate &result) const
+    {
+        size_t first = this->rank(from), last = this->rank(to, first);
+
+        for (size_t k = first; k < last; k++)
+            result.merge(this->payloadAggregates[k]);
+    }
+
+    // Aggregate of the payloads of partition pid, empty if pid is.
+    PayloadAggregate getPayloadAggregate(PartitionId pid) const
+    {
+        size_t next_from = 0, offset, size;
+
+        return (this->getBounds(pid, next_from, offset, size))? this->payloadAggregates[next_from-1]: PayloadAggregate();
+    }
+
+    // Appends partition pid, which lies after every stored one; empty partitions are skipped. The ids are offsets from idBase.
+    void append(PartitionId pid, const LocalRelationId &pIds, RecordId idBase)
+    {
+        RecordId idsXor = this->xors[this->xors.size()-1];
+
+        if (pIds.empty())
+            return;
+
+        for (LocalRecordId id : pIds)
+            idsXor ^= idBase+id;
+        this->ioffsets.modify()[this->getNumNonEmptyPartitions()].pid = pid;
+        this->ids.append(pIds.data(), pIds.data()+pIds.size());
+        this->ioffsets.push_back({numeric_limits<PartitionId>::max(), this->size()});
+        this->xors.push_back(idsXor);
+        if (this->compressed)
+            this->pack();
+    }
+
+    void append(PartitionId pid, const LocalRelationId &pIds, RecordId idBase, const vector<T> &pTimestamps)
+    {
+        ZoneMap<T> zone;
+
+        if (pTimestamps.empty())
+            return;
+
+        for (const T &timestamp : pTimestamps)
+            zone.add(timestamp);
+        this->zones.push_back(zone);
+        this->timestamps.append(pTimestamps.data(), pTimestamps.data()+pTimestamps.size());
+        this->append(pid, pIds, idBase);
+    }
+
+    // Appends the payloads of the partition appended last, for an index that keeps payloads.
+    void appendPayloads(const PartitionPayloads &pPayloads)
+    {
+        if (pPayloads.values.empty())
+            return;
+
+        this->payloads.append(pPayloads.values.data(), pPayloads.values.data()+pPayloads.values.size());
+        this->payloadAggregates.push_back(pPayloads.aggregate);
+    }
+
+    // Appends the endpoints of the partition appended last, for an index that keeps endpoints.
+    void appendEndpoints(const PartitionEndpoints &pEndpoints)
+    {
+        this->starts.append(pEndpoints.starts.data(), pEndpoints.starts.data()+pEndpoints.starts.size());
+        this->ends.append(pEndpoints.ends.data(), pEndpoints.ends.data()+pEndpoints.ends.size());
+    }
+
+    // Unpacks packed block b; timestamps may be null.
+    void decode(size_t b, LocalRecordId *ids, T *timestamps) const
+    {
+        LocalTimestamp values[PACKED_BLOCK_SIZE];
+
+        this->packedIds.decode(b, ids);
+        if (!timestamps)
+            return;
+        for (int c = 0; c < NUM_COMPONENTS; c++)
+        {
+            this->packedTimestamps[c].decode(b, values);
+            for (size_t i = 0; i < PACKED_BLOCK_SIZE; i++)
+                setTimestampComponent(timestamps[i], c, values[i]);
+        }
+    }
+
+    // Calls visit(b, first, last) for every packed block b holding entries of [offset, offset+size), which are [first, last) of the block.
+    template <class Visit>
+    void visitBlocks(size_t offset, size_t size, Visit visit) const
+    {
+        size_t from = max(offset, this->numHead)-this->numHead, end = min(offset+size, this->numHead+this->numPacked);
+
+        end = (end > this->numHead)? end-this->numHead: 0;
+        for (size_t b = from/PACKED_BLOCK_SIZE; (from < end) && (b*PACKED_BLOCK_SIZE < end); b++)
+            visit(b, max(from, b*PACKED_BLOCK_SIZE)-b*PACKED_BLOCK_SIZE, min(end, (b+1)*PACKED_BLOCK_SIZE)-b*PACKED_BLOCK_SIZE);
+    }
+
+    // Calls visitUnpacked(ids, timestamps, size) on the entries of [offset, offset+size) in the head and after the packed ones,
+    // and visitBlock(b, first, last) as visitBlocks() does, in the order of the entries.
+    template <class VisitUnpacked, class VisitBlock>
+    void visitRange(size_t offset, size_t size, VisitUnpacked visitUnpacked, VisitBlock visitBlock) const
+    {
+        size_t end = offset+size, headEnd = min(end, this->numHead), from = max(offset, this->numHead+this->numPacked);
+
+        if (offset < headEnd)
+            visitUnpacked(this->getIds(offset), this->getTimestamps(offset), headEnd-offset);
+        this->visitBlocks(offset, size, visitBlock);
+        if (from < end)
+            visitUnpacked(this->getIds(from), this->getTimestamps(from), end-from);
+    }
+
+    // Calls visit(ids, timestamps, size) on consecutive pieces of the entries [offset, offset+size), unpacking packed blocks on the stack;
+    // timestamps is null for a subdivision that keeps ids only.
+    template <class Visit>
+    void visit(size_t offset, size_t size, Visit visit) const
+    {
+        LocalRecordId ids[PACKED_BLOCK_SIZE];
+        T timestamps[PACKED_BLOCK_SIZE];
+        bool hasTimestamps = this->hasTimestamps();
+
+        this->visitRange(offset, size, [&](const LocalRecordId *ids, const T *timestamps, size_t size) {
+            visit(ids, (hasTimestamps)? timestamps: NULL, size);
+        }, [&](size_t b, size_t first, size_t last) {
+            this->decode(b, ids, (hasTimestamps)? timestamps: NULL);
+            visit(ids+first, (hasTimestamps)? timestamps+first: NULL, last-first);
+        });
+    }
+
+    // Packs the whole blocks of the columns after the head.
+    void pack()
+    {
+        size_t numEntries = (this->ids.size()-this->numHead)/PACKED_BLOCK_SIZE*PACKED_BLOCK_SIZE;
+        bool hasTimestamps = !this->timestamps.empty();
+        LocalTimestamp values[PACKED_BLOCK_SIZE];
+
+        if (numEntries == 0)
+            return;
+
+        for (size_t i = this->numHead; i < this->numHead+numEntries; i += PACKED_BLOCK_SIZE)
+        {
+            this->packedIds.append(this->ids.data()+i);
+            for (int c = 0; (hasTimestamps) && (c < NUM_COMPONENTS); c++)
+            {
+                for (size_t j = 0; j < PACKED_BLOCK_SIZE; j++)
+                    values[j] = getTimestampComponent(this->timestamps[i+j], c);
+                this->packedTimestamps[c].append(values);
+            }
+        }
+        this->ids.erase(this->numHead, this->numHead+numEntries);
+        this->ids.shrink();
+        if (hasTimestamps)
+        {
+            this->timestamps.erase(this->numHead, this->numHead+numEntries);
+            this->timestamps.shrink();
+        }
+        this->numPacked += numEntries;
+    }
+
+    // Replaces the first numDropped packed blocks with the whole blocks at the end of the head, if compressed,
+    // which leaves less than a block there; the other blocks are moved rather than packed again.
+    void packHead(size_t numDropped, bool hasTimestamps)
+    {
+        size_t numEntries = (this->compressed)? this->numHead/PACKED_BLOCK_SIZE*PACKED_BLOCK_SIZE: 0, from = this->numHead-numEntries;
+        PackedColumn<true> packedIds;
+        PackedColumn<false> packedTimestamps[NUM_COMPONENTS];
+        LocalTimestamp values[PACKED_BLOCK_SIZE];
+
+        for (size_t i = from; i < this->numHead; i += PACKED_BLOCK_SIZE)
+        {
+            packedIds.append(this->ids.data()+i);
+            for (int c = 0; (hasTimestamps) && (c < NUM_COMPONENTS); c++)
+            {
+                for (size_t j = 0; j < PACKED_BLOCK_SIZE; j++)
+                    values[j] = getTimestampComponent(this->timestamps[i+j], c);
+                packedTimestamps[c].append(values);
+            }
+        }
+        this->packedIds.replaceFront(numDropped, packedIds);
+        for (int c = 0; (hasTimestamps) && (c < NUM_COMPONENTS); c++)
+            this->packedTimestamps[c].replaceFront(numDropped, packedTimestamps[c]);
+        if (numEntries > 0)
+        {
+            this->ids.erase(from, this->numHead);
+            if (hasTimestamps)
+                this->timestamps.erase(from, this->numHead);
+        }
+        this->numHead    = from;
+        this->numPacked += numEntries;
+    }
+
+    // Moves every packed entry back to the columns.
+    void unpack()
+    {
+        if (this->numPacked == 0)
+            return;
+
+        bool hasTimestamps = this->hasTimestamps();
+        vector<LocalRecordId> ids(this->size());
+        vector<T> timestamps((hasTimestamps)? this->size(): 0);
+
+        copy(this->ids.data(), this->ids.data()+this->numHead, ids.begin());
+        for (size_t b = 0; b < this->numPacked/PACKED_BLOCK_SIZE; b++)
+            this->decode(b, &ids[this->numHead+b*PACKED_BLOCK_SIZE], (hasTimestamps)? &timestamps[this->numHead+b*PACKED_BLOCK_SIZE]: NULL);
+        copy(this->ids.data()+this->numHead, this->ids.data()+this->ids.size(), ids.begin()+this->numHead+this->numPacked);
+        if (hasTimestamps)
+        {
+            copy(this->timestamps.data(), this->timestamps.data()+this->numHead, timestamps.begin());
+            copy(this->timestamps.data()+this->numHead, this->timestamps.data()+this->timestamps.size(), timestamps.begin()+this->numHead+this->numPacked);
+        }
+        this->ids.assign(ids);
+        this->timestamps.assign(timestamps);
+        this->packedIds.clear();
+        for (int c = 0; c < NUM_COMPONENTS; c++)
+            this->packedTimestamps[c].clear();
+        this->numHead   = 0;
+        this->numPacked = 0;
+    }
+
+    // Packs the whole blocks now and from then on, or moves every entry back to the columns.
+    void setCompressed(bool compressed)
+    {
+        this->compressed = compressed;
+        if (compressed)
+            this->pack();
+        else
+            this->unpack();
+    }
+
+    // Gives back the spare memory of every column, for a level that receives no more partitions.
+    void shrinkToFit()
+    {
+        this->ioffsets.shrinkToFit();
+        this->xors.shrinkToFit();
+        this->zones.shrinkToFit();
+        this->ids.shrinkToFit();
+        this->timestamps.shrinkToFit();
+        this->payloads.shrinkToFit();
+        this->payloadAggregates.shrinkToFit();
+        this->starts.shrinkToFit();
+        this->ends.shrinkToFit();
+        this->packedIds.shrinkToFit();
+        for (int c = 0; c < NUM_COMPONENTS; c++)
+            this->packedTimestamps[c].shrinkToFit();
+    }
+
+    // Calls visit(pid, ids, timestamps, size) on each non-empty partition before to, in pieces as visit() does.
+    template <class Visit>
+    void visitPartitions(PartitionId to, Visit visit) const
+    {
+        size_t last = this->rank(to);
+
+        for (size_t k = 0; k < last; k++)
+        {
+            PartitionId pid = this->ioffsets[k].pid;
+
+            this->visit(this->ioffsets[k].offset, this->ioffsets[k+1].offset-this->ioffsets[k].offset, [&](const LocalRecordId *ids, const T *timestamps, size_t size) {
+                visit(pid, ids, timestamps, size);
+            });
+        }
+    }
+
+    // Drops the partitions before numExpired as a whole and the entries of partitions [numExpired, numAffected)
+    // for which isFossil(pid, id, timestamp) is true, with id offset back by idBase and timestamp null for a subdivision that keeps ids only;
+    // partitions left empty are dropped.
+    // Only the entries of [numExpired, numAffected) are inspected. They are rewritten with the rest of the last packed block holding any of them,
+    // and become the head, packed again in front of the other blocks but for less than a block. Later entries are moved once,
+    // and their partitions shifted in O(1) each; payloads and endpoints stay with their entries.
+    template <class IsFossil>
+    void removeIf(PartitionId numExpired, PartitionId numAffected, RecordId idBase, IsFossil isFossil)
+    {
+        size_t first = this->rank(numExpired), last = this->rank(numAffected, first);
+        size_t begin = this->ioffsets[first].offset, end = this->ioffsets[last].offset;
+
+        if (end == 0)
+            return;
+
+        bool hasTimestamps = this->hasTimestamps();
+        bool hasPayloads = this->hasPayloads();
+        bool hasStarts = !this->starts.empty(), hasEnds = !this->ends.empty();
+
+        // Entries [begin, rewriteEnd) are taken out: the inspected ones, then up to the end of their last packed block
+        size_t numDecoded = (end > this->numHead)? min((end-this->numHead+PACKED_BLOCK_SIZE-1)/PACKED_BLOCK_SIZE*PACKED_BLOCK_SIZE, this->numPacked): 0;
+        size_t rewriteEnd = max(end, this->numHead+numDecoded);
+        vector<LocalRecordId> ids;
+        vector<T> timestamps;
+
+        ids.reserve(rewriteEnd-begin);
+        timestamps.reserve((hasTimestamps)? rewriteEnd-begin: 0);
+        this->visit(begin, rewriteEnd-begin, [&](const LocalRecordId *pieceIds, const T *pieceTimestamps, size_t size) {
+            ids.insert(ids.end(), pieceIds, pieceIds+size);
+            if (hasTimestamps)
+                timestamps.insert(timestamps.end(), pieceTimestamps, pieceTimestamps+size);
+        });
+
+        Payload *payloads = (hasPayloads)? this->payloads.modify(): NULL;
+        Timestamp *starts = (hasStarts)? this->starts.modify(): NULL;
+        Timestamp *ends = (hasEnds)? this->ends.modify(): NULL;
+        vector<OffsetEntry_ALL_Frozen> ioffsets;
+        vector<RecordId> xors(1, 0);
+        vector<ZoneMap<T> > zones;
+        vector<PayloadAggregate> payloadAggregates;
+        size_t numRemaining = 0;
+
+        // The partitions before numExpired are dropped from the directory, and so are the ones left empty
+        for (size_t k = first; k < last; k++)
+        {
+            PartitionId pid = this->ioffsets[k].pid;
+            size_t offset = numRemaining;
+            RecordId idsXor = xors.back();
+            ZoneMap<T> zone;
+            PayloadAggregate payloadAggregate;
+
+            for (size_t i = this->ioffsets[k].offset; i < this->ioffsets[k+1].offset; i++)
+            {
+                LocalRecordId id = ids[i-begin];
+
+                if (isFossil(pid, idBase+id, (hasTimestamps)? &timestamps[i-begin]: NULL))
+                    continue;
+                ids[numRemaining] = id;
+                if (hasTimestamps)
+                {
+                    timestamps[numRemaining] = timestamps[i-begin];
+                    zone.add(timestamps[numRemaining]);
+                }
+                if (hasPayloads)
+                {
+                    payloads[numRemaining] = payloads[i];
+                    payloadAggregate.add(payloads[i]);
+                }
+                if (hasStarts)
+                    starts[numRemaining] = starts[i];
+                if (hasEnds)
+                    ends[numRemaining] = ends[i];
+                idsXor ^= idBase+id;
+                numRemaining++;
+            }
+            if (numRemaining > offset)
+            {
+                ioffsets.push_back({pid, offset});
+                xors.push_back(idsXor);
+                if (hasTimestamps)
+                    zones.push_back(zone);
+                if (hasPayloads)
+                    payloadAggregates.push_back(payloadAggregate);
+            }
+        }
+
+        // The rest of the rewritten entries follows the remaining ones
+        size_t delta = end-numRemaining;
+        size_t numRewritten = numRemaining+(rewriteEnd-end);
+
+        move(ids.begin()+(end-begin), ids.end(), ids.begin()+numRemaining);
+        ids.resize(numRewritten);
+        if (hasTimestamps)
+        {
+            move(timestamps.begin()+(end-begin), timestamps.end(), timestamps.begin()+numRemaining);
+            timestamps.resize(numRewritten);
+        }
+
+        // They replace the columns up to rewriteEnd, the head or the entries after the packed ones
+        size_t numColumn = (rewriteEnd <= this->numHead)? rewriteEnd: ((rewriteEnd < this->numHead+this->numPacked)? this->numHead: rewriteEnd-this->numPacked);
+        RecordId xorsShift = this->xors[last]^xors.back();
+
+        this->ids.replace(numColumn, ids.data(), ids.data()+ids.size());
+        if (hasTimestamps)
+            this->timestamps.replace(numColumn, timestamps.data(), timestamps.data()+timestamps.size());
+        if (hasPayloads)
+        {
+            this->payloads.erase(numRemaining, end);
+            this->payloadAggregates.replace(last, payloadAggregates.data(), payloadAggregates.data()+payloadAggregates.size());
+        }
+        if (hasStarts)
+            this->starts.erase(numRemaining, end);
+        if (hasEnds)
+            this->ends.erase(numRemaining, end);
+        if (hasTimestamps)
+            this->zones.replace(last, zones.data(), zones.data()+zones.size());
+        this->ioffsets.replace(last, ioffsets.data(), ioffsets.data()+ioffsets.size());
+        this->xors.replace(last+1, xors.data(), xors.data()+xors.size());
+
+        OffsetEntry_ALL_Frozen *newIOffsets = this->ioffsets.modify();
+        RecordId *newXors = this->xors.modify();
+
+        for (size_t k = ioffsets.size(); k < this->ioffsets.size(); k++)
+            newIOffsets[k].offset -= delta;
+        for (size_t k = xors.size(); k < this->xors.size(); k++)
+            newXors[k] ^= xorsShift;
+
+        this->numHead    = (rewriteEnd <= this->numHead)? numRewritten+(this->numHead-rewriteEnd): numRewritten;
+        this->numPacked -= numDecoded;
+        if (this->numPacked == 0)
+            this->numHead = 0;
+        this->packHead(numDecoded/PACKED_BLOCK_SIZE, hasTimestamps);
+        if (this->compressed)
+            this->pack();
+
+        // Give the memory back once the columns are down to half
+        this->ioffsets.shrink();
+        this->xors.shrink();
+        this->zones.shrink();
+        this->ids.shrink();
+        this->timestamps.shrink();
+        this->payloads.shrink();
+        this->payloadAggregates.shrink();
+        this->starts.shrink();
+        this->ends.shrink();
+    }
+
+    void save(SnapshotWriter &writer) const
+    {
+        writer.write(this->numPartitions);
+        this->ioffsets.save(writer);
+        this->xors.save(writer);
+        this->zones.save(writer);
+        this->ids.save(writer);
+        this->timestamps.save(writer);
+        this->payloads.save(writer);
+        this->payloadAggregates.save(writer);
+        this->starts.save(writer);
+        this->ends.save(writer);
+        writer.write(this->compressed);
+        writer.write(this->numHead);
+        writer.write(this->numPacked);
+        this->packedIds.save(writer);
+        for (int c = 0; c < NUM_COMPONENTS; c++)
+            this->packedTimestamps[c].save(writer);
+    }
+
+    // The columns stay in the snapshot until they change.
+    void load(const shared_ptr<Snapshot> &snapshot)
+    {
+        this->numPartitions = snapshot->read<PartitionId>();
+        this->ioffsets.load(snapshot);
+        this->xors.load(snapshot);
+        this->zones.load(snapshot);
+        this->ids.load(snapshot);
+        this->timestamps.load(snapshot);
+        this->payloads.load(snapshot);
+        this->payloadAggregates.load(snapshot);
+        this->starts.load(snapshot);
+        this->ends.load(snapshot);
+        this->compressed = snapshot->read<bool>();
+        this->numHead    = snapshot->read<size_t>();
+        this->numPacked  = snapshot->read<size_t>();
+        this->packedIds.load(snapshot);
+        for (int c = 0; c < NUM_COMPONENTS; c++)
+            this->packedTimestamps[c].load(snapshot);
+    }
+
+    size_t getMemoryUsage() const
+    {
+        size_t memoryUsage = this->ioffsets.getMemoryUsage() + this->xors.getMemoryUsage() + this->zones.getMemoryUsage() + this->ids.getMemoryUsage() + this->timestamps.getMemoryUsage() + this->payloads.getMemoryUsage() + this->payloadAggregates.getMemoryUsage() + this->starts.getMemoryUsage() + this->ends.getMemoryUsage() + this->packedIds.getMemoryUsage();
+
+        for (int c = 0; c < NUM_COMPONENTS; c++)
+            memoryUsage += this->packedTimestamps[c].getMemoryUsage();
+
+        return memoryUsage;
+    }
+};
+#endif // _PARTITIONS_H_
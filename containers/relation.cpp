@@ -248,11 +248,7 @@ size_t Relation::execute_Equals(RangeQuery Q)
     {
         if (iter->start == Q.start && iter->end == Q.end)
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->id;
-#endif
+            WorkloadAggregator::add(result, iter->id);
         }
     }
     
@@ -269,11 +265,7 @@ size_t Relation::execute_Starts(RangeQuery Q) //Q.start == interval.start, Q.end
     {
         if ((iter->start == Q.start) && (iter->end > Q.end))
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->id;
-#endif
+            WorkloadAggregator::add(result, iter->id);
         }
     }
     
@@ -290,11 +282,7 @@ size_t Relation::execute_Started(RangeQuery Q)
     {
         if ((iter->start == Q.start) && (iter->end < Q.end))
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->id;
-#endif
+            WorkloadAggregator::add(result, iter->id);
         }
     }
     
@@ -311,11 +299,7 @@ size_t Relation::execute_Finishes(RangeQuery Q) // same end, Q.start > interval.
     {
         if ((iter->end == Q.end) && (iter->start < Q.start))
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->id;
-#endif
+            WorkloadAggregator::add(result, iter->id);
         }
     }
     
@@ -332,11 +316,7 @@ size_t Relation::execute_Finished(RangeQuery Q)
     {
         if ((iter->end == Q.end) && (iter->start > Q.start))
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->id;
-#endif
+            WorkloadAggregator::add(result, iter->id);
         }
     }
     
@@ -353,11 +333,7 @@ size_t Relation::execute_Meets(RangeQuery Q)
     {
         if (iter->start == Q.end)
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->id;
-#endif
+            WorkloadAggregator::add(result, iter->id);
         }
     }
     
@@ -374,11 +350,7 @@ size_t Relation::execute_Met(RangeQuery Q)
     {
         if (iter->end == Q.start)
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->id;
-#endif
+            WorkloadAggregator::add(result, iter->id);
         }
     }
     
@@ -395,11 +367,7 @@ size_t Relation::execute_Overlaps(RangeQuery Q)
     {
         if ((Q.start < iter->start) && (iter->start < Q.end) && (Q.end < iter->end))
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result^= iter->id;
-#endif
+            WorkloadAggregator::add(result, iter->id);
         }
     }
     
@@ -415,11 +383,7 @@ size_t Relation::execute_Overlapped(RangeQuery Q)
     {
         if ((Q.start > iter->start) && (Q.start < iter->end) && (Q.end > iter->end))
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result^= iter->id;
-#endif
+            WorkloadAggregator::add(result, iter->id);
         }
     }
     
@@ -436,11 +400,7 @@ size_t Relation::execute_Contains(RangeQuery Q)
     {
         if ((iter->start > Q.start) && (iter->end < Q.end))
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->id;
-#endif
+            WorkloadAggregator::add(result, iter->id);
         }
     }
     
@@ -457,11 +417,7 @@ size_t Relation::execute_Contained(RangeQuery Q)
     {
         if ((iter->start < Q.start) && (iter->end > Q.end))
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->id;
-#endif
+            WorkloadAggregator::add(result, iter->id);
         }
     }
     
@@ -478,11 +434,7 @@ size_t Relation::execute_Precedes(RangeQuery Q)
     {
         if (iter->start > Q.end)
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->id;
-#endif
+            WorkloadAggregator::add(result, iter->id);
         }
     }
     
@@ -499,11 +451,7 @@ size_t Relation::execute_Preceded(RangeQuery Q)
     {
         if (iter->end < Q.start)
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->id;
-#endif
+            WorkloadAggregator::add(result, iter->id);
         }
     }
     
@@ -520,11 +468,7 @@ size_t Relation::execute_gOverlaps(StabbingQuery Q)
     {
         if ((iter->start <= Q.point) && (Q.point <= iter->end))
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->id;
-#endif
+            WorkloadAggregator::add(result, iter->id);
         }
     }
     
@@ -541,11 +485,7 @@ size_t Relation::execute_gOverlaps(RangeQuery Q)
     {
         if ((iter->start <= Q.end) && (Q.start <= iter->end))
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->id;
-#endif
+            WorkloadAggregator::add(result, iter->id);
         }
     }
     
@@ -564,11 +504,7 @@ size_t Relation::executeTimeTravel(RangeQuery Q, int lowerConstraint, int upperC
         if ((iter->start <= Q.end) && (Q.start <= iter->end))
         {
             if(iter->secondAttr > lowerConstraint && iter->secondAttr < upperConstraint){
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->id;
-#endif
+            WorkloadAggregator::add(result, iter->id);
             }
         }
     }
@@ -588,11 +524,7 @@ size_t Relation::executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrConst
         if ((iter->start <= Q.end) && (Q.start <= iter->end))
         {
             if(iter->secondAttr > secondAttrConstraint){
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->id;
-#endif
+            WorkloadAggregator::add(result, iter->id);
             }
         }
     }
@@ -613,11 +545,7 @@ size_t Relation::executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrConstra
         {
             // cout << "sec attr: " << iter->secondAttr << "constraint: " <<secondAttrConstraint << endl;
             if(iter->secondAttr < secondAttrConstraint){
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= iter->id;
-#endif
+            WorkloadAggregator::add(result, iter->id);
             }
         }
     }
@@ -168,8 +168,15 @@ class RelationId : public vector<RecordId>
 {
 public:
     RelationId();
+    RelationId(const RelationId &) = default;
+    RelationId(RelationId &&) = default;
+    RelationId& operator=(const RelationId &) = default;
+    RelationId& operator=(RelationId &&) = default;   // The declared destructor would otherwise turn moves into copies
     void print(char c);
     ~RelationId();
 };
 typedef RelationId::iterator RelationIdIterator;
+
+// Ids of a HINT_M_Dynamic partition, as offsets from the first id of the index
+typedef vector<LocalRecordId> LocalRelationId;
 #endif //_RELATION_H_
@@ -0,0 +1,162 @@
+#ifndef _SNAPSHOT_H_
+#define _SNAPSHOT_H_
+
+#include "../def_global.h"
+#include <cstring>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+
+
+// Checkpoint of in-memory state in a single file: a sequence of scalars and arrays, each array preceded by its length
+// and starting at a multiple of SNAPSHOT_ALIGNMENT. Nothing in the file is an address, so it is position-independent,
+// and once the file is mapped an array is used where it lies, without visiting its entries.
+// Entries are written as they are in memory, so a snapshot is read back by the same build on the same architecture.
+static const size_t   SNAPSHOT_ALIGNMENT = 64;
+static const uint64_t SNAPSHOT_MAGIC     = 0x3830504e53544c4cULL;  // "LLTSNP08"
+
+
+class SnapshotWriter
+{
+private:
+    string filename;
+    ofstream out;
+    size_t position;
+
+public:
+    // The snapshot is written next to filename and replaces it on close(), so a crash while writing keeps the previous one
+    // and a mapped previous snapshot stays valid.
+    SnapshotWriter(const string &filename) : filename(filename), out(filename + ".tmp", ios::binary | ios::trunc), position(0)
+    {
+        if (!this->out)
+            throw runtime_error("Cannot create snapshot " + filename);
+        this->write(SNAPSHOT_MAGIC);
+    }
+
+    template <class T>
+    void write(const T &value)
+    {
+        this->out.write((const char*)&value, sizeof(T));
+        this->position += sizeof(T);
+    }
+
+    template <class T>
+    void write(const T *data, size_t size)
+    {
+        static const char zeros[SNAPSHOT_ALIGNMENT] = {};
+        size_t padding = (SNAPSHOT_ALIGNMENT - (this->position+sizeof(uint64_t)) % SNAPSHOT_ALIGNMENT) % SNAPSHOT_ALIGNMENT;
+
+        this->write<uint64_t>(size);
+        this->out.write(zeros, padding);
+        this->out.write((const char*)data, size*sizeof(T));
+        this->position += padding + size*sizeof(T);
+    }
+
+    template <class T>
+    void write(const vector<T> &v)
+    {
+        this->write(v.data(), v.size());
+    }
+
+    void close()
+    {
+        this->out.close();
+        if ((this->out.fail()) || (rename((this->filename + ".tmp").c_str(), this->filename.c_str()) != 0))
+            throw runtime_error("Cannot write snapshot " + this->filename);
+    }
+};
+
+
+// Read-only mapping of a snapshot, consumed in the order it was written.
+// Arrays obtained by view() point into the mapping, so whoever keeps them also keeps a reference to the snapshot.
+class Snapshot
+{
+private:
+    const char *base;
+    size_t length;
+    size_t position;
+
+    const char* take(size_t numBytes)
+    {
+        if (numBytes > this->length-this->position)
+            throw runtime_error("Truncated snapshot");
+
+        const char *p = this->base+this->position;
+
+        this->position += numBytes;
+
+        return p;
+    }
+
+public:
+    Snapshot(const string &filename) : base(NULL), length(0), position(0)
+    {
+        struct stat st;
+        int fd = open(filename.c_str(), O_RDONLY);
+
+        if ((fd < 0) || (fstat(fd, &st) != 0) || (st.st_size < (off_t)sizeof(uint64_t)))
+        {
+            if (fd >= 0)
+                ::close(fd);
+            throw runtime_error("Cannot open snapshot " + filename);
+        }
+        this->length = st.st_size;
+        this->base = (const char*)mmap(NULL, this->length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (this->base == MAP_FAILED)
+        {
+            this->base = NULL;
+            throw runtime_error("Cannot map snapshot " + filename);
+        }
+        if (this->read<uint64_t>() != SNAPSHOT_MAGIC)
+        {
+            munmap((void*)this->base, this->length);
+            throw runtime_error("Not a snapshot " + filename);
+        }
+    }
+
+    Snapshot(const Snapshot &) = delete;
+    Snapshot& operator=(const Snapshot &) = delete;
+
+    ~Snapshot()
+    {
+        if (this->base)
+            munmap((void*)this->base, this->length);
+    }
+
+    template <class T>
+    T read()
+    {
+        T value;
+
+        memcpy((void*)&value, this->take(sizeof(T)), sizeof(T));
+
+        return value;
+    }
+
+    // Array written by SnapshotWriter::write(data, size), in place.
+    template <class T>
+    const T* view(size_t &size)
+    {
+        size = this->read<uint64_t>();
+        this->take((SNAPSHOT_ALIGNMENT - this->position % SNAPSHOT_ALIGNMENT) % SNAPSHOT_ALIGNMENT);
+        if (size > (this->length-this->position)/sizeof(T))
+            throw runtime_error("Truncated snapshot");
+
+        return (const T*)this->take(size*sizeof(T));
+    }
+
+    // Same, copied into v.
+    template <class T>
+    void read(vector<T> &v)
+    {
+        size_t size;
+        const T *data = this->view<T>(size);
+
+        v.assign(data, data+size);
+    }
+};
+#endif // _SNAPSHOT_H_
@@ -16,11 +16,12 @@
 #include <unistd.h>
 #include <tuple>
 #include <limits.h>
+#include <cstdint>
 
 using namespace std;
 
 
-// Comment out the following for XOR workload
+// Default aggregation policy (see WorkloadAggregator below): uncomment for COUNT, otherwise XOR
 // #define WORKLOAD_COUNT
 
 // Basic predicates of Allen's algebra
@@ -44,6 +45,16 @@ using namespace std;
 #define SECOND_ATTR_GREATERTHAN 0
 #define SECOND_ATTR_LOWERTHAN 1
 
+// Aggregation of the query results, see the aggregation policies below
+#define AGGREGATION_COUNT 0
+#define AGGREGATION_XOR   1
+#define AGGREGATION_SUM   2
+
+// Aggregation of the payloads of the query results, see PayloadAggregate below
+#define AGGREGATION_PAYLOAD_SUM 3
+#define AGGREGATION_PAYLOAD_MIN 4
+#define AGGREGATION_PAYLOAD_MAX 5
+
 #define HINT_OPTIMIZATIONS_NO          0
 #define HINT_OPTIMIZATIONS_SS          1
 
@@ -65,8 +76,14 @@ using namespace std;
 #define MAX_ATTRIBUTE_VALUE 31406400
 
 typedef int PartitionId;
-typedef int RecordId;
-typedef int Timestamp;
+typedef int64_t RecordId;
+typedef int64_t Timestamp;
+typedef int64_t Payload;
+
+// Timestamps and ids as HINT_M_Dynamic stores them, 32-bit offsets: a timestamp from the start of its partition,
+// an id from the id the index is based on (see HINT_M_Dynamic::idBase)
+typedef int32_t LocalTimestamp;
+typedef int32_t LocalRecordId;
 
 
 struct RunSettings
@@ -78,6 +95,8 @@ struct RunSettings
     unsigned int typeQuery;
     unsigned int typePredicate;
     unsigned int typeSecondAttributeConstraint;
+    unsigned int typeAggregation;
+    size_t       limit;
 	unsigned int numPartitions;
 	unsigned int numBits;
 	unsigned int maxBits;
@@ -85,6 +104,11 @@ struct RunSettings
 	bool         isAutoTuned;
 	unsigned int numRuns;
     unsigned int typeOptimizations;
+    unsigned int numThreads;
+    string       snapshotFile;
+    bool         compressFrozen;
+    Timestamp    segmentExtent;
+    size_t       batchSize;
 	
 	void init()
 	{
@@ -94,6 +118,17 @@ struct RunSettings
 		isAutoTuned       = false;
 		numRuns           = 1;
         typeOptimizations = 0;
+        numThreads        = 1;
+        snapshotFile      = "";
+        compressFrozen    = false;
+        segmentExtent     = 0;
+        batchSize         = 0;
+        limit             = 0;
+#ifdef WORKLOAD_COUNT
+        typeAggregation   = AGGREGATION_COUNT;
+#else
+        typeAggregation   = AGGREGATION_XOR;
+#endif
 	};
 };
 
@@ -132,6 +167,187 @@ struct RangeQuery
 };
 
 
+// Aggregation policies: what a query reports about the records it finds.
+// The query functions of the LIT tiers are templates on the policy, so every policy is compiled into its own specialization
+// with its steps inlined into the scan loops; a policy is stateless and the query keeps its state in a Result.
+//   add(result, id)                       reports one record
+//   addAll(result, ids, size)             reports a run of records that needs no comparisons
+//   addAll(result, idBase, ids, size)     same for a run of LocalRecordId offsets from idBase
+//   merge(result, other)                  combines the results of two parts of the query, e.g., two tiers
+// A policy with HAS_AGGREGATES also reports a run from its count and XOR of ids alone, addAggregate(result, count, idsXor),
+// so the structures that keep these per partition or block report them in O(1) instead of visiting the ids.
+// Only COUNT and XOR have it, so only they get this pushdown, including the O(log n) sorted bodies of OverlapAggregates:
+// SUM and COLLECT visit the ids of every result. Payload queries (see PayloadAggregate) take the partitions that need
+// no comparisons from their aggregates, but compare every entry of the others; a MIN or MAX has no inverse,
+// so it cannot be taken as the difference of two prefixes as OverlapAggregates does.
+struct CountAggregator
+{
+    typedef size_t Result;
+    static const bool HAS_AGGREGATES = true;
+    static constexpr const char *NAME = "COUNT";
+
+    static inline void add(Result &result, RecordId id) { result++; };
+    static inline void addAll(Result &result, const RecordId *ids, size_t size) { result += size; };
+    static inline void addAll(Result &result, RecordId idBase, const LocalRecordId *ids, size_t size) { result += size; };
+    static inline void addAggregate(Result &result, size_t count, RecordId idsXor) { result += count; };
+    static inline void merge(Result &result, const Result &other) { result += other; };
+};
+
+struct XorAggregator
+{
+    typedef size_t Result;
+    static const bool HAS_AGGREGATES = true;
+    static constexpr const char *NAME = "XOR";
+
+    static inline void add(Result &result, RecordId id) { result ^= id; };
+    static inline void addAll(Result &result, const RecordId *ids, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+            result ^= ids[i];
+    };
+    static inline void addAll(Result &result, RecordId idBase, const LocalRecordId *ids, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+            result ^= idBase+ids[i];
+    };
+    static inline void addAggregate(Result &result, size_t count, RecordId idsXor) { result ^= idsXor; };
+    static inline void merge(Result &result, const Result &other) { result ^= other; };
+};
+
+struct SumAggregator
+{
+    typedef size_t Result;
+    static const bool HAS_AGGREGATES = false;
+    static constexpr const char *NAME = "SUM";
+
+    static inline void add(Result &result, RecordId id) { result += id; };
+    static inline void addAll(Result &result, const RecordId *ids, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+            result += ids[i];
+    };
+    static inline void addAll(Result &result, RecordId idBase, const LocalRecordId *ids, size_t size)
+    {
+        result += size*idBase;
+        for (size_t i = 0; i < size; i++)
+            result += ids[i];
+    };
+    static inline void merge(Result &result, const Result &other) { result += other; };
+};
+
+// The ids themselves, in no particular order
+struct CollectAggregator
+{
+    typedef vector<RecordId> Result;
+    static const bool HAS_AGGREGATES = false;
+    static constexpr const char *NAME = "COLLECT";
+
+    static inline void add(Result &result, RecordId id) { result.push_back(id); };
+    static inline void addAll(Result &result, const RecordId *ids, size_t size) { result.insert(result.end(), ids, ids+size); };
+    static inline void addAll(Result &result, RecordId idBase, const LocalRecordId *ids, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+            result.push_back(idBase+ids[i]);
+    };
+    static inline void merge(Result &result, const Result &other) { result.insert(result.end(), other.begin(), other.end()); };
+};
+
+// Policy of the methods that are not templated on one, and the default of the drivers
+#ifdef WORKLOAD_COUNT
+typedef CountAggregator WorkloadAggregator;
+#else
+typedef XorAggregator   WorkloadAggregator;
+#endif
+
+// Adds the results of Q in index to result through the policy of the given type of aggregation, for the drivers.
+// The type is looked up once per call, the query itself runs specialized on the policy.
+template <class Index, class Query>
+inline void aggregateQuery(unsigned int typeAggregation, Index *index, Query Q, size_t &result)
+{
+    switch (typeAggregation)
+    {
+        case AGGREGATION_COUNT:
+            index->template execute_pureTimeTravel<CountAggregator>(Q, result);
+            break;
+        case AGGREGATION_SUM:
+            index->template execute_pureTimeTravel<SumAggregator>(Q, result);
+            break;
+        default:
+            index->template execute_pureTimeTravel<XorAggregator>(Q, result);
+            break;
+    }
+}
+
+inline const char* getAggregationName(unsigned int typeAggregation)
+{
+    switch (typeAggregation)
+    {
+        case AGGREGATION_COUNT:
+            return CountAggregator::NAME;
+        case AGGREGATION_SUM:
+            return SumAggregator::NAME;
+        case AGGREGATION_PAYLOAD_SUM:
+            return "PAYLOAD_SUM";
+        case AGGREGATION_PAYLOAD_MIN:
+            return "PAYLOAD_MIN";
+        case AGGREGATION_PAYLOAD_MAX:
+            return "PAYLOAD_MAX";
+        default:
+            return XorAggregator::NAME;
+    }
+}
+
+
+// Payloads: an optional number attached to every record (e.g., bytes transferred or a price), which the tiers keep next to its id.
+// A payload query aggregates the payloads of its results instead of the ids, into a PayloadAggregate: their sum, lowest and highest.
+// The structures that keep it per partition report a partition that needs no comparisons in O(1).
+struct PayloadAggregate
+{
+    Payload sum, min, max;
+
+    // Empty, the lowest payload lies above the highest
+    PayloadAggregate() : sum(0), min(numeric_limits<Payload>::max()), max(numeric_limits<Payload>::min()) {};
+
+    bool empty() const
+    {
+        return (this->min > this->max);
+    }
+
+    void add(Payload payload)
+    {
+        this->sum += payload;
+        this->min = std::min(this->min, payload);
+        this->max = std::max(this->max, payload);
+    }
+
+    void merge(const PayloadAggregate &other)
+    {
+        this->sum += other.sum;
+        this->min = std::min(this->min, other.min);
+        this->max = std::max(this->max, other.max);
+    }
+};
+
+inline bool isPayloadAggregation(unsigned int typeAggregation)
+{
+    return ((typeAggregation == AGGREGATION_PAYLOAD_SUM) || (typeAggregation == AGGREGATION_PAYLOAD_MIN) || (typeAggregation == AGGREGATION_PAYLOAD_MAX));
+}
+
+// The part of aggregate that the given type of payload aggregation reports, for the drivers; the lowest and highest of no payloads are 0
+inline size_t getPayloadResult(unsigned int typeAggregation, const PayloadAggregate &aggregate)
+{
+    switch (typeAggregation)
+    {
+        case AGGREGATION_PAYLOAD_MIN:
+            return (aggregate.empty())? 0: aggregate.min;
+        case AGGREGATION_PAYLOAD_MAX:
+            return (aggregate.empty())? 0: aggregate.max;
+        default:
+            return aggregate.sum;
+    }
+}
+
+
 class Timer
 {
 private:
@@ -164,11 +380,32 @@ public:
 };
 
 
+// Memory accounting
+// Bytes the allocator reserves for a request of numBytes, modelled on glibc malloc on 64-bit:
+// a chunk header of one word, 16-byte alignment and a 32-byte minimum chunk.
+inline size_t getAllocationSize(size_t numBytes)
+{
+    return (numBytes == 0)? 0: max<size_t>(32, (numBytes+sizeof(size_t)+15) & ~size_t(15));
+}
+
+template <class T>
+inline size_t getAllocationSize(const vector<T> &v)
+{
+    return getAllocationSize(v.capacity()*sizeof(T));
+}
+
+inline size_t getAllocationSize(const vector<bool> &v)
+{
+    return getAllocationSize((v.capacity()+7)/8);
+}
+
+
 // Imports from utils
 string toUpperCase(char *buf);
 bool checkPredicate(string strPredicate, RunSettings &settings);
 bool checkAttributeConstraint(string typeSecondAttributeConstraint, RunSettings &settings);
 bool checkOptimizations(string strOptimizations, RunSettings &settings);
+bool checkAggregation(string strAggregation, RunSettings &settings);
 void process_mem_usage(double& vm_usage, double& resident_set);
 void usage(string indexName);
 void parseArguments(int, char**, RunSettings&, Timestamp&, string&, size_t&, Timestamp&, string&);
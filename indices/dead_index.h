@@ -0,0 +1,84 @@
+#ifndef _DEAD_INDEX_H_
+#define _DEAD_INDEX_H_
+
+#include "../def_global.h"
+#include "../containers/relation.h"
+#include "../containers/snapshot.h"
+#include "../indices/query_cursor.h"
+#include <functional>
+
+
+
+// The engines of the dead tier, which the drivers pick like the live indices: HINT_M_Dynamic by default, or HINT_M_Segmented
+class DeadIndex
+{
+public:
+    // Domain of the index; a query that starts after gend has no results in it
+    Timestamp gstart, gend;
+
+    DeadIndex() : gstart(0), gend(0) {};
+    virtual ~DeadIndex() {};
+
+    // Settings, before the first insert
+    virtual void setQueryThreads(unsigned int numThreads) {};
+    virtual void setCompression(bool compress) {};
+    virtual void enablePayloads() = 0;
+    virtual bool hasPayloads() const = 0;
+    // Whether the index keeps the intervals of its records, which its cursors report; needed for them
+    virtual void enableEndpoints() = 0;
+    virtual bool hasEndpoints() const = 0;
+    virtual size_t getMemoryUsage() const = 0;
+
+    // Updating
+    virtual void insert(const Record &r) = 0;
+    virtual void insert(const Record &r, Payload payload) = 0;
+    // The caller guarantees that no record inserted from now on starts before t
+    virtual void freeze(Timestamp t) {};
+
+    // Deletion of the records that end before Tf, each passed to consume(); returns their number
+    virtual size_t deleteFossils(Timestamp Tf, const function<void(const Record&)> &consume) = 0;
+
+    // Checkpointing
+    virtual void save(SnapshotWriter &writer) const { throw logic_error("Dead index does not support snapshots."); };
+
+    // Querying through the aggregation policy A (see def_global.h), adding to result. As in LiveIndex,
+    // there is one virtual overload per policy, told apart by a tag, which the engines implement with their templates on the policy.
+    template <class A>
+    void execute_pureTimeTravel(RangeQuery Q, typename A::Result &result) { this->execute_pureTimeTravel(Q, A(), result); };
+    template <class A>
+    void execute_pureTimeTravel(StabbingQuery Q, typename A::Result &result) { this->execute_pureTimeTravel(Q, A(), result); };
+    virtual void execute_pureTimeTravel(RangeQuery Q, CountAggregator, size_t &result) = 0;
+    virtual void execute_pureTimeTravel(RangeQuery Q, XorAggregator, size_t &result) = 0;
+    virtual void execute_pureTimeTravel(RangeQuery Q, SumAggregator, size_t &result) = 0;
+    virtual void execute_pureTimeTravel(RangeQuery Q, CollectAggregator, vector<RecordId> &result) = 0;
+    virtual void execute_pureTimeTravel(StabbingQuery Q, CountAggregator, size_t &result) = 0;
+    virtual void execute_pureTimeTravel(StabbingQuery Q, XorAggregator, size_t &result) = 0;
+    virtual void execute_pureTimeTravel(StabbingQuery Q, SumAggregator, size_t &result) = 0;
+    virtual void execute_pureTimeTravel(StabbingQuery Q, CollectAggregator, vector<RecordId> &result) = 0;
+
+    // Same, aggregating the payloads of the results into result, for an index that keeps payloads
+    virtual void execute_payloadTimeTravel(RangeQuery Q, PayloadAggregate &result) = 0;
+    virtual void execute_payloadTimeTravel(StabbingQuery Q, PayloadAggregate &result) = 0;
+
+    // Cursor of the engine over the results of Q, for the cursor below
+    virtual QueryCursor* openCursor(RangeQuery Q, size_t batchSize) = 0;
+    virtual QueryCursor* openCursor(StabbingQuery Q, size_t batchSize) = 0;
+
+    class Cursor;
+};
+
+
+// Cursor over the results of a query in a dead index, see QueryCursor
+class DeadIndex::Cursor : public QueryCursor
+{
+private:
+    unique_ptr<QueryCursor> cursor;
+
+protected:
+    bool fill(vector<QueryResult> &results) { return (this->cursor->next(results, this->batchSize) > 0); };
+
+public:
+    Cursor(DeadIndex *index, RangeQuery Q, size_t batchSize = CURSOR_BATCH_SIZE) : QueryCursor(batchSize), cursor(index->openCursor(Q, batchSize)) {};
+    Cursor(DeadIndex *index, StabbingQuery Q, size_t batchSize = CURSOR_BATCH_SIZE) : QueryCursor(batchSize), cursor(index->openCursor(Q, batchSize)) {};
+};
+#endif // _DEAD_INDEX_H_
@@ -18,7 +18,7 @@ FossilIndex::FossilIndex(string storageFile) {
 }
 FossilIndex::~FossilIndex() {}
 
-void FossilIndex::insertInterval(int id, double start, double end) {
+void FossilIndex::insertInterval(RecordId id, double start, double end) {
     double lowBounds[2] = {start, start};
     double highBounds[2] = {end, end};
     Region region(lowBounds, highBounds, 2);
@@ -46,6 +46,78 @@ int FossilIndex::query(double queryStart, double queryEnd) const {
     return count;
 }
 
+// Stabbing query: an interval is stored as the square from (start, start) to (end, end), which contains (point, point) exactly when it is stabbed.
+int FossilIndex::query(double queryPoint) const {
+    double coords[2] = {queryPoint, queryPoint};
+    Point queryPoint2D(coords, 2);
+
+    int count = 0;
+
+    struct QueryVisitor : public IVisitor {
+        int& countRef;
+        QueryVisitor(int& count) : countRef(count) {}
+        void visitNode(const INode&) override {}
+        void visitData(const IData&) override { ++countRef; }
+        void visitData(vector<const IData*>&) override {}
+    } visitor(count);
+
+    rtree->pointLocationQuery(queryPoint2D, visitor);
+    return count;
+}
+
+// Collects the results past the first skip, and stops the search once it has maxSize of them.
+// The interval of a result is read back from the x-extent of its square.
+struct CollectVisitor : public IVisitor {
+    struct Full {};
+
+    size_t skip, maxSize, numFound;
+    vector<QueryResult>& resultsRef;
+    CollectVisitor(size_t skip, size_t maxSize, vector<QueryResult>& results) : skip(skip), maxSize(maxSize), numFound(0), resultsRef(results) {}
+    void visitNode(const INode&) override {}
+    void visitData(const IData& d) override {
+        if (skip > 0) {
+            --skip;
+            return;
+        }
+        IShape* shape;
+        Region mbr;
+        d.getShape(&shape);
+        shape->getMBR(mbr);
+        delete shape;
+        resultsRef.push_back({d.getIdentifier(), static_cast<Timestamp>(mbr.getLow(0)), static_cast<Timestamp>(mbr.getHigh(0))});
+        if (++numFound == maxSize)
+            throw Full();
+    }
+    void visitData(vector<const IData*>&) override {}
+};
+
+size_t FossilIndex::query(double queryStart, double queryEnd, size_t skip, size_t maxSize, vector<QueryResult> &results) const {
+    double queryLow[2] = {queryStart, queryStart};
+    double queryHigh[2] = {queryEnd, queryEnd};
+    Region queryRegion(queryLow, queryHigh, 2);
+    CollectVisitor visitor(skip, maxSize, results);
+
+    if (maxSize == 0)
+        return 0;
+    try {
+        rtree->intersectsWithQuery(queryRegion, visitor);
+    } catch (const CollectVisitor::Full&) {}
+    return visitor.numFound;
+}
+
+size_t FossilIndex::query(double queryPoint, size_t skip, size_t maxSize, vector<QueryResult> &results) const {
+    double coords[2] = {queryPoint, queryPoint};
+    Point queryPoint2D(coords, 2);
+    CollectVisitor visitor(skip, maxSize, results);
+
+    if (maxSize == 0)
+        return 0;
+    try {
+        rtree->pointLocationQuery(queryPoint2D, visitor);
+    } catch (const CollectVisitor::Full&) {}
+    return visitor.numFound;
+}
+
 size_t FossilIndex::getObjectCount() const {
     return objectCount;
 }
@@ -2,6 +2,7 @@
 #define FOSSIL_INDEX_H
 
 #include <spatialindex/SpatialIndex.h>
+#include "query_cursor.h"
 #include <memory>
 #include <vector>
 #include <string>
@@ -14,16 +15,48 @@ public:
     FossilIndex(string storageFile);
     ~FossilIndex();
 
-    void insertInterval(int id, double start, double end);
+    void insertInterval(RecordId id, double start, double end);
     int query(double queryStart, double queryEnd) const;
+    int query(double queryPoint) const;
+    // Same, appending the results past the first skip to results, up to maxSize of them; returns their number
+    size_t query(double queryStart, double queryEnd, size_t skip, size_t maxSize, vector<QueryResult> &results) const;
+    size_t query(double queryPoint, size_t skip, size_t maxSize, vector<QueryResult> &results) const;
     size_t getObjectCount() const;
     double getDiskUsage();
     void getStatistics() const; 
 
+    class Cursor;
+
 private:
     IStorageManager* storageManager;
     ISpatialIndex* rtree;
     mutable size_t objectCount = 0;
 };
 
+
+// Cursor over the results of a query in the fossil index, see QueryCursor.
+// The R-tree is searched anew for every batch, skipping the results already produced, and the search stops once the batch is full
+class FossilIndex::Cursor : public QueryCursor
+{
+private:
+    const FossilIndex *index;
+    double queryStart, queryEnd;
+    bool isStabbing;
+    size_t position;
+
+protected:
+    bool fill(vector<QueryResult> &results)
+    {
+        size_t numFound = (this->isStabbing)? this->index->query(this->queryStart, this->position, this->batchSize, results): this->index->query(this->queryStart, this->queryEnd, this->position, this->batchSize, results);
+
+        this->position += numFound;
+
+        return (numFound > 0);
+    }
+
+public:
+    Cursor(const FossilIndex *index, RangeQuery Q, size_t batchSize = CURSOR_BATCH_SIZE) : QueryCursor(batchSize), index(index), queryStart(Q.start), queryEnd(Q.end), isStabbing(false), position(0) {};
+    Cursor(const FossilIndex *index, StabbingQuery Q, size_t batchSize = CURSOR_BATCH_SIZE) : QueryCursor(batchSize), index(index), queryStart(Q.point), queryEnd(Q.point), isStabbing(true), position(0) {};
+};
+
 #endif // FOSSIL_INDEX_H
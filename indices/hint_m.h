@@ -5,9 +5,13 @@
 #include "../containers/relation.h"
 #include "../containers/offsets.h"
 #include "../containers/offsets_templates.cpp"
+#include "../containers/partitions.h"
 #include "../indices/hierarchicalindex.h"
 #include <boost/dynamic_bitset.hpp>
 #include "../indices/live_index.h"
+#include "../indices/dead_index.h"
+#include "../thread_pool.h"
+#include <memory>
 
 
 
@@ -552,49 +556,275 @@ public:
 
 };
 
-class HINT_M_Dynamic : public HierarchicalIndex
+class HINT_M_Dynamic : public HierarchicalIndex, public DeadIndex
 {
 protected:
-    vector<vector<RelationId> > pOrgsInIds;
-    vector<vector<RelationId> > pOrgsAftIds;
-    vector<vector<RelationId> > pRepsInIds;
-    vector<vector<RelationId> > pRepsAftIds;
-    vector<vector<vector<pair<Timestamp, Timestamp> > > > pRepsInTimestamps;
-    vector<vector<vector<pair<Timestamp, Timestamp> > > > pOrgsInTimestamps;
-    vector<vector<vector<pair<Timestamp, Timestamp> > > > pOrgsAftTimestamps;
-    vector<vector<vector<pair<Timestamp, Timestamp> > > > pRepsAftTimestamps;
-
-    RecordId      **pOrgsIn_sizes, **pOrgsAft_sizes;
-    size_t        **pRepsIn_sizes, **pRepsAft_sizes;
+    // Partitions are allocated lazily per level, growing the index never moves existing ones
+    // Storage optimization: each subdivision keeps only the endpoints its comparisons need
+    // (OrgsIn both, OrgsAft starts, RepsIn ends, RepsAft none)
+    vector<PartitionBlocks<LocalRelationId> > pOrgsInIds;
+    vector<PartitionBlocks<LocalRelationId> > pOrgsAftIds;
+    vector<PartitionBlocks<LocalRelationId> > pRepsInIds;
+    vector<PartitionBlocks<LocalRelationId> > pRepsAftIds;
+    vector<PartitionBlocks<vector<pair<LocalTimestamp, LocalTimestamp> > > > pOrgsInTimestamps;
+    vector<PartitionBlocks<vector<LocalTimestamp> > > pOrgsAftStarts;
+    vector<PartitionBlocks<vector<LocalTimestamp> > > pRepsInEnds;
+
+    // XOR of the ids of each partition, kept up to date by every update, so a partition that needs no comparisons is reported in O(1);
+    // its count is its size
+    vector<PartitionBlocks<RecordId> > pOrgsInXors;
+    vector<PartitionBlocks<RecordId> > pOrgsAftXors;
+    vector<PartitionBlocks<RecordId> > pRepsInXors;
+    vector<PartitionBlocks<RecordId> > pRepsAftXors;
+
+    // Zone map of each OrgsIn, OrgsAft and RepsIn partition, widened by every insert and recomputed when fossils leave,
+    // so a partition that needs comparisons is skipped, or reported through its aggregates, when its zone decides the query alone
+    vector<PartitionBlocks<ZoneMap<pair<LocalTimestamp, LocalTimestamp> > > > pOrgsInZones;
+    vector<PartitionBlocks<ZoneMap<LocalTimestamp> > > pOrgsAftZones;
+    vector<PartitionBlocks<ZoneMap<LocalTimestamp> > > pRepsInZones;
+
+    // Length of the sorted body of each OrgsIn, OrgsAft (on start) and RepsIn (on end) partition holding at least SCAN_SORTED_MIN_SIZE entries;
+    // entries past it form an unsorted append tail, merged into the body once it passes MIN_TAIL_SIZE and 1/2^TAIL_RATIO_BITS of the body
+    static const size_t MIN_TAIL_SIZE = 64;
+    static const size_t TAIL_RATIO_BITS = 3;
+    vector<PartitionBlocks<uint32_t> > pOrgsInSorted;
+    vector<PartitionBlocks<uint32_t> > pOrgsAftSorted;
+    vector<PartitionBlocks<uint32_t> > pRepsInSorted;
+
+    // Long intervals: the sorted body of each OrgsIn partition of the top NUM_AGGREGATED_LEVELS levels, where they go, also kept as aggregates,
+    // so its comparisons take two binary searches instead of a scan; only the tail is compared
+    static const unsigned int NUM_AGGREGATED_LEVELS = 4;
+    vector<PartitionBlocks<OverlapAggregates> > pOrgsInAggregates;
+
+    // Skewness & sparsity: the non-empty partitions per level that are not compacted yet
+    vector<PartitionDirectory> pOrgsInDirectory;
+    vector<PartitionDirectory> pOrgsAftDirectory;
+    vector<PartitionDirectory> pRepsInDirectory;
+    vector<PartitionDirectory> pRepsAftDirectory;
+
+    // Leading partitions per level that no longer receive inserts, compacted by freeze() with their tails merged
+    vector<FrozenPartitions<pair<LocalTimestamp, LocalTimestamp> > > pOrgsInFrozen;
+    vector<FrozenPartitions<LocalTimestamp> > pOrgsAftFrozen;
+    vector<FrozenPartitions<LocalTimestamp> > pRepsInFrozen;
+    vector<FrozenPartitions<LocalTimestamp> > pRepsAftFrozen;    // Ids only
+
+    // Payload of each entry of each partition, in the order of its ids, with the aggregate of the partition, so a partition that needs
+    // no comparisons is aggregated in O(1); the compacted layouts keep theirs as columns. Empty unless enablePayloads() is called
+    bool keepsPayloads;
+    vector<PartitionBlocks<PartitionPayloads> > pOrgsInPayloads;
+    vector<PartitionBlocks<PartitionPayloads> > pOrgsAftPayloads;
+    vector<PartitionBlocks<PartitionPayloads> > pRepsInPayloads;
+    vector<PartitionBlocks<PartitionPayloads> > pRepsAftPayloads;
+
+    // Endpoints of each entry that its subdivision does not keep (see PartitionEndpoints), in the order of its ids, for the cursors
+    // to report the intervals of the results; the compacted layouts keep theirs as columns. Empty unless enableEndpoints() is called
+    bool keepsEndpoints;
+    vector<PartitionBlocks<PartitionEndpoints> > pOrgsAftEndpoints;
+    vector<PartitionBlocks<PartitionEndpoints> > pRepsInEndpoints;
+    vector<PartitionBlocks<PartitionEndpoints> > pRepsAftEndpoints;
+
+    // Bit-pack the compacted layouts a block at a time, off unless setCompression() is called
+    bool compressFrozen;
+
+    // Threads for rebuilding the index and for the queries that scan at least MIN_PARALLEL_ENTRIES entries,
+    // off unless setQueryThreads() is called; shared by the copies of the index
+    static const size_t MIN_PARALLEL_ENTRIES = 1 << 18;
+    shared_ptr<ThreadPool> queryPool;
+
+    // Memory of the index, kept up to date by every update so that getMemoryUsage() is O(1)
+    size_t memoryUsage;
+
+    // The partitions cover the domain from gstart, which the first record anchors at its start, aligned to the leaf extent,
+    // so no level holds partitions before the data; see anchor() for the records that start earlier
+    bool isAnchored;
+
+    // Ids and timestamps are stored as 32-bit offsets (see def_global.h), an id from idBase, the id of the first record stored
+    // while the index is empty, and a timestamp from the start of its partition; the XORs of ids and the results are of the ids themselves
+    RecordId idBase;
+    
+    // The records whose offsets this index cannot store (see canStore()) go to overflow, an index of the same kind with its own
+    // idBase and gstart, created with the settings of this one by the first of them; every query and update passes on to it,
+    // and the domain of this index grows to cover its records, so that gend bounds them
+    unique_ptr<HINT_M_Dynamic> overflow;
+    
+    // A partition spans at most 2^MAX_PARTITION_BITS timestamps, so every offset in it fits a LocalTimestamp with room to spare;
+    // once the domain is wider, the top level is the first one that reaches that extent instead of the root, see assignPartitions()
+    static const unsigned int MAX_PARTITION_BITS = 30;
     
     
     // Construction
-    inline void updatePartitions(const Record &r);
+    enum Subdivision {ORGS_IN, ORGS_AFT, REPS_IN, REPS_AFT, NUM_SUBDIVISIONS};
+    inline void anchor(Timestamp t);
+    inline Timestamp getOffset(Timestamp t) const;
+    inline Timestamp getPartitionStart(unsigned int level, PartitionId pid) const;
+    inline LocalTimestamp toLocal(unsigned int level, PartitionId pid, Timestamp t) const;
+    inline unsigned int getHeight() const;
+    inline bool canStore(const Record &r) const;
+    HINT_M_Dynamic* touchOverflow();
+    void appendOverflow(unique_ptr<HINT_M_Dynamic> index);
+    void shareQueryPool(const shared_ptr<ThreadPool> &pool);
+    inline PartitionId getNumPartitions(unsigned int level) const;
+    template <class Assign>
+    inline void assignPartitions(const Record &r, Assign assign);
+    inline void updatePartitions(const Record &r, Payload payload);
+    inline void grow(Timestamp end);
+    inline void resizeLevels();
+    void bulkLoad(const Relation &R, unsigned int numThreads);
+    inline size_t getLevelsMemoryUsage() const;
+    inline void updateAggregates(unsigned int level, PartitionId pid);
+    inline void updateAggregates();
+    size_t computeMemoryUsage() const;
+    inline LocalRelationId& touchPartition(vector<PartitionBlocks<LocalRelationId> > &pIds, vector<PartitionDirectory> &pDirectory, unsigned int level, PartitionId pid);
+    template <class T>
+    inline void mergeTail(vector<PartitionBlocks<LocalRelationId> > &pIds, vector<PartitionBlocks<vector<T> > > &pTimestamps, vector<PartitionBlocks<PartitionPayloads> > &pPayloads, vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, vector<PartitionBlocks<uint32_t> > &pSorted, unsigned int level, PartitionId pid, bool force);
+    template <class T>
+    inline void freezePartitions(vector<PartitionBlocks<LocalRelationId> > &pIds, vector<PartitionBlocks<RecordId> > &pXors, vector<PartitionBlocks<PartitionPayloads> > &pPayloads, vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, vector<PartitionBlocks<vector<T> > > &pTimestamps, vector<PartitionBlocks<ZoneMap<T> > > &pZones, vector<PartitionBlocks<uint32_t> > &pSorted, vector<PartitionDirectory> &pDirectory, vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId numPartitions);
+    template <class T>
+    inline void freezePartitions(vector<PartitionBlocks<LocalRelationId> > &pIds, vector<PartitionBlocks<RecordId> > &pXors, vector<PartitionBlocks<PartitionPayloads> > &pPayloads, vector<PartitionBlocks<PartitionEndpoints> > &pEndpoints, vector<PartitionDirectory> &pDirectory, vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId numPartitions);
+    template <class T, class Visit>
+    void visitPartitions(const PartitionBlocks<LocalRelationId> &pIds, const PartitionBlocks<vector<T> > *pTimestamps, const PartitionDirectory &directory, const FrozenPartitions<T> &frozen, Visit visit) const;
+    
+    // Querying
+    template <class T>
+    inline void getPartition(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, const LocalRecordId* &ids, size_t &size);
+    template <class T>
+    inline void getPartition(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<vector<T> > > &pTimestamps, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, const LocalRecordId* &ids, const T* &timestamps, size_t &size);
+    template <class T>
+    inline void getPartition(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<vector<T> > > &pTimestamps, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, const LocalRecordId* &ids, const T* &timestamps, size_t &size, size_t &sortedSize);
+    template <class A, class T>
+    inline void reportPartition(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, typename A::Result &result);
+    template <class A, class T>
+    inline void scanPartitions_NoChecks(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionDirectory> &pDirectory, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId from, PartitionId to, typename A::Result &result);
+    template <class A, class T>
+    inline void scanPartition_CheckStart(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<vector<T> > > &pTimestamps, const vector<PartitionBlocks<ZoneMap<T> > > &pZones, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<PartitionBlocks<OverlapAggregates> > *pAggregates, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, LocalTimestamp qend, typename A::Result &result);
+    template <class A, class T>
+    inline void scanPartition_CheckEnd(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<vector<T> > > &pTimestamps, const vector<PartitionBlocks<ZoneMap<T> > > &pZones, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<PartitionBlocks<OverlapAggregates> > *pAggregates, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, LocalTimestamp qstart, typename A::Result &result);
+    template <class A>
+    inline void scanPartition_CheckBoth(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<vector<pair<LocalTimestamp, LocalTimestamp> > > > &pTimestamps, const vector<PartitionBlocks<ZoneMap<pair<LocalTimestamp, LocalTimestamp> > > > &pZones, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<PartitionBlocks<OverlapAggregates> > *pAggregates, const vector<FrozenPartitions<pair<LocalTimestamp, LocalTimestamp> > > &pFrozen, unsigned int level, PartitionId pid, LocalTimestamp qstart, LocalTimestamp qend, typename A::Result &result);
+    template <class Visitor>
+    inline void traverse(RangeQuery Q, Visitor &visitor);
+    template <class Visitor>
+    inline void traverse(StabbingQuery Q, Visitor &visitor);
+    template <class A>
+    struct Reporter;
+    struct PayloadReporter;
+    
+    // Entries [0, size) of a partition, or of consecutive compacted ones; scan(first, size, result) adds to result
+    // the results among entries [first, first+size)
+    template <class Result>
+    struct Run
+    {
+        size_t size;
+        function<void(size_t, size_t, Result&)> scan;
+    };
+    template <class A>
+    struct Planner;
+    struct ResultPlanner;
+    template <class Result, class Merge>
+    inline void scanRuns(const vector<Run<Result> > &runs, Result &result, Merge merge);
+    template <class A, class Query>
+    inline void query(Query Q, typename A::Result &result);
     
 public:
     // Construction
-    Timestamp gstart, gend;
     Timestamp leafPartitionExtent;
 
     HINT_M_Dynamic(Timestamp leafPartitionExtent);
-    HINT_M_Dynamic(const Relation &R, const unsigned int numBits, const unsigned int maxBits);
+    HINT_M_Dynamic(const Relation &R, const unsigned int numBits, const unsigned int maxBits, unsigned int numThreads = 1);
+    HINT_M_Dynamic(Timestamp leafPartitionExtent, const Relation &R, unsigned int numThreads = 1, bool keepEndpoints = false);
+    HINT_M_Dynamic(const shared_ptr<Snapshot> &snapshot);
+    void setQueryThreads(unsigned int numThreads);
+    void setCompression(bool compress);
+    void enablePayloads();
+    bool hasPayloads() const { return this->keepsPayloads; };
+    void enableEndpoints();
+    bool hasEndpoints() const { return this->keepsEndpoints; };
+    size_t getNumRecords() const { return this->numIndexedRecords+((this->overflow)? this->overflow->getNumRecords(): 0); };
     void getStats();
-    size_t getMemoryUsage();
+    size_t getMemoryUsage() const;
     void print(char c);
     ~HINT_M_Dynamic() {};
-    
-    // Querying
+    // Declared since the destructor suppresses the implicit ones: a rebuilt index is moved in, not copied
+    HINT_M_Dynamic(HINT_M_Dynamic &&) = default;
+    HINT_M_Dynamic& operator=(HINT_M_Dynamic &&) = default;
+    
+    // Querying, the results are added to result through the aggregation policy A (see def_global.h);
+    // instantiated for the policies of def_global.h. The overloads without one use WorkloadAggregator.
+    template <class A>
+    void execute_pureTimeTravel(RangeQuery Q, typename A::Result &result);
+    template <class A>
+    void execute_pureTimeTravel(StabbingQuery Q, typename A::Result &result);
     size_t execute_pureTimeTravel(RangeQuery Q);
+    size_t execute_pureTimeTravel(StabbingQuery Q);
+    class Cursor;
+    QueryCursor* openCursor(RangeQuery Q, size_t batchSize);
+    QueryCursor* openCursor(StabbingQuery Q, size_t batchSize);
+
+    // The policies through DeadIndex
+    void execute_pureTimeTravel(RangeQuery Q, CountAggregator, size_t &result) { this->execute_pureTimeTravel<CountAggregator>(Q, result); };
+    void execute_pureTimeTravel(RangeQuery Q, XorAggregator, size_t &result) { this->execute_pureTimeTravel<XorAggregator>(Q, result); };
+    void execute_pureTimeTravel(RangeQuery Q, SumAggregator, size_t &result) { this->execute_pureTimeTravel<SumAggregator>(Q, result); };
+    void execute_pureTimeTravel(RangeQuery Q, CollectAggregator, vector<RecordId> &result) { this->execute_pureTimeTravel<CollectAggregator>(Q, result); };
+    void execute_pureTimeTravel(StabbingQuery Q, CountAggregator, size_t &result) { this->execute_pureTimeTravel<CountAggregator>(Q, result); };
+    void execute_pureTimeTravel(StabbingQuery Q, XorAggregator, size_t &result) { this->execute_pureTimeTravel<XorAggregator>(Q, result); };
+    void execute_pureTimeTravel(StabbingQuery Q, SumAggregator, size_t &result) { this->execute_pureTimeTravel<SumAggregator>(Q, result); };
+    void execute_pureTimeTravel(StabbingQuery Q, CollectAggregator, vector<RecordId> &result) { this->execute_pureTimeTravel<CollectAggregator>(Q, result); };
+    
+    // Same, aggregating the payloads of the results into result, for an index that keeps payloads
+    void execute_payloadTimeTravel(RangeQuery Q, PayloadAggregate &result);
+    void execute_payloadTimeTravel(StabbingQuery Q, PayloadAggregate &result);
     
     // Updating
     void insert(const Record &r);
+    void insert(const Record &r, Payload payload);
+    void freeze(Timestamp t);
 
     // Deletion
+    size_t deleteFossils(Timestamp Tf, const function<void(const Record&)> &consume);
     Relation deleteFossils(Timestamp Tf);
-    void deleteFossilsFromPartition(Timestamp, Relation &, unordered_set<int> &, vector<int> &, vector<pair<Timestamp, Timestamp>> &);
+
+    // Checkpointing
+    void save(SnapshotWriter &writer) const;
 };
 
 
+// Cursor over the results of a query in the dead index, see QueryCursor; the index must keep endpoints (see enableEndpoints()).
+// The partitions the query visits are laid out up front as runs of entries that take the same comparisons,
+// which are then scanned batchSize entries at a time, and only as far as the cursor is pulled.
+class HINT_M_Dynamic::Cursor : public QueryCursor
+{
+private:
+    vector<Run<vector<QueryResult> > > runs;
+    size_t current, offset;
+
+protected:
+    bool fill(vector<QueryResult> &results);
+
+public:
+    Cursor(HINT_M_Dynamic *index, RangeQuery Q, size_t batchSize = CURSOR_BATCH_SIZE);
+    Cursor(HINT_M_Dynamic *index, StabbingQuery Q, size_t batchSize = CURSOR_BATCH_SIZE);
+};
+
+
+// Start of partition pid of level l, the origin of the timestamps it stores
+inline Timestamp HINT_M_Dynamic::getPartitionStart(unsigned int level, PartitionId pid) const
+{
+    return this->gstart+(Timestamp(pid) << (this->maxBits-this->numBits+level));
+}
+
+
+// Calls visit(pid, ids, timestamps, size) on every non-empty partition of one level of a subdivision, the compacted ones first,
+// in pieces if they are packed (see FrozenPartitions::visit()); pTimestamps is null for a subdivision that keeps ids only.
+// The ids and timestamps are the stored offsets, see getPartitionStart() and idBase.
+template <class T, class Visit>
+void HINT_M_Dynamic::visitPartitions(const PartitionBlocks<LocalRelationId> &pIds, const PartitionBlocks<vector<T> > *pTimestamps, const PartitionDirectory &directory, const FrozenPartitions<T> &frozen, Visit visit) const
+{
+    frozen.visitPartitions(frozen.getNumPartitions(), visit);
+    for (PartitionId pid : directory.pids)
+        visit(pid, pIds[pid].data(), (pTimestamps)? (*pTimestamps)[pid].data(): NULL, pIds[pid].size());
+}
+
+
 class HINT_M_Dynamic_Second_Attr : public HierarchicalIndex
 {
 private:
@@ -1,4 +1,40 @@
 #include "hint_m.h"
+#include "scan_kernels.h"
+
+
+
+// Memory of one level of a subdivision apart from the contents of its hot partitions, i.e., of the compacted layout,
+// the blocks and the directory; pTimestamps, pZones and pSorted are null for a subdivision that keeps ids only, pEndpoints for OrgsIn.
+template <class T>
+static inline size_t getLevelMemoryUsage(const FrozenPartitions<T> &frozen, const PartitionBlocks<LocalRelationId> &pIds, const PartitionBlocks<RecordId> &pXors, const PartitionBlocks<PartitionPayloads> &pPayloads, const PartitionBlocks<PartitionEndpoints> *pEndpoints, const PartitionBlocks<vector<T> > *pTimestamps, const PartitionBlocks<ZoneMap<T> > *pZones, const PartitionBlocks<uint32_t> *pSorted, const PartitionDirectory &directory) {
+    return frozen.getMemoryUsage() + pIds.getMemoryUsage() + pXors.getMemoryUsage() + pPayloads.getMemoryUsage() + ((pEndpoints)? pEndpoints->getMemoryUsage(): 0) + ((pTimestamps)? pTimestamps->getMemoryUsage(): 0) + ((pZones)? pZones->getMemoryUsage(): 0) + ((pSorted)? pSorted->getMemoryUsage(): 0) + directory.getMemoryUsage();
+}
+
+
+// Recomputes the zone map of hot partition pid from its timestamp entries.
+template <class T>
+static inline void updateZone(const PartitionBlocks<vector<T> > &pTimestamps, PartitionBlocks<ZoneMap<T> > &pZones, PartitionId pid) {
+    ZoneMap<T> zone;
+
+    for (const T &timestamp : pTimestamps[pid])
+        zone.add(timestamp);
+    pZones.touch(pid) = zone;
+}
+
+
+// Memory of the contents of hot partition pid.
+template <class T>
+static inline size_t getPartitionMemoryUsage(const PartitionBlocks<LocalRelationId> &pIds, const PartitionBlocks<PartitionPayloads> &pPayloads, const PartitionBlocks<PartitionEndpoints> *pEndpoints, const PartitionBlocks<vector<T> > *pTimestamps, PartitionId pid) {
+    return getAllocationSize(pIds[pid]) + getAllocationSize(pPayloads[pid]) + ((pEndpoints)? getAllocationSize((*pEndpoints)[pid]): 0) + ((pTimestamps)? getAllocationSize((*pTimestamps)[pid]): 0);
+}
+
+
+// Memory an insert into hot partition pid can change: its contents, the blocks, which allocate the one of pid on its first touch,
+// and the directory; the compacted layout is left alone. The pointers are null as for getLevelMemoryUsage().
+template <class T>
+static inline size_t getInsertMemoryUsage(const PartitionBlocks<LocalRelationId> &pIds, const PartitionBlocks<RecordId> &pXors, const PartitionBlocks<PartitionPayloads> &pPayloads, const PartitionBlocks<PartitionEndpoints> *pEndpoints, const PartitionBlocks<vector<T> > *pTimestamps, const PartitionBlocks<ZoneMap<T> > *pZones, const PartitionBlocks<uint32_t> *pSorted, const PartitionDirectory &directory, PartitionId pid) {
+    return pIds.getMemoryUsage() + pXors.getMemoryUsage() + pPayloads.getMemoryUsage() + ((pEndpoints)? pEndpoints->getMemoryUsage(): 0) + ((pTimestamps)? pTimestamps->getMemoryUsage(): 0) + ((pZones)? pZones->getMemoryUsage(): 0) + ((pSorted)? pSorted->getMemoryUsage(): 0) + directory.getMemoryUsage() + getPartitionMemoryUsage(pIds, pPayloads, pEndpoints, pTimestamps, pid);
+}
 
 
 
@@ -68,75 +104,162 @@ inline void HINT_M_Subs_CM::updateCounters(const Record &r){
 // This checks if we have to grow the index and assigns some helper variables
 // updatePartitions() handles the actual insertion
 void HINT_M_Dynamic::insert(const Record &r){
-    // Check if the partitions where r will be inserted already exists
-    if (this->gend >= r.end)
-        this->updatePartitions(r);
-    // Need to grow the index
-    else  {
-        // Update index parameters, calculate how many extra partitions are needed.
-        this->numBits = ceil(log2(ceil((r.end-this->gstart)/(float)this->leafPartitionExtent)));
-        this->gend = this->leafPartitionExtent*pow(2, this->numBits);
-        this->maxBits = int(log2(this->gend-this->gstart)+1);
-        this->height = this->numBits+1;
-        
-        // Grow - increase the height of the index.
-        this->pOrgsInIds.resize(this->height);
-        this->pOrgsInTimestamps.resize(this->height);
-        this->pOrgsAftIds.resize(this->height);
-        this->pOrgsAftTimestamps.resize(this->height);
-        this->pRepsInIds.resize(this->height);
-        this->pRepsInTimestamps.resize(this->height);
-        this->pRepsAftIds.resize(this->height);
-        this->pRepsAftTimestamps.resize(this->height);
-        for (auto l = 0; l < this->height; l++){
-            auto cnt = (int)(pow(2, this->numBits-l));
-
-            this->pOrgsInIds[l].resize(cnt);
-            this->pOrgsInTimestamps[l].resize(cnt);
-            this->pOrgsAftIds[l].resize(cnt);
-            this->pOrgsAftTimestamps[l].resize(cnt);
-            this->pRepsInIds[l].resize(cnt);
-            this->pRepsInTimestamps[l].resize(cnt);
-            this->pRepsAftIds[l].resize(cnt);
-            this->pRepsAftTimestamps[l].resize(cnt);
-        }
-        this->updatePartitions(r);
+    this->insert(r, 0);
+}
+
+
+// Same with the payload of r, which is kept if the index keeps payloads
+void HINT_M_Dynamic::insert(const Record &r, Payload payload){
+    if (!this->isAnchored)
+        this->anchor(r.start);
+    if (this->numIndexedRecords == 0)
+        this->idBase = r.id;
+
+    // Need to grow the index; the domain covers the records of the overflow too, so that gend bounds them all
+    if (this->gend < r.end)
+        this->grow(r.end);
+    if (!this->canStore(r))
+    {
+        this->touchOverflow()->insert(r, payload);
+        return;
     }
+    this->updatePartitions(r, payload);
     this->numIndexedRecords++;
 }
 
 
-// Assumes that partitions to be updated already exist
-// This is the actual insertion function
-inline void HINT_M_Dynamic::updatePartitions(const Record &r){
+// Doubles the domain until it covers end; the prefix length (maxBits-numBits) stays the same,
+// so every existing partition keeps its id and only new levels are added on top.
+// The domain end saturates at the largest Timestamp, which every end fits under.
+inline void HINT_M_Dynamic::grow(Timestamp end)
+{
+    while (this->gend < end) {
+        this->numBits++;
+        this->maxBits++;
+        if (this->leafPartitionExtent > ((numeric_limits<Timestamp>::max()-this->gstart) >> min(this->numBits, 62u)))
+            this->gend = numeric_limits<Timestamp>::max();
+        else
+            this->gend = this->gstart+(this->leafPartitionExtent << this->numBits);
+    }
+    this->height = this->getHeight();
+    
+    // Grow - increase the height of the index, partitions of the new levels are allocated on first touch.
+    this->resizeLevels();
+    this->updateAggregates();
+}
+
+
+// Moves the origin of the still empty domain to t, aligned down to the leaf extent.
+// A timestamp before the origin is placed at it, i.e., in the first partition of a level, both for records and for queries;
+// the partitions keep the actual timestamps and queries compare their actual endpoints, and every comparison a query skips
+// on the placed timestamps also holds on the actual ones, so the results are those of an index from 0.
+inline void HINT_M_Dynamic::anchor(Timestamp t)
+{
+    this->gstart = (t > 0)? t-t%this->leafPartitionExtent: 0;
+    this->gend   = (this->gstart > numeric_limits<Timestamp>::max()-this->leafPartitionExtent)? numeric_limits<Timestamp>::max(): this->gstart+this->leafPartitionExtent;
+    this->isAnchored = true;
+}
+
+
+// Offset of t from the origin; partition j of level l covers offsets [j << shift, (j+1) << shift) with shift = maxBits-numBits+l
+inline Timestamp HINT_M_Dynamic::getOffset(Timestamp t) const
+{
+    return (t > this->gstart)? t-this->gstart: 0;
+}
+
+
+// t as an offset from the start of partition pid of level l, for a query; one out of the 32-bit range is clamped to it,
+// which the stored offsets lie strictly inside (see MAX_PARTITION_BITS and canStore()), so every comparison gives the same result.
+inline LocalTimestamp HINT_M_Dynamic::toLocal(unsigned int level, PartitionId pid, Timestamp t) const
+{
+    Timestamp offset = t-this->getPartitionStart(level, pid);
+
+    return LocalTimestamp(min<Timestamp>(max<Timestamp>(offset, numeric_limits<LocalTimestamp>::min()), numeric_limits<LocalTimestamp>::max()));
+}
+
+
+// Whether every offset r is stored as fits strictly inside the 32-bit range. The timestamps a partition keeps lie in it,
+// less than 2^MAX_PARTITION_BITS after its start, but for the start of a record that precedes gstart, which is placed in the first partition.
+inline bool HINT_M_Dynamic::canStore(const Record &r) const
+{
+    return ((r.id-this->idBase > numeric_limits<LocalRecordId>::min()) && (r.id-this->idBase < numeric_limits<LocalRecordId>::max()) && (r.start-this->gstart > numeric_limits<LocalTimestamp>::min()));
+}
+
+
+// The overflow, created on first use with the leaf extent and the settings of this index.
+HINT_M_Dynamic* HINT_M_Dynamic::touchOverflow()
+{
+    if (!this->overflow)
+    {
+        this->overflow.reset(new HINT_M_Dynamic(this->leafPartitionExtent));
+        this->overflow->keepsPayloads  = this->keepsPayloads;
+        this->overflow->keepsEndpoints = this->keepsEndpoints;
+        this->overflow->queryPool      = this->queryPool;
+        this->overflow->setCompression(this->compressFrozen);
+    }
+    
+    return this->overflow.get();
+}
+
+
+// Puts index, an overflow taken from another index, at the end of the chain of overflows; the domain grows to cover it.
+void HINT_M_Dynamic::appendOverflow(unique_ptr<HINT_M_Dynamic> index)
+{
+    unique_ptr<HINT_M_Dynamic> *tail = &this->overflow;
+    
+    if ((index) && (!this->isAnchored))
+        this->anchor(index->gstart);
+    if ((index) && (this->gend < index->gend))
+        this->grow(index->gend);
+    while (*tail)
+        tail = &(*tail)->overflow;
+    *tail = move(index);
+}
+
+
+// Number of partitions of level l, which cover the whole domain
+inline PartitionId HINT_M_Dynamic::getNumPartitions(unsigned int level) const
+{
+    return PartitionId(1) << (this->numBits-level);
+}
+
+
+// Number of levels: up to the root, or up to the first one whose partitions span 2^MAX_PARTITION_BITS timestamps
+inline unsigned int HINT_M_Dynamic::getHeight() const
+{
+    return min(this->numBits, MAX_PARTITION_BITS-(this->maxBits-this->numBits))+1;
+}
+
+
+// Determines the partitions of r, calling assign(subdivision, level, pid) for each of them from the bottom level up.
+// The top level has no level above it to take the partitions between a and b, so r goes to each of them; that is one partition,
+// the root, unless the domain spans more than 2^MAX_PARTITION_BITS timestamps.
+template <class Assign>
+inline void HINT_M_Dynamic::assignPartitions(const Record &r, Assign assign){
     int level = 0;
-    Timestamp a = r.start >> (this->maxBits-this->numBits);
-    Timestamp b = r.end   >> (this->maxBits-this->numBits);
+    Timestamp a = this->getOffset(r.start) >> (this->maxBits-this->numBits);
+    Timestamp b = this->getOffset(r.end)   >> (this->maxBits-this->numBits);
     Timestamp prevb;
     int firstfound = 0, lastfound = 0;
  
-    while (level < this->height && a <= b) {
+    while (level < this->height-1 && a <= b) {
         //last bit of a is 1
         if (a%2) { 
             if (firstfound) {
                 if ((a == b) && (!lastfound)) {
-                    this->pRepsInIds[level][a].emplace_back(r.id);
-                    this->pRepsInTimestamps[level][a].emplace_back(r.start, r.end);
+                    assign(REPS_IN, level, a);
                     lastfound = 1;
                 }
                 else {
-                    this->pRepsAftIds[level][a].emplace_back(r.id);
-                    this->pRepsAftTimestamps[level][a].emplace_back(r.start, r.end);
+                    assign(REPS_AFT, level, a);
                 }
             }
             else {
                 if ((a == b) && (!lastfound)) {
-                    this->pOrgsInIds[level][a].emplace_back(r.id);
-                    this->pOrgsInTimestamps[level][a].emplace_back(r.start, r.end);
+                    assign(ORGS_IN, level, a);
                 }
                 else {
-                    this->pOrgsAftIds[level][a].emplace_back(r.id);
-                    this->pOrgsAftTimestamps[level][a].emplace_back(r.start, r.end);
+                    assign(ORGS_AFT, level, a);
                 }
                 firstfound = 1;
             }
@@ -148,23 +271,19 @@ inline void HINT_M_Dynamic::updatePartitions(const Record &r){
             b--;
             if ((!firstfound) && b < a) {
                 if (!lastfound){
-                    this->pOrgsInIds[level][prevb].emplace_back(r.id);
-                    this->pOrgsInTimestamps[level][prevb].emplace_back(r.start, r.end);
+                    assign(ORGS_IN, level, prevb);
                 }
                 else{
-                    this->pOrgsAftIds[level][prevb].emplace_back(r.id);
-                    this->pOrgsAftTimestamps[level][prevb].emplace_back(r.start, r.end);
+                    assign(ORGS_AFT, level, prevb);
                 }
             }
             else{
                 if (!lastfound){
-                    this->pRepsInIds[level][prevb].emplace_back(r.id);
-                    this->pRepsInTimestamps[level][prevb].emplace_back(r.start, r.end);
+                    assign(REPS_IN, level, prevb);
                     lastfound = 1;
                 }
                 else{
-                    this->pRepsAftIds[level][prevb].emplace_back(r.id);
-                    this->pRepsAftTimestamps[level][prevb].emplace_back(r.start, r.end);
+                    assign(REPS_AFT, level, prevb);
                 }
             }
         }
@@ -172,670 +291,2707 @@ inline void HINT_M_Dynamic::updatePartitions(const Record &r){
         b >>= 1; // b = b div 2
         level++;
     }
+    
+    // Top level
+    for (Timestamp pid = a; pid <= b; pid++) {
+        if ((pid == b) && (!lastfound))
+            assign((firstfound)? REPS_IN: ORGS_IN, level, pid);
+        else
+            assign((firstfound)? REPS_AFT: ORGS_AFT, level, pid);
+        firstfound = 1;
+    }
 }
 
 
-// Creates a HINT^m containing one empty partition, no hierarchy
-HINT_M_Dynamic::HINT_M_Dynamic(Timestamp leafPartitionExtent)
+// Assumes that partitions to be updated already exist
+// This is the actual insertion function
+inline void HINT_M_Dynamic::updatePartitions(const Record &r, Payload payload){
+    LocalRecordId id = LocalRecordId(r.id-this->idBase);
+    
+    this->assignPartitions(r, [&](Subdivision subdivision, int level, PartitionId pid) {
+        Timestamp partitionStart = this->getPartitionStart(level, pid);
+        LocalTimestamp start = LocalTimestamp(r.start-partitionStart), end = LocalTimestamp(r.end-partitionStart);
+        size_t memoryUsage;
+        
+        switch (subdivision) {
+            case ORGS_IN:
+                memoryUsage = getInsertMemoryUsage(this->pOrgsInIds[level], this->pOrgsInXors[level], this->pOrgsInPayloads[level], NULL, &this->pOrgsInTimestamps[level], &this->pOrgsInZones[level], &this->pOrgsInSorted[level], this->pOrgsInDirectory[level], pid);
+                this->touchPartition(this->pOrgsInIds, this->pOrgsInDirectory, level, pid).emplace_back(id);
+                this->pOrgsInXors[level].touch(pid) ^= r.id;
+                this->pOrgsInTimestamps[level].touch(pid).emplace_back(start, end);
+                this->pOrgsInZones[level].touch(pid).add(make_pair(start, end));
+                if (this->keepsPayloads)
+                    this->pOrgsInPayloads[level].touch(pid).add(payload);
+                this->mergeTail(this->pOrgsInIds, this->pOrgsInTimestamps, this->pOrgsInPayloads, NULL, this->pOrgsInSorted, level, pid, false);
+                this->updateAggregates(level, pid);
+                this->memoryUsage += getInsertMemoryUsage(this->pOrgsInIds[level], this->pOrgsInXors[level], this->pOrgsInPayloads[level], NULL, &this->pOrgsInTimestamps[level], &this->pOrgsInZones[level], &this->pOrgsInSorted[level], this->pOrgsInDirectory[level], pid) - memoryUsage;
+                break;
+            case ORGS_AFT:
+                memoryUsage = getInsertMemoryUsage(this->pOrgsAftIds[level], this->pOrgsAftXors[level], this->pOrgsAftPayloads[level], &this->pOrgsAftEndpoints[level], &this->pOrgsAftStarts[level], &this->pOrgsAftZones[level], &this->pOrgsAftSorted[level], this->pOrgsAftDirectory[level], pid);
+                this->touchPartition(this->pOrgsAftIds, this->pOrgsAftDirectory, level, pid).emplace_back(id);
+                this->pOrgsAftXors[level].touch(pid) ^= r.id;
+                this->pOrgsAftStarts[level].touch(pid).emplace_back(start);
+                this->pOrgsAftZones[level].touch(pid).add(start);
+                if (this->keepsPayloads)
+                    this->pOrgsAftPayloads[level].touch(pid).add(payload);
+                if (this->keepsEndpoints)
+                    this->pOrgsAftEndpoints[level].touch(pid).ends.emplace_back(r.end-partitionStart);
+                this->mergeTail(this->pOrgsAftIds, this->pOrgsAftStarts, this->pOrgsAftPayloads, &this->pOrgsAftEndpoints, this->pOrgsAftSorted, level, pid, false);
+                this->memoryUsage += getInsertMemoryUsage(this->pOrgsAftIds[level], this->pOrgsAftXors[level], this->pOrgsAftPayloads[level], &this->pOrgsAftEndpoints[level], &this->pOrgsAftStarts[level], &this->pOrgsAftZones[level], &this->pOrgsAftSorted[level], this->pOrgsAftDirectory[level], pid) - memoryUsage;
+                break;
+            case REPS_IN:
+                memoryUsage = getInsertMemoryUsage(this->pRepsInIds[level], this->pRepsInXors[level], this->pRepsInPayloads[level], &this->pRepsInEndpoints[level], &this->pRepsInEnds[level], &this->pRepsInZones[level], &this->pRepsInSorted[level], this->pRepsInDirectory[level], pid);
+                this->touchPartition(this->pRepsInIds, this->pRepsInDirectory, level, pid).emplace_back(id);
+                this->pRepsInXors[level].touch(pid) ^= r.id;
+                this->pRepsInEnds[level].touch(pid).emplace_back(end);
+                this->pRepsInZones[level].touch(pid).add(end);
+                if (this->keepsPayloads)
+                    this->pRepsInPayloads[level].touch(pid).add(payload);
+                if (this->keepsEndpoints)
+                    this->pRepsInEndpoints[level].touch(pid).starts.emplace_back(r.start-partitionStart);
+                this->mergeTail(this->pRepsInIds, this->pRepsInEnds, this->pRepsInPayloads, &this->pRepsInEndpoints, this->pRepsInSorted, level, pid, false);
+                this->memoryUsage += getInsertMemoryUsage(this->pRepsInIds[level], this->pRepsInXors[level], this->pRepsInPayloads[level], &this->pRepsInEndpoints[level], &this->pRepsInEnds[level], &this->pRepsInZones[level], &this->pRepsInSorted[level], this->pRepsInDirectory[level], pid) - memoryUsage;
+                break;
+            default:
+                memoryUsage = getInsertMemoryUsage<LocalTimestamp>(this->pRepsAftIds[level], this->pRepsAftXors[level], this->pRepsAftPayloads[level], &this->pRepsAftEndpoints[level], NULL, NULL, NULL, this->pRepsAftDirectory[level], pid);
+                this->touchPartition(this->pRepsAftIds, this->pRepsAftDirectory, level, pid).emplace_back(id);
+                this->pRepsAftXors[level].touch(pid) ^= r.id;
+                if (this->keepsPayloads)
+                    this->pRepsAftPayloads[level].touch(pid).add(payload);
+                if (this->keepsEndpoints)
+                {
+                    this->pRepsAftEndpoints[level].touch(pid).starts.emplace_back(r.start-partitionStart);
+                    this->pRepsAftEndpoints[level].touch(pid).ends.emplace_back(r.end-partitionStart);
+                }
+                this->memoryUsage += getInsertMemoryUsage<LocalTimestamp>(this->pRepsAftIds[level], this->pRepsAftXors[level], this->pRepsAftPayloads[level], &this->pRepsAftEndpoints[level], NULL, NULL, NULL, this->pRepsAftDirectory[level], pid) - memoryUsage;
+                break;
+        }
+    });
+}
+
+
+// Partition pid of a subdivision for appending; registered in the directory when it receives its first entry.
+inline LocalRelationId& HINT_M_Dynamic::touchPartition(vector<PartitionBlocks<LocalRelationId> > &pIds, vector<PartitionDirectory> &pDirectory, unsigned int level, PartitionId pid)
 {
-    this->leafPartitionExtent = leafPartitionExtent;
-    this->gstart = 0;
-    this->gend   = this->leafPartitionExtent;
-    this->maxBits = int(log2(this->gend-this->gstart)+1);
+    LocalRelationId &ids = pIds[level].touch(pid);
+    
+    if (ids.empty())
+        pDirectory[level].insert(pid);
+    
+    return ids;
+}
+
+
+// Sets the number of levels of every subdivision to the height of the index.
+inline void HINT_M_Dynamic::resizeLevels()
+{
+    size_t numLevels = this->pOrgsInIds.size();
     
-    // Size for RecordId, vector<pair<Timestamp, Timestamp > > unset.
+    // Existing levels move along with their memory, new ones hold only the empty compacted layouts
+    this->memoryUsage -= this->getLevelsMemoryUsage();
     this->pOrgsInIds.resize(this->height);
-    this->pOrgsInIds[0].resize(1);
     this->pOrgsInTimestamps.resize(this->height);
-    this->pOrgsInTimestamps[0].resize(1);
-
     this->pOrgsAftIds.resize(this->height);
-    this->pOrgsAftIds[0].resize(1);
-    this->pOrgsAftTimestamps.resize(this->height);
-    this->pOrgsAftTimestamps[0].resize(1);
-
+    this->pOrgsAftStarts.resize(this->height);
     this->pRepsInIds.resize(this->height);
-    this->pRepsInIds[0].resize(1);
-    this->pRepsInTimestamps.resize(this->height);
-    this->pRepsInTimestamps[0].resize(1);
-
+    this->pRepsInEnds.resize(this->height);
     this->pRepsAftIds.resize(this->height);
-    this->pRepsAftIds[0].resize(1);
-    this->pRepsAftTimestamps.resize(this->height);
-    this->pRepsAftTimestamps[0].resize(1);
+    this->pOrgsInXors.resize(this->height);
+    this->pOrgsAftXors.resize(this->height);
+    this->pRepsInXors.resize(this->height);
+    this->pRepsAftXors.resize(this->height);
+    this->pOrgsInPayloads.resize(this->height);
+    this->pOrgsAftPayloads.resize(this->height);
+    this->pRepsInPayloads.resize(this->height);
+    this->pRepsAftPayloads.resize(this->height);
+    this->pOrgsAftEndpoints.resize(this->height);
+    this->pRepsInEndpoints.resize(this->height);
+    this->pRepsAftEndpoints.resize(this->height);
+    this->pOrgsInZones.resize(this->height);
+    this->pOrgsAftZones.resize(this->height);
+    this->pRepsInZones.resize(this->height);
+    this->pOrgsInSorted.resize(this->height);
+    this->pOrgsAftSorted.resize(this->height);
+    this->pRepsInSorted.resize(this->height);
+    this->pOrgsInAggregates.resize(this->height);
+    this->pOrgsInDirectory.resize(this->height);
+    this->pOrgsAftDirectory.resize(this->height);
+    this->pRepsInDirectory.resize(this->height);
+    this->pRepsAftDirectory.resize(this->height);
+    this->pOrgsInFrozen.resize(this->height);
+    this->pOrgsAftFrozen.resize(this->height);
+    this->pRepsInFrozen.resize(this->height);
+    this->pRepsAftFrozen.resize(this->height);
+    this->memoryUsage += this->getLevelsMemoryUsage();
+    for (auto l = numLevels; l < this->height; l++)
+    {
+        this->pOrgsInFrozen[l].setCompressed(this->compressFrozen);
+        this->pOrgsAftFrozen[l].setCompressed(this->compressFrozen);
+        this->pRepsInFrozen[l].setCompressed(this->compressFrozen);
+        this->pRepsAftFrozen[l].setCompressed(this->compressFrozen);
+        this->memoryUsage += this->pOrgsInFrozen[l].getMemoryUsage() + this->pOrgsAftFrozen[l].getMemoryUsage() + this->pRepsInFrozen[l].getMemoryUsage() + this->pRepsAftFrozen[l].getMemoryUsage();
+    }
 }
 
 
-// Creates a HINT^m for input R.
-HINT_M_Dynamic::HINT_M_Dynamic(const Relation &R, const unsigned int numBits, const unsigned int maxBits) : HierarchicalIndex(R, numBits, maxBits)
+// Memory of the per-level vectors of every subdivision.
+inline size_t HINT_M_Dynamic::getLevelsMemoryUsage() const
 {
-    this->gstart = R.gstart;
-    this->gend = R.gend;
-    this->leafPartitionExtent = ceil((R.gend-R.gstart)/(float)pow(2, this->numBits));
-    
+    return getAllocationSize(this->pOrgsInIds) + getAllocationSize(this->pOrgsInTimestamps) + getAllocationSize(this->pOrgsAftIds) + getAllocationSize(this->pOrgsAftStarts)
+         + getAllocationSize(this->pRepsInIds) + getAllocationSize(this->pRepsInEnds) + getAllocationSize(this->pRepsAftIds)
+         + getAllocationSize(this->pOrgsInXors) + getAllocationSize(this->pOrgsAftXors) + getAllocationSize(this->pRepsInXors) + getAllocationSize(this->pRepsAftXors)
+         + getAllocationSize(this->pOrgsInPayloads) + getAllocationSize(this->pOrgsAftPayloads) + getAllocationSize(this->pRepsInPayloads) + getAllocationSize(this->pRepsAftPayloads)
+         + getAllocationSize(this->pOrgsAftEndpoints) + getAllocationSize(this->pRepsInEndpoints) + getAllocationSize(this->pRepsAftEndpoints)
+         + getAllocationSize(this->pOrgsInZones) + getAllocationSize(this->pOrgsAftZones) + getAllocationSize(this->pRepsInZones)
+         + getAllocationSize(this->pOrgsInSorted) + getAllocationSize(this->pOrgsAftSorted) + getAllocationSize(this->pRepsInSorted) + getAllocationSize(this->pOrgsInAggregates)
+         + getAllocationSize(this->pOrgsInDirectory) + getAllocationSize(this->pOrgsAftDirectory) + getAllocationSize(this->pRepsInDirectory) + getAllocationSize(this->pRepsAftDirectory)
+         + getAllocationSize(this->pOrgsInFrozen) + getAllocationSize(this->pOrgsAftFrozen) + getAllocationSize(this->pRepsInFrozen) + getAllocationSize(this->pRepsAftFrozen);
+}
+
 
-    // Step 1: one pass to count the contents inside each partition.
-    this->pOrgsIn_sizes  = (RecordId **)malloc(this->height*sizeof(RecordId *));
-    this->pOrgsAft_sizes = (RecordId **)malloc(this->height*sizeof(RecordId *));
-    this->pRepsIn_sizes  = (size_t **)malloc(this->height*sizeof(size_t *));
-    this->pRepsAft_sizes = (size_t **)malloc(this->height*sizeof(size_t *));
+// Brings the aggregates of OrgsIn partition pid in line with its sorted body, kept only on the top NUM_AGGREGATED_LEVELS levels.
+// A body changes only in length (a merged tail, deleted fossils, a compaction), so the aggregates are rebuilt when the lengths differ.
+inline void HINT_M_Dynamic::updateAggregates(unsigned int level, PartitionId pid)
+{
+    PartitionBlocks<OverlapAggregates> &pAggregates = this->pOrgsInAggregates[level];
+    size_t sortedSize = (level+NUM_AGGREGATED_LEVELS >= this->height)? this->pOrgsInSorted[level][pid]: 0;
+    size_t memoryUsage;
+    
+    if (sortedSize == pAggregates[pid].size())
+        return;
     
+    memoryUsage = pAggregates.getMemoryUsage() + getAllocationSize(pAggregates[pid]);
+    if (sortedSize > 0)
+        pAggregates.touch(pid).build(this->idBase, this->pOrgsInIds[level][pid].data(), this->pOrgsInTimestamps[level][pid].data(), sortedSize);
+    else
+        pAggregates.touch(pid).clear();
+    this->memoryUsage += pAggregates.getMemoryUsage() + getAllocationSize(pAggregates[pid]) - memoryUsage;
+}
+
+
+// Same for every partition; the levels that left the top with a growth of the index drop their aggregates as a whole.
+inline void HINT_M_Dynamic::updateAggregates()
+{
     for (auto l = 0; l < this->height; l++)
     {
-        auto cnt = (int)(pow(2, this->numBits-l));
+        PartitionBlocks<OverlapAggregates> &pAggregates = this->pOrgsInAggregates[l];
         
-        //calloc allocates memory and sets each counter to 0
-        this->pOrgsIn_sizes[l]  = (RecordId *)calloc(cnt, sizeof(RecordId));
-        this->pOrgsAft_sizes[l] = (RecordId *)calloc(cnt, sizeof(RecordId));
-        this->pRepsIn_sizes[l]  = (size_t *)calloc(cnt, sizeof(size_t));
-        this->pRepsAft_sizes[l] = (size_t *)calloc(cnt, sizeof(size_t));
+        if (l+NUM_AGGREGATED_LEVELS < this->height)
+        {
+            for (PartitionId pid = 0; pid < (PartitionId)pAggregates.size(); pid++)
+                this->memoryUsage -= getAllocationSize(pAggregates[pid]);
+            this->memoryUsage -= pAggregates.getMemoryUsage();
+            pAggregates = PartitionBlocks<OverlapAggregates>();
+            this->memoryUsage += pAggregates.getMemoryUsage();
+        }
+        else
+        {
+            for (PartitionId pid = 0; pid < (PartitionId)max(pAggregates.size(), this->pOrgsInSorted[l].size()); pid++)
+                this->updateAggregates(l, pid);
+        }
     }
+}
+
+
+// Sorts the entries [sortedSize, size) and merges them into the sorted [0, sortedSize).
+template <class Entry>
+static inline void mergeEntries(vector<Entry> &entries, size_t sortedSize)
+{
+    sort(entries.begin()+sortedSize, entries.end());
+    inplace_merge(entries.begin(), entries.begin()+sortedSize, entries.end());
+}
+
+
+// Reorders values, if not empty, as the merged entries, which carry the position each one came from.
+template <class V, class Entry>
+static inline void permuteEntries(vector<V> &values, const vector<Entry> &entries)
+{
+    if (values.empty())
+        return;
     
-    for (const Record &r : R)
-        this->updateCounters(r);
+    vector<V> permuted;
     
-    // Step 2: allocate necessary memory.
-    this->pOrgsInIds.resize(this->height);
-    this->pOrgsAftIds.resize(this->height);
-    this->pRepsInIds.resize(this->height);
-    this->pRepsAftIds.resize(this->height);
-    this->pOrgsInTimestamps.resize(this->height);
-    this->pOrgsAftTimestamps.resize(this->height);
-    this->pRepsInTimestamps.resize(this->height);
-    this->pRepsAftTimestamps.resize(this->height);
-    for (auto l = 0; l < this->height; l++)
+    permuted.reserve(entries.size());
+    for (const Entry &entry : entries)
+        permuted.push_back(values[entry.second]);
+    copy(permuted.begin(), permuted.end(), values.begin());
+}
+
+
+// Merges the append tail of partition pid into its sorted body, if the tail has grown past its threshold or force is set.
+// Entries are ordered on their timestamp entry (pair on start first) and then on id; payloads and endpoints, if kept, move along with their ids.
+// Partitions too short for the binary search to pay off stay in arrival order, i.e., on end for the dead tier,
+// which keeps the comparisons of the scalar kernels predictable. pEndpoints is null for OrgsIn.
+template <class T>
+inline void HINT_M_Dynamic::mergeTail(vector<PartitionBlocks<LocalRelationId> > &pIds, vector<PartitionBlocks<vector<T> > > &pTimestamps, vector<PartitionBlocks<PartitionPayloads> > &pPayloads, vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, vector<PartitionBlocks<uint32_t> > &pSorted, unsigned int level, PartitionId pid, bool force)
+{
+    size_t size = pIds[level][pid].size();
+    size_t sortedSize = pSorted[level][pid];
+    size_t tailSize = size-sortedSize;
+    
+    if ((tailSize == 0) || (size < SCAN_SORTED_MIN_SIZE))
+        return;
+    if ((!force) && ((tailSize < MIN_TAIL_SIZE) || (tailSize < (sortedSize >> TAIL_RATIO_BITS))))
+        return;
+    
+    LocalRelationId &ids = pIds[level].touch(pid);
+    vector<T> &timestamps = pTimestamps[level].touch(pid);
+    
+    if ((this->keepsPayloads) || ((this->keepsEndpoints) && (pEndpoints)))
     {
-        auto cnt = (int)(pow(2, this->numBits-l));
+        // The other columns follow the position of each entry
+        vector<pair<pair<T, LocalRecordId>, uint32_t> > entries;
         
-        this->pOrgsInIds[l].resize(cnt);
-        this->pOrgsAftIds[l].resize(cnt);
-        this->pRepsInIds[l].resize(cnt);
-        this->pRepsAftIds[l].resize(cnt);
-        this->pOrgsInTimestamps[l].resize(cnt);
-        this->pOrgsAftTimestamps[l].resize(cnt);
-        this->pRepsInTimestamps[l].resize(cnt);
-        this->pRepsAftTimestamps[l].resize(cnt);
-
-        for (auto pId = 0; pId < cnt; pId++)
+        entries.reserve(size);
+        for (size_t i = 0; i < size; i++)
+            entries.emplace_back(make_pair(timestamps[i], ids[i]), uint32_t(i));
+        mergeEntries(entries, sortedSize);
+        for (size_t i = 0; i < size; i++)
+        {
+            timestamps[i] = entries[i].first.first;
+            ids[i] = entries[i].first.second;
+        }
+        if (this->keepsPayloads)
+            permuteEntries(pPayloads[level].touch(pid).values, entries);
+        if ((this->keepsEndpoints) && (pEndpoints))
+        {
+            PartitionEndpoints &endpoints = (*pEndpoints)[level].touch(pid);
+            
+            permuteEntries(endpoints.starts, entries);
+            permuteEntries(endpoints.ends, entries);
+        }
+    }
+    else
+    {
+        vector<pair<T, LocalRecordId> > entries;
+        
+        entries.reserve(size);
+        for (size_t i = 0; i < size; i++)
+            entries.emplace_back(timestamps[i], ids[i]);
+        mergeEntries(entries, sortedSize);
+        for (size_t i = 0; i < size; i++)
         {
-            this->pOrgsInIds[l][pId].reserve(this->pOrgsIn_sizes[l][pId]);
-            this->pOrgsAftIds[l][pId].reserve(this->pOrgsAft_sizes[l][pId]);
-            this->pRepsInIds[l][pId].reserve(this->pRepsIn_sizes[l][pId]);
-            this->pRepsAftIds[l][pId].reserve(this->pRepsAft_sizes[l][pId]);
-            this->pOrgsInTimestamps[l][pId].reserve(this->pOrgsIn_sizes[l][pId]);
-            this->pOrgsAftTimestamps[l][pId].reserve(this->pOrgsAft_sizes[l][pId]);
-            this->pRepsInTimestamps[l][pId].reserve(this->pRepsIn_sizes[l][pId]);
-            this->pRepsAftTimestamps[l][pId].reserve(this->pRepsAft_sizes[l][pId]);
+            timestamps[i] = entries[i].first;
+            ids[i] = entries[i].second;
         }
     }
+    pSorted[level].touch(pid) = size;
+}
+
+
+// Moves the non-empty partitions in [frozen size, numPartitions) of the level to the end of its compacted layout and drops them from the blocks.
+// Their tails are merged first, so compacted partitions are entirely sorted. pEndpoints is null for OrgsIn.
+template <class T>
+inline void HINT_M_Dynamic::freezePartitions(vector<PartitionBlocks<LocalRelationId> > &pIds, vector<PartitionBlocks<RecordId> > &pXors, vector<PartitionBlocks<PartitionPayloads> > &pPayloads, vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, vector<PartitionBlocks<vector<T> > > &pTimestamps, vector<PartitionBlocks<ZoneMap<T> > > &pZones, vector<PartitionBlocks<uint32_t> > &pSorted, vector<PartitionDirectory> &pDirectory, vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId numPartitions)
+{
+    FrozenPartitions<T> &frozen = pFrozen[level];
+    PartitionDirectory &directory = pDirectory[level];
     
-    // Step 3: fill partitions.
-    for (const Record &r : R)
-        this->updatePartitions(r);
+    if (numPartitions <= (PartitionId)frozen.getNumPartitions())
+        return;
     
-    // Free auxiliary memory.
-    for (auto l = 0; l < this->height; l++)
+    PartitionBlocks<PartitionEndpoints> *levelEndpoints = (pEndpoints)? &(*pEndpoints)[level]: NULL;
+    size_t memoryUsage = getLevelMemoryUsage(frozen, pIds[level], pXors[level], pPayloads[level], levelEndpoints, &pTimestamps[level], &pZones[level], &pSorted[level], directory);
+    
+    for (size_t k = 0; (k < directory.pids.size()) && (directory.pids[k] < numPartitions); k++)
     {
-        free(this->pOrgsIn_sizes[l]);
-        free(this->pOrgsAft_sizes[l]);
-        free(this->pRepsIn_sizes[l]);
-        free(this->pRepsAft_sizes[l]);
+        PartitionId pid = directory.pids[k];
+        
+        memoryUsage += getPartitionMemoryUsage(pIds[level], pPayloads[level], levelEndpoints, &pTimestamps[level], pid);
+        this->mergeTail(pIds, pTimestamps, pPayloads, pEndpoints, pSorted, level, pid, true);
+        frozen.append(pid, pIds[level][pid], this->idBase, pTimestamps[level][pid]);
+        frozen.appendPayloads(pPayloads[level][pid]);
+        if (levelEndpoints)
+            frozen.appendEndpoints((*levelEndpoints)[pid]);
     }
-    free(this->pOrgsIn_sizes);
-    free(this->pOrgsAft_sizes);
-    free(this->pRepsIn_sizes);
-    free(this->pRepsAft_sizes);
+    frozen.numPartitions = numPartitions;
+    if (numPartitions == this->getNumPartitions(level))
+        frozen.shrinkToFit();
+    directory.release(numPartitions);
+    pIds[level].release(numPartitions);
+    pXors[level].release(numPartitions);
+    pPayloads[level].release(numPartitions);
+    if (levelEndpoints)
+        levelEndpoints->release(numPartitions);
+    pTimestamps[level].release(numPartitions);
+    pZones[level].release(numPartitions);
+    pSorted[level].release(numPartitions);
+    this->memoryUsage += getLevelMemoryUsage(frozen, pIds[level], pXors[level], pPayloads[level], levelEndpoints, &pTimestamps[level], &pZones[level], &pSorted[level], directory) - memoryUsage;
 }
 
 
-void HINT_M_Dynamic::getStats()
+// Same for a subdivision that keeps ids only.
+template <class T>
+inline void HINT_M_Dynamic::freezePartitions(vector<PartitionBlocks<LocalRelationId> > &pIds, vector<PartitionBlocks<RecordId> > &pXors, vector<PartitionBlocks<PartitionPayloads> > &pPayloads, vector<PartitionBlocks<PartitionEndpoints> > &pEndpoints, vector<PartitionDirectory> &pDirectory, vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId numPartitions)
 {
-    size_t sum = 0;
+    FrozenPartitions<T> &frozen = pFrozen[level];
+    PartitionDirectory &directory = pDirectory[level];
+    
+    if (numPartitions <= (PartitionId)frozen.getNumPartitions())
+        return;
+    
+    size_t memoryUsage = getLevelMemoryUsage<T>(frozen, pIds[level], pXors[level], pPayloads[level], &pEndpoints[level], NULL, NULL, NULL, directory);
+    
+    for (size_t k = 0; (k < directory.pids.size()) && (directory.pids[k] < numPartitions); k++)
+    {
+        memoryUsage += getPartitionMemoryUsage<T>(pIds[level], pPayloads[level], &pEndpoints[level], NULL, directory.pids[k]);
+        frozen.append(directory.pids[k], pIds[level][directory.pids[k]], this->idBase);
+        frozen.appendPayloads(pPayloads[level][directory.pids[k]]);
+        frozen.appendEndpoints(pEndpoints[level][directory.pids[k]]);
+    }
+    frozen.numPartitions = numPartitions;
+    if (numPartitions == this->getNumPartitions(level))
+        frozen.shrinkToFit();
+    directory.release(numPartitions);
+    pIds[level].release(numPartitions);
+    pXors[level].release(numPartitions);
+    pPayloads[level].release(numPartitions);
+    pEndpoints[level].release(numPartitions);
+    this->memoryUsage += getLevelMemoryUsage<T>(frozen, pIds[level], pXors[level], pPayloads[level], &pEndpoints[level], NULL, NULL, NULL, directory) - memoryUsage;
+}
 
 
-    this->numPartitions = this->numEmptyPartitions = 0;
+// Compacts the partitions whose time range ends before t.
+// The caller guarantees that no record inserted from now on starts before t (e.g., t is the lowest start in the live index),
+// hence these partitions can no longer receive inserts. A level compacted as a whole gives back the spare memory of its columns,
+// e.g., every level once t lies past the end of the data.
+void HINT_M_Dynamic::freeze(Timestamp t)
+{
+    if (this->overflow)
+        this->overflow->freeze(t);
+    
+    // An index that holds no records yet has no origin; it is anchored by its first insert
+    if ((!this->isAnchored) || (t <= this->gstart))
+        return;
+    
     for (auto l = 0; l < this->height; l++)
     {
-        auto cnt = pow(2, this->numBits-l);
+        auto shift = this->maxBits-this->numBits+l;
         
-        this->numPartitions += cnt;
-        for (int pid = 0; pid < cnt; pid++)
-        {
-            this->numOriginalsIn  += this->pOrgsInIds[l][pid].size();
-            this->numOriginalsAft += this->pOrgsAftIds[l][pid].size();
-            this->numReplicasIn   += this->pRepsInIds[l][pid].size();
-            this->numReplicasAft  += this->pRepsAftIds[l][pid].size();
-            if ((this->pOrgsInIds[l][pid].empty()) && (this->pOrgsAftIds[l][pid].empty()) && (this->pRepsInIds[l][pid].empty()) && (this->pRepsAftIds[l][pid].empty()))
-                this->numEmptyPartitions++;
-        }
+        if (shift >= sizeof(Timestamp)*8-1)
+            break;
+        
+        // Partition j of level l covers offsets [j << shift, (j+1) << shift)
+        PartitionId numPartitions = PartitionId(min<Timestamp>(this->getOffset(t) >> shift, this->getNumPartitions(l)));
+        
+        this->freezePartitions(this->pOrgsInIds, this->pOrgsInXors, this->pOrgsInPayloads, NULL, this->pOrgsInTimestamps, this->pOrgsInZones, this->pOrgsInSorted, this->pOrgsInDirectory, this->pOrgsInFrozen, l, numPartitions);
+        this->freezePartitions(this->pOrgsAftIds, this->pOrgsAftXors, this->pOrgsAftPayloads, &this->pOrgsAftEndpoints, this->pOrgsAftStarts, this->pOrgsAftZones, this->pOrgsAftSorted, this->pOrgsAftDirectory, this->pOrgsAftFrozen, l, numPartitions);
+        this->freezePartitions(this->pRepsInIds, this->pRepsInXors, this->pRepsInPayloads, &this->pRepsInEndpoints, this->pRepsInEnds, this->pRepsInZones, this->pRepsInSorted, this->pRepsInDirectory, this->pRepsInFrozen, l, numPartitions);
+        this->freezePartitions(this->pRepsAftIds, this->pRepsAftXors, this->pRepsAftPayloads, this->pRepsAftEndpoints, this->pRepsAftDirectory, this->pRepsAftFrozen, l, numPartitions);
     }
+    this->updateAggregates();
+}
+
+
+// Creates a HINT^m containing one empty partition, no hierarchy; a leaf spans less than 2^MAX_PARTITION_BITS timestamps
+HINT_M_Dynamic::HINT_M_Dynamic(Timestamp leafPartitionExtent)
+{
+    this->leafPartitionExtent = min(leafPartitionExtent, (Timestamp(1) << MAX_PARTITION_BITS)-1);
+    this->gstart = 0;
+    this->gend   = this->leafPartitionExtent;
+    this->maxBits = int(log2(this->gend-this->gstart)+1);
+    this->compressFrozen = false;
+    this->keepsPayloads = false;
+    this->keepsEndpoints = false;
+    this->memoryUsage = 0;
+    this->isAnchored = false;
+    this->idBase = 0;
     
-    this->avgPartitionSize = (float)(this->numIndexedRecords+this->numReplicasIn+this->numReplicasAft)/(this->numPartitions-numEmptyPartitions);
+    // Partitions are allocated on first touch.
+    this->resizeLevels();
 }
 
 
-void HINT_M_Dynamic::print(char c)
+// Creates a HINT^m for input R; numBits is raised if the leaves would span over 2^MAX_PARTITION_BITS timestamps.
+HINT_M_Dynamic::HINT_M_Dynamic(const Relation &R, const unsigned int numBits, const unsigned int maxBits, unsigned int numThreads) : HierarchicalIndex(R, numBits, maxBits)
 {
-    for (auto l = 0; l < this->height; l++)
+    this->numBits = max(this->numBits, (this->maxBits > MAX_PARTITION_BITS)? this->maxBits-MAX_PARTITION_BITS: 0);
+    this->height = this->getHeight();
+    this->gstart = R.gstart;
+    this->gend = R.gend;
+    this->leafPartitionExtent = ((R.gend-R.gstart) >> this->numBits) + (((R.gend-R.gstart) & ((Timestamp(1) << this->numBits)-1)) > 0);
+    this->compressFrozen = false;
+    this->keepsPayloads = false;
+    this->keepsEndpoints = false;
+    this->memoryUsage = 0;
+    this->isAnchored = true;
+    
+    this->bulkLoad(R, numThreads);
+}
+
+
+// Creates a HINT^m for input R with the layout that inserting R one record at a time would produce,
+// i.e., numBits is the least that covers the last end of R with partitions of leafPartitionExtent, from the first start of R;
+// keepEndpoints enables the endpoints first, see enableEndpoints().
+HINT_M_Dynamic::HINT_M_Dynamic(Timestamp leafPartitionExtent, const Relation &R, unsigned int numThreads, bool keepEndpoints) : HINT_M_Dynamic(leafPartitionExtent)
+{
+    Timestamp start = numeric_limits<Timestamp>::max(), end = 0;
+    
+    this->keepsEndpoints = keepEndpoints;
+    for (const Record &r : R)
     {
-        auto cnt = pow(2, this->numBits-l);
-        
-        cout << "Level " << l << " contaning " << cnt << " partition(s)" << endl;
-        for (auto p = 0; p < cnt; p++)
+        start = min(start, r.start);
+        end = max(end, r.end);
+    }
+    if (!R.empty())
+        this->anchor(start);
+    if (this->gend < end)
+        this->grow(end);
+    
+    this->bulkLoad(R, numThreads);
+}
+
+
+// Writes one level of a subdivision: its compacted layout, then its hot partitions in the same CSR form
+// (offsets, ids, timestamps, payloads and endpoints if kept and the lengths of the sorted bodies); pTimestamps and pSorted are null
+// for a subdivision that keeps ids only, pEndpoints for OrgsIn.
+template <class T>
+static void saveLevel(SnapshotWriter &writer, const FrozenPartitions<T> &frozen, const PartitionBlocks<LocalRelationId> &pIds, const PartitionBlocks<PartitionPayloads> &pPayloads, const PartitionBlocks<PartitionEndpoints> *pEndpoints, const PartitionBlocks<vector<T> > *pTimestamps, const PartitionBlocks<uint32_t> *pSorted, const PartitionDirectory &directory)
+{
+    vector<size_t> offsets(1, 0);
+    vector<LocalRecordId> ids;
+    vector<uint32_t> sortedSizes;
+    vector<T> timestamps;
+    vector<Payload> payloads;
+    vector<Timestamp> starts, ends;
+    
+    frozen.save(writer);
+    writer.write(directory.pids);
+    for (PartitionId pid : directory.pids)
+    {
+        ids.insert(ids.end(), pIds[pid].begin(), pIds[pid].end());
+        offsets.push_back(ids.size());
+        if (pTimestamps)
+            timestamps.insert(timestamps.end(), (*pTimestamps)[pid].begin(), (*pTimestamps)[pid].end());
+        payloads.insert(payloads.end(), pPayloads[pid].values.begin(), pPayloads[pid].values.end());
+        if (pEndpoints)
         {
-            cout << "\tPartition " << p << endl;
-            cout << "\t\tOrgsIn[" << p << "] (" << this->pOrgsInIds[l][p].size() << "):";
-            for (auto i = 0; i < this->pOrgsInIds[l][p].size(); i++)
-            {
-                cout << " " << c << this->pOrgsInIds[l][p][i] << "[" << this->pOrgsInTimestamps[l][p][i].first << ".." << this->pOrgsInTimestamps[l][p][i].second << "]";
-            }
-            cout << endl;
-            cout << "\t\tOrgsAft[" << p << "] (" << this->pOrgsAftIds[l][p].size() << "):";
-            for (auto i = 0; i < this->pOrgsAftIds[l][p].size(); i++)
-            {
-                cout << " " << c << this->pOrgsAftIds[l][p][i] << "[" << this->pOrgsAftTimestamps[l][p][i].first << ".." << this->pOrgsAftTimestamps[l][p][i].second << "]";
-            }
-            cout << endl;
-            cout << "\t\tRepsIn[" << p << "] (" << this->pRepsInIds[l][p].size() << "):";
-            for (auto i = 0; i < this->pRepsInIds[l][p].size(); i++)
-            {
-                cout << " " << c << this->pRepsInIds[l][p][i] << "[" << this->pRepsInTimestamps[l][p][i].first << ".." << this->pRepsInTimestamps[l][p][i].second << "]";
-            }
-            cout << endl;
-            cout << "\t\tRepsAft[" << p << "] (" << this->pRepsAftIds[l][p].size() << "):";
-            for (auto i = 0; i < this->pRepsAftIds[l][p].size(); i++)
-            {
-                cout << " " << c << this->pRepsAftIds[l][p][i] << "[" << this->pRepsAftTimestamps[l][p][i].first << ".." << this->pRepsAftTimestamps[l][p][i].second << "]";
-            }
-            cout << endl;
+            starts.insert(starts.end(), (*pEndpoints)[pid].starts.begin(), (*pEndpoints)[pid].starts.end());
+            ends.insert(ends.end(), (*pEndpoints)[pid].ends.begin(), (*pEndpoints)[pid].ends.end());
         }
+        if (pSorted)
+            sortedSizes.push_back((*pSorted)[pid]);
     }
+    writer.write(offsets);
+    writer.write(ids);
+    writer.write(timestamps);
+    writer.write(payloads);
+    writer.write(starts);
+    writer.write(ends);
+    writer.write(sortedSizes);
 }
 
 
-// Querying
-size_t HINT_M_Dynamic::execute_pureTimeTravel(RangeQuery Q)
+// Reads back a level written by saveLevel(); the compacted layout stays in the snapshot, each hot partition is copied as a whole
+// and its XOR and zone map taken on the way.
+template <class T>
+static void loadLevel(const shared_ptr<Snapshot> &snapshot, RecordId idBase, FrozenPartitions<T> &frozen, PartitionBlocks<LocalRelationId> &pIds, PartitionBlocks<RecordId> &pXors, PartitionBlocks<PartitionPayloads> &pPayloads, PartitionBlocks<PartitionEndpoints> *pEndpoints, PartitionBlocks<vector<T> > *pTimestamps, PartitionBlocks<ZoneMap<T> > *pZones, PartitionBlocks<uint32_t> *pSorted, PartitionDirectory &directory)
 {
-    size_t result = 0;
-    vector<pair<Timestamp, Timestamp> >::iterator iter, iterStart, iterEnd;
-    RelationIdIterator iterI, iterIStart, iterIEnd;
-    Timestamp a = Q.start >> (this->maxBits-this->numBits); // prefix
-    Timestamp b = Q.end   >> (this->maxBits-this->numBits); // prefix
-    bool foundzero = false;
-    bool foundone = false;
+    size_t numOffsets, numIds, numTimestamps, numPayloads, numStarts, numEnds, numSortedSizes;
     
-
-    for (auto l = 0; l < this->numBits; l++)
+    frozen.load(snapshot);
+    snapshot->read(directory.pids);
+    
+    const size_t *offsets        = snapshot->view<size_t>(numOffsets);
+    const LocalRecordId *ids     = snapshot->view<LocalRecordId>(numIds);
+    const T *timestamps          = snapshot->view<T>(numTimestamps);
+    const Payload *payloads      = snapshot->view<Payload>(numPayloads);
+    const Timestamp *starts      = snapshot->view<Timestamp>(numStarts);
+    const Timestamp *ends        = snapshot->view<Timestamp>(numEnds);
+    const uint32_t *sortedSizes  = snapshot->view<uint32_t>(numSortedSizes);
+    
+    if ((numOffsets != directory.pids.size()+1) || (offsets[numOffsets-1] != numIds) || ((pTimestamps) && (numTimestamps != numIds)) || ((numPayloads > 0) && (numPayloads != numIds)) || ((numStarts > 0) && ((!pEndpoints) || (numStarts != numIds))) || ((numEnds > 0) && ((!pEndpoints) || (numEnds != numIds))) || ((pSorted) && (numSortedSizes != directory.pids.size())))
+        throw runtime_error("Corrupt snapshot");
+    
+    for (size_t k = 0; k < directory.pids.size(); k++)
     {
-        if (foundone && foundzero)
+        PartitionId pid = directory.pids[k];
+        
+        RecordId &idsXor = pXors.touch(pid);
+        
+        pIds.touch(pid).assign(ids+offsets[k], ids+offsets[k+1]);
+        for (size_t i = offsets[k]; i < offsets[k+1]; i++)
+            idsXor ^= idBase+ids[i];
+        if (pTimestamps)
         {
-            // Partition totally covers lowest-level partition range that includes query range
-            // all contents are guaranteed to be results
-            
-            // Handle the partition that contains a: consider both originals and replicas
-            iterIStart = this->pRepsInIds[l][a].begin();
-            iterIEnd = this->pRepsInIds[l][a].end();
-            for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-            {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
-            }
-            iterIStart =this->pRepsAftIds[l][a].begin();
-            iterIEnd = this->pRepsAftIds[l][a].end();
-            for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-            {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
-            }
-            
-            // Handle rest: consider only originals
-            for (auto j = a; j <= b; j++)
-            {
-                iterIStart = this->pOrgsInIds[l][j].begin();
-                iterIEnd = this->pOrgsInIds[l][j].end();
-                for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-                {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
-                }
-                iterIStart = this->pOrgsAftIds[l][j].begin();
-                iterIEnd = this->pOrgsAftIds[l][j].end();
-                for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-                {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
-                }
-            }
+            pTimestamps->touch(pid).assign(timestamps+offsets[k], timestamps+offsets[k+1]);
+            updateZone(*pTimestamps, *pZones, pid);
         }
-        else
+        if (numPayloads > 0)
         {
-            // Comparisons needed
+            PartitionPayloads &partitionPayloads = pPayloads.touch(pid);
             
-            // Handle the partition that contains a: consider both originals and replicas, comparisons needed
-            if (a == b)
-            {
-                // Special case when query overlaps only one partition, Lemma 3
-                if (!foundzero && !foundone)
-                {
-                    iterI = this->pOrgsInIds[l][a].begin();
-                    iterStart = this->pOrgsInTimestamps[l][a].begin();
-                    iterEnd = this->pOrgsInTimestamps[l][a].end();
-                    for (iter = iterStart; iter != iterEnd; iter++)
-                    {
-                        if ((iter->first <= Q.end) && (Q.start <= iter->second))
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                        iterI++;
-                    }
-                    iterI = this->pOrgsAftIds[l][a].begin();
-                    iterStart = this->pOrgsAftTimestamps[l][a].begin();
-                    iterEnd = this->pOrgsAftTimestamps[l][a].end();
-                    for (iter = iterStart; iter != iterEnd; iter++)
+            partitionPayloads.values.assign(payloads+offsets[k], payloads+offsets[k+1]);
+            partitionPayloads.updateAggregate();
+        }
+        if (numStarts > 0)
+            pEndpoints->touch(pid).starts.assign(starts+offsets[k], starts+offsets[k+1]);
+        if (numEnds > 0)
+            pEndpoints->touch(pid).ends.assign(ends+offsets[k], ends+offsets[k+1]);
+        if ((pSorted) && (sortedSizes[k] > 0))
+            pSorted->touch(pid) = sortedSizes[k];
+    }
+}
+
+
+// Restores a HINT^m written by save(); the compacted partitions, i.e., all but the most recent ones, are used straight from the snapshot,
+// so the time to restart depends on the partitions and not on the records indexed.
+HINT_M_Dynamic::HINT_M_Dynamic(const shared_ptr<Snapshot> &snapshot)
+{
+    this->leafPartitionExtent = snapshot->read<Timestamp>();
+    this->gstart              = snapshot->read<Timestamp>();
+    this->gend                = snapshot->read<Timestamp>();
+    this->isAnchored          = snapshot->read<bool>();
+    this->idBase              = snapshot->read<RecordId>();
+    this->numBits             = snapshot->read<unsigned int>();
+    this->maxBits             = snapshot->read<unsigned int>();
+    this->height              = snapshot->read<unsigned int>();
+    this->numIndexedRecords   = snapshot->read<size_t>();
+    this->compressFrozen      = snapshot->read<bool>();
+    this->keepsPayloads       = snapshot->read<bool>();
+    this->keepsEndpoints      = snapshot->read<bool>();
+    this->memoryUsage         = 0;
+    
+    this->resizeLevels();
+    for (auto l = 0; l < this->height; l++)
+    {
+        loadLevel(snapshot, this->idBase, this->pOrgsInFrozen[l], this->pOrgsInIds[l], this->pOrgsInXors[l], this->pOrgsInPayloads[l], NULL, &this->pOrgsInTimestamps[l], &this->pOrgsInZones[l], &this->pOrgsInSorted[l], this->pOrgsInDirectory[l]);
+        loadLevel(snapshot, this->idBase, this->pOrgsAftFrozen[l], this->pOrgsAftIds[l], this->pOrgsAftXors[l], this->pOrgsAftPayloads[l], &this->pOrgsAftEndpoints[l], &this->pOrgsAftStarts[l], &this->pOrgsAftZones[l], &this->pOrgsAftSorted[l], this->pOrgsAftDirectory[l]);
+        loadLevel(snapshot, this->idBase, this->pRepsInFrozen[l], this->pRepsInIds[l], this->pRepsInXors[l], this->pRepsInPayloads[l], &this->pRepsInEndpoints[l], &this->pRepsInEnds[l], &this->pRepsInZones[l], &this->pRepsInSorted[l], this->pRepsInDirectory[l]);
+        loadLevel<LocalTimestamp>(snapshot, this->idBase, this->pRepsAftFrozen[l], this->pRepsAftIds[l], this->pRepsAftXors[l], this->pRepsAftPayloads[l], &this->pRepsAftEndpoints[l], NULL, NULL, NULL, this->pRepsAftDirectory[l]);
+    }
+    this->updateAggregates();
+    this->memoryUsage = this->computeMemoryUsage();
+    if (snapshot->read<bool>())
+        this->overflow.reset(new HINT_M_Dynamic(snapshot));
+}
+
+
+// Writes the index, followed by its overflow if any
+void HINT_M_Dynamic::save(SnapshotWriter &writer) const
+{
+    writer.write(this->leafPartitionExtent);
+    writer.write(this->gstart);
+    writer.write(this->gend);
+    writer.write(this->isAnchored);
+    writer.write(this->idBase);
+    writer.write(this->numBits);
+    writer.write(this->maxBits);
+    writer.write(this->height);
+    writer.write(this->numIndexedRecords);
+    writer.write(this->compressFrozen);
+    writer.write(this->keepsPayloads);
+    writer.write(this->keepsEndpoints);
+    for (auto l = 0; l < this->height; l++)
+    {
+        saveLevel(writer, this->pOrgsInFrozen[l], this->pOrgsInIds[l], this->pOrgsInPayloads[l], NULL, &this->pOrgsInTimestamps[l], &this->pOrgsInSorted[l], this->pOrgsInDirectory[l]);
+        saveLevel(writer, this->pOrgsAftFrozen[l], this->pOrgsAftIds[l], this->pOrgsAftPayloads[l], &this->pOrgsAftEndpoints[l], &this->pOrgsAftStarts[l], &this->pOrgsAftSorted[l], this->pOrgsAftDirectory[l]);
+        saveLevel(writer, this->pRepsInFrozen[l], this->pRepsInIds[l], this->pRepsInPayloads[l], &this->pRepsInEndpoints[l], &this->pRepsInEnds[l], &this->pRepsInSorted[l], this->pRepsInDirectory[l]);
+        saveLevel<LocalTimestamp>(writer, this->pRepsAftFrozen[l], this->pRepsAftIds[l], this->pRepsAftPayloads[l], &this->pRepsAftEndpoints[l], NULL, NULL, this->pRepsAftDirectory[l]);
+    }
+    writer.write(bool(this->overflow));
+    if (this->overflow)
+        this->overflow->save(writer);
+}
+
+
+// Fills the empty index with R, using numThreads threads.
+// Every chunk of R counts its entries per partition; prefix sums over the chunks then give each chunk its exact offsets
+// inside every partition, so the partitions are allocated once and the chunks scatter their entries without synchronization.
+// Partitions keep the order of R, as if R was inserted one record at a time, and the large ones are sorted in the end.
+// The records the index cannot store go to its overflow, bulk-loaded the same way.
+void HINT_M_Dynamic::bulkLoad(const Relation &R, unsigned int numThreads)
+{
+    this->idBase = (R.empty())? 0: R[0].id;
+    if (!all_of(R.begin(), R.end(), [&](const Record &r) { return this->canStore(r); }))
+    {
+        Relation stored, rest;
+        
+        for (const Record &r : R)
+            ((this->canStore(r))? stored: rest).push_back(r);
+        this->overflow.reset(new HINT_M_Dynamic(this->leafPartitionExtent, rest, numThreads, this->keepsEndpoints));
+        this->bulkLoad(stored, numThreads);
+        
+        return;
+    }
+    
+    unique_ptr<ThreadPool> pool((numThreads > 1)? new ThreadPool(numThreads): NULL);
+    auto runTasks = [&](size_t numTasks, const function<void(size_t)> &task) {
+        if (pool)
+            pool->run(numTasks, task);
+        else
+        {
+            for (size_t t = 0; t < numTasks; t++)
+                task(t);
+        }
+    };
+    size_t numChunks = max(numThreads, 1u);
+    size_t chunkSize = (R.size()+numChunks-1)/numChunks;
+    
+    // Partitions of all levels and subdivisions laid out flat, up to the last one that R reaches on each level
+    Timestamp end = 0;
+    vector<size_t> levelOffsets(this->height+1, 0);
+    
+    for (const Record &r : R)
+        end = max(end, r.end);
+    for (auto l = 0; l < this->height; l++)
+    {
+        auto shift = this->maxBits-this->numBits+l;
+        
+        levelOffsets[l+1] = levelOffsets[l]+((shift < sizeof(Timestamp)*8-1)? (this->getOffset(end) >> shift)+1: 1);
+    }
+    
+    size_t numLevelPartitions = levelOffsets[this->height];
+    auto getSlot = [&](Subdivision subdivision, int level, PartitionId pid) {
+        return subdivision*numLevelPartitions+levelOffsets[level]+pid;
+    };
+    
+    this->resizeLevels();
+    this->numIndexedRecords = R.size();
+    
+    
+    // Step 1: one pass per chunk to count the contents inside each partition.
+    vector<vector<size_t> > chunkOffsets(numChunks);
+    
+    runTasks(numChunks, [&](size_t c) {
+        vector<size_t> &counts = chunkOffsets[c];
+        
+        counts.assign(NUM_SUBDIVISIONS*numLevelPartitions, 0);
+        for (size_t i = c*chunkSize; i < min(R.size(), (c+1)*chunkSize); i++)
+        {
+            this->assignPartitions(R[i], [&](Subdivision subdivision, int level, PartitionId pid) {
+                counts[getSlot(subdivision, level, pid)]++;
+            });
+        }
+    });
+    
+    // Step 2: prefix sums over the chunks; the counts turn into the offsets of each chunk, the last sums are the partition sizes.
+    vector<size_t> sizes(NUM_SUBDIVISIONS*numLevelPartitions);
+    size_t numRanges = numChunks*4;
+    size_t rangeSize = (sizes.size()+numRanges-1)/numRanges;
+    
+    runTasks(numRanges, [&](size_t k) {
+        for (size_t slot = k*rangeSize; slot < min(sizes.size(), (k+1)*rangeSize); slot++)
+        {
+            size_t sum = 0;
+            
+            for (size_t c = 0; c < numChunks; c++)
+            {
+                size_t count = chunkOffsets[c][slot];
+                
+                chunkOffsets[c][slot] = sum;
+                sum += count;
+            }
+            sizes[slot] = sum;
+        }
+    });
+    
+    // Step 3: allocate the non-empty partitions at their final size, one level of a subdivision per task.
+    vector<vector<pair<int, PartitionId> > > largePartitions(NUM_SUBDIVISIONS*this->height);
+    
+    runTasks(NUM_SUBDIVISIONS*this->height, [&](size_t task) {
+        Subdivision subdivision = Subdivision(task%NUM_SUBDIVISIONS);
+        int level = task/NUM_SUBDIVISIONS;
+        PartitionId cnt = levelOffsets[level+1]-levelOffsets[level];
+        
+        for (PartitionId pid = 0; pid < cnt; pid++)
+        {
+            size_t size = sizes[getSlot(subdivision, level, pid)];
+            
+            if (size == 0)
+                continue;
+            
+            switch (subdivision) {
+                case ORGS_IN:
+                    this->touchPartition(this->pOrgsInIds, this->pOrgsInDirectory, level, pid).resize(size);
+                    this->pOrgsInTimestamps[level].touch(pid).resize(size);
+                    if (size >= SCAN_SORTED_MIN_SIZE)
+                        this->pOrgsInSorted[level].touch(pid);
+                    break;
+                case ORGS_AFT:
+                    this->touchPartition(this->pOrgsAftIds, this->pOrgsAftDirectory, level, pid).resize(size);
+                    this->pOrgsAftStarts[level].touch(pid).resize(size);
+                    if (this->keepsEndpoints)
+                        this->pOrgsAftEndpoints[level].touch(pid).ends.resize(size);
+                    if (size >= SCAN_SORTED_MIN_SIZE)
+                        this->pOrgsAftSorted[level].touch(pid);
+                    break;
+                case REPS_IN:
+                    this->touchPartition(this->pRepsInIds, this->pRepsInDirectory, level, pid).resize(size);
+                    this->pRepsInEnds[level].touch(pid).resize(size);
+                    if (this->keepsEndpoints)
+                        this->pRepsInEndpoints[level].touch(pid).starts.resize(size);
+                    if (size >= SCAN_SORTED_MIN_SIZE)
+                        this->pRepsInSorted[level].touch(pid);
+                    break;
+                default:
+                    this->touchPartition(this->pRepsAftIds, this->pRepsAftDirectory, level, pid).resize(size);
+                    if (this->keepsEndpoints)
                     {
-                        if (iter->first <= Q.end)
+                        this->pRepsAftEndpoints[level].touch(pid).starts.resize(size);
+                        this->pRepsAftEndpoints[level].touch(pid).ends.resize(size);
+                    }
+                    break;
+            }
+            if ((subdivision != REPS_AFT) && (size >= SCAN_SORTED_MIN_SIZE))
+                largePartitions[task].emplace_back(level, pid);
+        }
+    });
+    
+    // Step 4: fill partitions, every chunk writes to its own offsets; all partitions are allocated, so touch() only looks them up.
+    runTasks(numChunks, [&](size_t c) {
+        vector<size_t> &offsets = chunkOffsets[c];
+        
+        for (size_t i = c*chunkSize; i < min(R.size(), (c+1)*chunkSize); i++)
+        {
+            const Record &r = R[i];
+            LocalRecordId id = LocalRecordId(r.id-this->idBase);
+            
+            this->assignPartitions(r, [&](Subdivision subdivision, int level, PartitionId pid) {
+                size_t pos = offsets[getSlot(subdivision, level, pid)]++;
+                Timestamp partitionStart = this->getPartitionStart(level, pid);
+                
+                switch (subdivision) {
+                    case ORGS_IN:
+                        this->pOrgsInIds[level].touch(pid)[pos] = id;
+                        this->pOrgsInTimestamps[level].touch(pid)[pos] = make_pair(LocalTimestamp(r.start-partitionStart), LocalTimestamp(r.end-partitionStart));
+                        break;
+                    case ORGS_AFT:
+                        this->pOrgsAftIds[level].touch(pid)[pos] = id;
+                        this->pOrgsAftStarts[level].touch(pid)[pos] = LocalTimestamp(r.start-partitionStart);
+                        if (this->keepsEndpoints)
+                            this->pOrgsAftEndpoints[level].touch(pid).ends[pos] = r.end-partitionStart;
+                        break;
+                    case REPS_IN:
+                        this->pRepsInIds[level].touch(pid)[pos] = id;
+                        this->pRepsInEnds[level].touch(pid)[pos] = LocalTimestamp(r.end-partitionStart);
+                        if (this->keepsEndpoints)
+                            this->pRepsInEndpoints[level].touch(pid).starts[pos] = r.start-partitionStart;
+                        break;
+                    default:
+                        this->pRepsAftIds[level].touch(pid)[pos] = id;
+                        if (this->keepsEndpoints)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            this->pRepsAftEndpoints[level].touch(pid).starts[pos] = r.start-partitionStart;
+                            this->pRepsAftEndpoints[level].touch(pid).ends[pos] = r.end-partitionStart;
                         }
-                        iterI++;
-                    }
+                        break;
+                }
+            });
+        }
+    });
+    chunkOffsets.clear();
+    
+    // Step 5: sort partitions, one partition per task.
+    vector<pair<size_t, pair<int, PartitionId> > > toSort;
+    
+    for (size_t task = 0; task < largePartitions.size(); task++)
+    {
+        for (const auto &partition : largePartitions[task])
+            toSort.emplace_back(task%NUM_SUBDIVISIONS, partition);
+    }
+    runTasks(toSort.size(), [&](size_t k) {
+        int level = toSort[k].second.first;
+        PartitionId pid = toSort[k].second.second;
+        
+        switch (toSort[k].first) {
+            case ORGS_IN:
+                this->mergeTail(this->pOrgsInIds, this->pOrgsInTimestamps, this->pOrgsInPayloads, NULL, this->pOrgsInSorted, level, pid, true);
+                break;
+            case ORGS_AFT:
+                this->mergeTail(this->pOrgsAftIds, this->pOrgsAftStarts, this->pOrgsAftPayloads, &this->pOrgsAftEndpoints, this->pOrgsAftSorted, level, pid, true);
+                break;
+            default:
+                this->mergeTail(this->pRepsInIds, this->pRepsInEnds, this->pRepsInPayloads, &this->pRepsInEndpoints, this->pRepsInSorted, level, pid, true);
+                break;
+        }
+    });
+    
+    // Step 6: XOR and zone map of each partition, one level of a subdivision per task.
+    runTasks(NUM_SUBDIVISIONS*this->height, [&](size_t task) {
+        int level = task/NUM_SUBDIVISIONS;
+        vector<PartitionBlocks<LocalRelationId> > *pIds[] = {&this->pOrgsInIds, &this->pOrgsAftIds, &this->pRepsInIds, &this->pRepsAftIds};
+        vector<PartitionBlocks<RecordId> > *pXors[] = {&this->pOrgsInXors, &this->pOrgsAftXors, &this->pRepsInXors, &this->pRepsAftXors};
+        vector<PartitionDirectory> *pDirectory[] = {&this->pOrgsInDirectory, &this->pOrgsAftDirectory, &this->pRepsInDirectory, &this->pRepsAftDirectory};
+        
+        for (PartitionId pid : (*pDirectory[task%NUM_SUBDIVISIONS])[level].pids)
+        {
+            RecordId &idsXor = (*pXors[task%NUM_SUBDIVISIONS])[level].touch(pid);
+            
+            for (LocalRecordId id : (*pIds[task%NUM_SUBDIVISIONS])[level][pid])
+                idsXor ^= this->idBase+id;
+            switch (task%NUM_SUBDIVISIONS) {
+                case ORGS_IN:
+                    updateZone(this->pOrgsInTimestamps[level], this->pOrgsInZones[level], pid);
+                    break;
+                case ORGS_AFT:
+                    updateZone(this->pOrgsAftStarts[level], this->pOrgsAftZones[level], pid);
+                    break;
+                case REPS_IN:
+                    updateZone(this->pRepsInEnds[level], this->pRepsInZones[level], pid);
+                    break;
+                default:
+                    break;
+            }
+        }
+    });
+    this->updateAggregates();
+    
+    this->memoryUsage = this->computeMemoryUsage();
+}
+
+
+// Rebuilds the index with numThreads threads, and sweeps the entries of the queries that scan at least MIN_PARALLEL_ENTRIES of them,
+// those of the policies without aggregates and of the payloads; numThreads <= 1 turns parallelism off.
+void HINT_M_Dynamic::setQueryThreads(unsigned int numThreads)
+{
+    this->shareQueryPool((numThreads > 1)? make_shared<ThreadPool>(numThreads): shared_ptr<ThreadPool>());
+}
+
+
+// Sets the pool of the index and of its overflows.
+void HINT_M_Dynamic::shareQueryPool(const shared_ptr<ThreadPool> &pool)
+{
+    for (HINT_M_Dynamic *index = this; index; index = index->overflow.get())
+        index->queryPool = pool;
+}
+
+
+// Bit-packs the compacted layouts, those of the partitions compacted so far and from now on, or unpacks them.
+// Queries then read the range of timestamps of each block first, only the blocks they cannot take or skip as a whole are unpacked.
+void HINT_M_Dynamic::setCompression(bool compress)
+{
+    this->compressFrozen = compress;
+    for (auto l = 0; l < this->height; l++)
+    {
+        this->memoryUsage -= this->pOrgsInFrozen[l].getMemoryUsage() + this->pOrgsAftFrozen[l].getMemoryUsage() + this->pRepsInFrozen[l].getMemoryUsage() + this->pRepsAftFrozen[l].getMemoryUsage();
+        this->pOrgsInFrozen[l].setCompressed(compress);
+        this->pOrgsAftFrozen[l].setCompressed(compress);
+        this->pRepsInFrozen[l].setCompressed(compress);
+        this->pRepsAftFrozen[l].setCompressed(compress);
+        this->memoryUsage += this->pOrgsInFrozen[l].getMemoryUsage() + this->pOrgsAftFrozen[l].getMemoryUsage() + this->pRepsInFrozen[l].getMemoryUsage() + this->pRepsAftFrozen[l].getMemoryUsage();
+    }
+    if (this->overflow)
+        this->overflow->setCompression(compress);
+}
+
+
+void HINT_M_Dynamic::enablePayloads()
+{
+    if (this->numIndexedRecords > 0)
+        throw logic_error("Payloads must be enabled on an empty index");
+    
+    this->keepsPayloads = true;
+}
+
+
+// The cursors report the intervals of the results, which the subdivisions keep only in part
+void HINT_M_Dynamic::enableEndpoints()
+{
+    if (this->numIndexedRecords > 0)
+        throw logic_error("Endpoints must be enabled on an empty index");
+    
+    this->keepsEndpoints = true;
+}
+
+
+void HINT_M_Dynamic::getStats()
+{
+    const LocalRecordId *ids;
+    size_t sizeOrgsIn, sizeOrgsAft, sizeRepsIn, sizeRepsAft;
+
+
+    this->numPartitions = this->numEmptyPartitions = 0;
+    for (auto l = 0; l < this->height; l++)
+    {
+        auto cnt = pow(2, this->numBits-l);
+        
+        this->numPartitions += cnt;
+        for (int pid = 0; pid < cnt; pid++)
+        {
+            this->getPartition(this->pOrgsInIds, this->pOrgsInFrozen, l, pid, ids, sizeOrgsIn);
+            this->getPartition(this->pOrgsAftIds, this->pOrgsAftFrozen, l, pid, ids, sizeOrgsAft);
+            this->getPartition(this->pRepsInIds, this->pRepsInFrozen, l, pid, ids, sizeRepsIn);
+            this->getPartition(this->pRepsAftIds, this->pRepsAftFrozen, l, pid, ids, sizeRepsAft);
+            this->numOriginalsIn  += sizeOrgsIn;
+            this->numOriginalsAft += sizeOrgsAft;
+            this->numReplicasIn   += sizeRepsIn;
+            this->numReplicasAft  += sizeRepsAft;
+            if ((sizeOrgsIn == 0) && (sizeOrgsAft == 0) && (sizeRepsIn == 0) && (sizeRepsAft == 0))
+                this->numEmptyPartitions++;
+        }
+    }
+    
+    this->avgPartitionSize = (float)(this->numIndexedRecords+this->numReplicasIn+this->numReplicasAft)/(this->numPartitions-numEmptyPartitions);
+}
+
+
+// Calls visit(ids, timestamps, size) on the contents of partition pid of one level, in pieces if it is packed;
+// pTimestamps is null for a subdivision that keeps ids only.
+template <class T, class Visit>
+static void visitPartition(const PartitionBlocks<LocalRelationId> &pIds, const PartitionBlocks<vector<T> > *pTimestamps, const FrozenPartitions<T> &frozen, PartitionId pid, Visit visit)
+{
+    if (pid < (PartitionId)frozen.getNumPartitions())
+    {
+        size_t next_from = 0, offset, size;
+        
+        frozen.getBounds(pid, next_from, offset, size);
+        frozen.visit(offset, size, visit);
+    }
+    else
+        visit(pIds[pid].data(), (pTimestamps)? (*pTimestamps)[pid].data(): NULL, pIds[pid].size());
+}
+
+
+void HINT_M_Dynamic::print(char c)
+{
+    const LocalRecordId *ids;
+    size_t size;
+
+
+    for (auto l = 0; l < this->height; l++)
+    {
+        auto cnt = pow(2, this->numBits-l);
+        
+        cout << "Level " << l << " contaning " << cnt << " partition(s)" << endl;
+        for (auto p = 0; p < cnt; p++)
+        {
+            Timestamp partitionStart = this->getPartitionStart(l, p);
+            
+            cout << "\tPartition " << p << endl;
+            this->getPartition(this->pOrgsInIds, this->pOrgsInFrozen, l, p, ids, size);
+            cout << "\t\tOrgsIn[" << p << "] (" << size << "):";
+            visitPartition(this->pOrgsInIds[l], &this->pOrgsInTimestamps[l], this->pOrgsInFrozen[l], p, [&](const LocalRecordId *ids, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size) {
+                for (auto i = 0; i < size; i++)
+                {
+                    cout << " " << c << this->idBase+ids[i] << "[" << partitionStart+timestamps[i].first << ".." << partitionStart+timestamps[i].second << "]";
+                }
+            });
+            cout << endl;
+            this->getPartition(this->pOrgsAftIds, this->pOrgsAftFrozen, l, p, ids, size);
+            cout << "\t\tOrgsAft[" << p << "] (" << size << "):";
+            visitPartition(this->pOrgsAftIds[l], &this->pOrgsAftStarts[l], this->pOrgsAftFrozen[l], p, [&](const LocalRecordId *ids, const LocalTimestamp *endpoints, size_t size) {
+                for (auto i = 0; i < size; i++)
+                {
+                    cout << " " << c << this->idBase+ids[i] << "[" << partitionStart+endpoints[i] << "..]";
+                }
+            });
+            cout << endl;
+            this->getPartition(this->pRepsInIds, this->pRepsInFrozen, l, p, ids, size);
+            cout << "\t\tRepsIn[" << p << "] (" << size << "):";
+            visitPartition(this->pRepsInIds[l], &this->pRepsInEnds[l], this->pRepsInFrozen[l], p, [&](const LocalRecordId *ids, const LocalTimestamp *endpoints, size_t size) {
+                for (auto i = 0; i < size; i++)
+                {
+                    cout << " " << c << this->idBase+ids[i] << "[.." << partitionStart+endpoints[i] << "]";
+                }
+            });
+            cout << endl;
+            this->getPartition(this->pRepsAftIds, this->pRepsAftFrozen, l, p, ids, size);
+            cout << "\t\tRepsAft[" << p << "] (" << size << "):";
+            visitPartition<LocalTimestamp>(this->pRepsAftIds[l], NULL, this->pRepsAftFrozen[l], p, [&](const LocalRecordId *ids, const LocalTimestamp *, size_t size) {
+                for (auto i = 0; i < size; i++)
+                {
+                    cout << " " << c << this->idBase+ids[i];
+                }
+            });
+            cout << endl;
+        }
+    }
+}
+
+
+// Querying
+// Scans of the entries [offset, offset+size) of a compacted layout that reach into its packed entries, one block at a time.
+// The range of the timestamps of a block decides whether all of its entries are reported, none, or the block is unpacked
+// on the stack for the kernels; a check that every entry of the block passes is left out. Entries past the packed ones are scanned where they lie.
+
+// Whether policy A reports a run through its count and XOR of ids alone, selects the overloads below.
+template <class A>
+using HasAggregates = integral_constant<bool, A::HAS_AGGREGATES>;
+
+
+// Reports entries [first, last) of packed block b; counting needs no unpacking at all.
+template <class A, class T>
+static inline void reportPackedBlock(const FrozenPartitions<T> &frozen, RecordId idBase, size_t b, size_t first, size_t last, typename A::Result &result, false_type)
+{
+    LocalRecordId ids[PACKED_BLOCK_SIZE];
+    
+    frozen.packedIds.decode(b, ids);
+    scan_NoChecks<A>(idBase, ids+first, last-first, result);
+}
+
+
+template <class A, class T>
+static inline void reportPackedBlock(const FrozenPartitions<T> &frozen, RecordId idBase, size_t b, size_t first, size_t last, typename A::Result &result, true_type)
+{
+    CountAggregator::addAll(result, idBase, (const LocalRecordId*)NULL, last-first);
+}
+
+
+template <class A, class T>
+static inline void reportPackedBlock(const FrozenPartitions<T> &frozen, RecordId idBase, size_t b, size_t first, size_t last, typename A::Result &result)
+{
+    reportPackedBlock<A>(frozen, idBase, b, first, last, result, is_same<A, CountAggregator>());
+}
+
+
+// The start is the first component of T.
+template <class A, class T>
+static inline void scanPacked_CheckStart(const FrozenPartitions<T> &frozen, RecordId idBase, size_t offset, size_t size, LocalTimestamp qend, typename A::Result &result)
+{
+    LocalRecordId ids[PACKED_BLOCK_SIZE];
+    LocalTimestamp starts[PACKED_BLOCK_SIZE];
+    
+    frozen.visitRange(offset, size, [&](const LocalRecordId *unpackedIds, const T *unpackedTimestamps, size_t n) {
+        scan_CheckStart<A>(idBase, unpackedIds, unpackedTimestamps, n, qend, result);
+    }, [&](size_t b, size_t first, size_t last) {
+        const auto &block = frozen.packedTimestamps[0].getBlock(b);
+        
+        if (block.max <= qend)
+            reportPackedBlock<A>(frozen, idBase, b, first, last, result);
+        else if (block.min <= qend)
+        {
+            frozen.packedIds.decode(b, ids);
+            frozen.packedTimestamps[0].decode(b, starts);
+            scan_CheckStart<A>(idBase, ids+first, starts+first, last-first, qend, result);
+        }
+    });
+}
+
+
+// The end is the last component of T.
+template <class A, class T>
+static inline void scanPacked_CheckEnd(const FrozenPartitions<T> &frozen, RecordId idBase, size_t offset, size_t size, LocalTimestamp qstart, typename A::Result &result)
+{
+    const auto &packedEnds = frozen.packedTimestamps[FrozenPartitions<T>::NUM_COMPONENTS-1];
+    LocalRecordId ids[PACKED_BLOCK_SIZE];
+    LocalTimestamp ends[PACKED_BLOCK_SIZE];
+    
+    frozen.visitRange(offset, size, [&](const LocalRecordId *unpackedIds, const T *unpackedTimestamps, size_t n) {
+        scan_CheckEnd<A>(idBase, unpackedIds, unpackedTimestamps, n, qstart, result);
+    }, [&](size_t b, size_t first, size_t last) {
+        const auto &block = packedEnds.getBlock(b);
+        
+        if (qstart <= block.min)
+            reportPackedBlock<A>(frozen, idBase, b, first, last, result);
+        else if (qstart <= block.max)
+        {
+            frozen.packedIds.decode(b, ids);
+            packedEnds.decode(b, ends);
+            scan_CheckEnd<A>(idBase, ids+first, ends+first, last-first, qstart, result);
+        }
+    });
+}
+
+
+template <class A>
+static inline void scanPacked_CheckBoth(const FrozenPartitions<pair<LocalTimestamp, LocalTimestamp> > &frozen, RecordId idBase, size_t offset, size_t size, LocalTimestamp qstart, LocalTimestamp qend, typename A::Result &result)
+{
+    LocalRecordId ids[PACKED_BLOCK_SIZE];
+    LocalTimestamp starts[PACKED_BLOCK_SIZE], ends[PACKED_BLOCK_SIZE];
+    pair<LocalTimestamp, LocalTimestamp> timestamps[PACKED_BLOCK_SIZE];
+    
+    frozen.visitRange(offset, size, [&](const LocalRecordId *unpackedIds, const pair<LocalTimestamp, LocalTimestamp> *unpackedTimestamps, size_t n) {
+        scan_CheckBoth<A>(idBase, unpackedIds, unpackedTimestamps, n, qstart, qend, result);
+    }, [&](size_t b, size_t first, size_t last) {
+        const auto &startBlock = frozen.packedTimestamps[0].getBlock(b);
+        const auto &endBlock = frozen.packedTimestamps[1].getBlock(b);
+        bool allStart = (startBlock.max <= qend), allEnd = (qstart <= endBlock.min);
+        
+        if ((startBlock.min > qend) || (qstart > endBlock.max))
+            return;
+        if ((allStart) && (allEnd))
+        {
+            reportPackedBlock<A>(frozen, idBase, b, first, last, result);
+            return;
+        }
+        
+        frozen.packedIds.decode(b, ids);
+        if (allStart)
+        {
+            frozen.packedTimestamps[1].decode(b, ends);
+            scan_CheckEnd<A>(idBase, ids+first, ends+first, last-first, qstart, result);
+        }
+        else if (allEnd)
+        {
+            frozen.packedTimestamps[0].decode(b, starts);
+            scan_CheckStart<A>(idBase, ids+first, starts+first, last-first, qend, result);
+        }
+        else
+        {
+            frozen.packedTimestamps[0].decode(b, starts);
+            frozen.packedTimestamps[1].decode(b, ends);
+            for (size_t i = first; i < last; i++)
+                timestamps[i] = make_pair(starts[i], ends[i]);
+            scan_CheckBoth<A>(idBase, ids+first, timestamps+first, last-first, qstart, qend, result);
+        }
+    });
+}
+
+
+// Locates partition pid of a subdivision, either in the compacted layout or in the blocks.
+// The contents are null for a compacted partition that reaches into the packed entries, see FrozenPartitions::visit().
+template <class T>
+inline void HINT_M_Dynamic::getPartition(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, const LocalRecordId* &ids, size_t &size)
+{
+    const FrozenPartitions<T> &frozen = pFrozen[level];
+    
+    if (pid < (PartitionId)frozen.getNumPartitions())
+    {
+        size_t next_from = 0, offset;
+        
+        frozen.getBounds(pid, next_from, offset, size);
+        ids  = (frozen.isUnpacked(offset, size))? frozen.getIds(offset): NULL;
+    }
+    else
+    {
+        const LocalRelationId &pIdsP = pIds[level][pid];
+        
+        ids  = pIdsP.data();
+        size = pIdsP.size();
+    }
+}
+
+
+template <class T>
+inline void HINT_M_Dynamic::getPartition(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<vector<T> > > &pTimestamps, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, const LocalRecordId* &ids, const T* &timestamps, size_t &size)
+{
+    const FrozenPartitions<T> &frozen = pFrozen[level];
+    
+    if (pid < (PartitionId)frozen.getNumPartitions())
+    {
+        size_t next_from = 0, offset;
+        
+        frozen.getBounds(pid, next_from, offset, size);
+        ids        = (frozen.isUnpacked(offset, size))? frozen.getIds(offset): NULL;
+        timestamps = (frozen.isUnpacked(offset, size))? frozen.getTimestamps(offset): NULL;
+    }
+    else
+    {
+        const LocalRelationId &pIdsP = pIds[level][pid];
+        
+        ids        = pIdsP.data();
+        timestamps = pTimestamps[level][pid].data();
+        size       = pIdsP.size();
+    }
+}
+
+
+// Same, also returning the length of the sorted body; compacted partitions are sorted as a whole.
+// A body shorter than SCAN_SORTED_MIN_SIZE is reported as 0, a single comparing scan beats the binary search there.
+template <class T>
+inline void HINT_M_Dynamic::getPartition(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<vector<T> > > &pTimestamps, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, const LocalRecordId* &ids, const T* &timestamps, size_t &size, size_t &sortedSize)
+{
+    this->getPartition(pIds, pTimestamps, pFrozen, level, pid, ids, timestamps, size);
+    sortedSize = 0;
+    if (size >= SCAN_SORTED_MIN_SIZE)
+    {
+        sortedSize = (pid < (PartitionId)pFrozen[level].getNumPartitions())? size: pSorted[level][pid];
+        if (sortedSize < SCAN_SORTED_MIN_SIZE)
+            sortedSize = 0;
+    }
+}
+
+
+// Reports partitions [from, to) of a compacted layout, which need no comparisons: through their count and XOR of ids
+// if the policy takes aggregates, otherwise by visiting the ids.
+template <class A, class T>
+static inline void reportFrozen(const FrozenPartitions<T> &frozen, RecordId idBase, PartitionId from, PartitionId to, typename A::Result &result, true_type)
+{
+    size_t count;
+    RecordId idsXor;
+    
+    frozen.aggregate(from, to, count, idsXor);
+    A::addAggregate(result, count, idsXor);
+}
+
+
+// Reports entries [offset, offset+size) of a compacted layout, with no comparisons.
+template <class A, class T>
+static inline void reportFrozenEntries(const FrozenPartitions<T> &frozen, RecordId idBase, size_t offset, size_t size, typename A::Result &result)
+{
+    frozen.visitRange(offset, size, [&](const LocalRecordId *ids, const T *, size_t n) {
+        scan_NoChecks<A>(idBase, ids, n, result);
+    }, [&](size_t b, size_t first, size_t last) {
+        reportPackedBlock<A>(frozen, idBase, b, first, last, result);
+    });
+}
+
+
+template <class A, class T>
+static inline void reportFrozen(const FrozenPartitions<T> &frozen, RecordId idBase, PartitionId from, PartitionId to, typename A::Result &result, false_type)
+{
+    size_t offset = frozen.getOffset(from);
+    
+    reportFrozenEntries<A>(frozen, idBase, offset, frozen.getOffset(to)-offset, result);
+}
+
+
+// Same for a partition in the blocks, whose XOR of ids is idsXor.
+template <class A>
+static inline void reportIds(RecordId idBase, const LocalRelationId &ids, RecordId idsXor, typename A::Result &result, true_type)
+{
+    A::addAggregate(result, ids.size(), idsXor);
+}
+
+
+template <class A>
+static inline void reportIds(RecordId idBase, const LocalRelationId &ids, RecordId idsXor, typename A::Result &result, false_type)
+{
+    scan_NoChecks<A>(idBase, ids.data(), ids.size(), result);
+}
+
+
+// Reports every entry of partition pid, through its aggregates if the policy takes them.
+template <class A, class T>
+inline void HINT_M_Dynamic::reportPartition(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, typename A::Result &result)
+{
+    const FrozenPartitions<T> &frozen = pFrozen[level];
+    
+    if (pid < (PartitionId)frozen.getNumPartitions())
+        reportFrozen<A>(frozen, this->idBase, pid, pid+1, result, HasAggregates<A>());
+    else
+        reportIds<A>(this->idBase, pIds[level][pid], pXors[level][pid], result, HasAggregates<A>());
+}
+
+
+// Reports every entry of partitions [from, to]: the compacted ones as a single run,
+// the rest through the directory of non-empty partitions.
+template <class A, class T>
+inline void HINT_M_Dynamic::scanPartitions_NoChecks(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionDirectory> &pDirectory, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId from, PartitionId to, typename A::Result &result)
+{
+    const FrozenPartitions<T> &frozen = pFrozen[level];
+    PartitionId numFrozen = frozen.getNumPartitions();
+    
+    if (from == to)
+        this->reportPartition<A>(pIds, pXors, pFrozen, level, from, result);
+    else if (from < to)
+    {
+        const PartitionDirectory &directory = pDirectory[level];
+        
+        if (from < numFrozen)
+        {
+            PartitionId last = min(to+1, numFrozen);
+            
+            reportFrozen<A>(frozen, this->idBase, from, last, result, HasAggregates<A>());
+            from = last;
+        }
+        for (size_t k = directory.find(from); (k < directory.pids.size()) && (directory.pids[k] <= to); k++)
+            reportIds<A>(this->idBase, pIds[level][directory.pids[k]], pXors[level][directory.pids[k]], result, HasAggregates<A>());
+    }
+}
+
+
+// Reports the sorted body [0, sortedSize) of partition pid of OrgsIn through its aggregates, if it keeps them and they are up to date;
+// the starts of the body are compared against qend, its ends against qstart, pass the lowest or the highest timestamp to skip either check.
+template <class A>
+static inline bool reportSortedBody(const vector<PartitionBlocks<OverlapAggregates> > *pAggregates, unsigned int level, PartitionId pid, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t sortedSize, LocalTimestamp qstart, LocalTimestamp qend, typename A::Result &result, true_type)
+{
+    size_t count;
+    RecordId idsXor;
+    
+    if ((!pAggregates) || (sortedSize == 0) || ((*pAggregates)[level][pid].size() != sortedSize))
+        return false;
+    
+    (*pAggregates)[level][pid].aggregate(timestamps, qstart, qend, count, idsXor);
+    A::addAggregate(result, count, idsXor);
+    
+    return true;
+}
+
+
+// Policies without aggregates scan the body.
+template <class A>
+static inline bool reportSortedBody(const vector<PartitionBlocks<OverlapAggregates> > *, unsigned int, PartitionId, const pair<LocalTimestamp, LocalTimestamp> *, size_t, LocalTimestamp, LocalTimestamp, typename A::Result &, false_type)
+{
+    return false;
+}
+
+
+// Subdivisions keeping a single endpoint have no aggregates.
+template <class A, class HasAggregates>
+static inline bool reportSortedBody(const vector<PartitionBlocks<OverlapAggregates> > *, unsigned int, PartitionId, const LocalTimestamp *, size_t, LocalTimestamp, LocalTimestamp, typename A::Result &, HasAggregates)
+{
+    return false;
+}
+
+
+// Zone map of partition pid, either of the compacted layout or of the blocks.
+template <class T>
+static inline ZoneMap<T> getZone(const vector<PartitionBlocks<ZoneMap<T> > > &pZones, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid)
+{
+    return (pid < (PartitionId)pFrozen[level].getNumPartitions())? pFrozen[level].getZone(pid): pZones[level][pid];
+}
+
+
+// Reports the (k+1)-th non-empty partition of a compacted layout, entries [offset, offset+size), with no comparisons.
+template <class A, class T>
+static inline void reportFrozenPartition(const FrozenPartitions<T> &frozen, RecordId idBase, size_t k, size_t offset, size_t size, typename A::Result &result, true_type)
+{
+    A::addAggregate(result, size, frozen.xors[k]^frozen.xors[k+1]);
+}
+
+
+template <class A, class T>
+static inline void reportFrozenPartition(const FrozenPartitions<T> &frozen, RecordId idBase, size_t k, size_t offset, size_t size, typename A::Result &result, false_type)
+{
+    reportFrozenEntries<A>(frozen, idBase, offset, size, result);
+}
+
+
+// Scans partition pid of a compacted layout: a single getBounds() locates its entries and its zone map,
+// which skips it or reports it whole; otherwise it is sorted as a whole and cut with a binary search, unless packed or short.
+template <class A, class T>
+static inline void scanFrozen_CheckStart(const FrozenPartitions<T> &frozen, RecordId idBase, PartitionId pid, LocalTimestamp qend, typename A::Result &result)
+{
+    size_t next_from = 0, offset, size;
+    
+    if (!frozen.getBounds(pid, next_from, offset, size))
+        return;
+    
+    const ZoneMap<T> &zone = frozen.zones[next_from-1];
+    
+    if (zone.getMin(0) > qend)
+        return;
+    if (zone.getMax(0) <= qend)
+        reportFrozenPartition<A>(frozen, idBase, next_from-1, offset, size, result, HasAggregates<A>());
+    else if (!frozen.isUnpacked(offset, size))
+        scanPacked_CheckStart<A>(frozen, idBase, offset, size, qend, result);
+    else if (size >= SCAN_SORTED_MIN_SIZE)
+        scanSorted_CheckStart<A>(idBase, frozen.getIds(offset), frozen.getTimestamps(offset), size, qend, result);
+    else
+        scan_CheckStart<A>(idBase, frozen.getIds(offset), frozen.getTimestamps(offset), size, qend, result);
+}
+
+
+template <class A, class T>
+static inline void scanFrozen_CheckEnd(const FrozenPartitions<T> &frozen, RecordId idBase, PartitionId pid, LocalTimestamp qstart, typename A::Result &result)
+{
+    size_t next_from = 0, offset, size;
+    
+    if (!frozen.getBounds(pid, next_from, offset, size))
+        return;
+    
+    const ZoneMap<T> &zone = frozen.zones[next_from-1];
+    
+    if (zone.getMax(ZoneMap<T>::NUM_COMPONENTS-1) < qstart)
+        return;
+    if (zone.getMin(ZoneMap<T>::NUM_COMPONENTS-1) >= qstart)
+        reportFrozenPartition<A>(frozen, idBase, next_from-1, offset, size, result, HasAggregates<A>());
+    else if (!frozen.isUnpacked(offset, size))
+        scanPacked_CheckEnd<A>(frozen, idBase, offset, size, qstart, result);
+    else if (size >= SCAN_SORTED_MIN_SIZE)
+        scanSorted_CheckEnd<A>(idBase, frozen.getIds(offset), frozen.getTimestamps(offset), size, qstart, result);
+    else
+        scan_CheckEnd<A>(idBase, frozen.getIds(offset), frozen.getTimestamps(offset), size, qstart, result);
+}
+
+
+// A zone map that decides one endpoint alone drops its comparison, as scanPartition_CheckBoth() does.
+template <class A>
+static inline void scanFrozen_CheckBoth(const FrozenPartitions<pair<LocalTimestamp, LocalTimestamp> > &frozen, RecordId idBase, PartitionId pid, LocalTimestamp qstart, LocalTimestamp qend, typename A::Result &result)
+{
+    size_t next_from = 0, offset, size;
+    
+    if (!frozen.getBounds(pid, next_from, offset, size))
+        return;
+    
+    const ZoneMap<pair<LocalTimestamp, LocalTimestamp> > &zone = frozen.zones[next_from-1];
+    bool allStart = (zone.getMax(0) <= qend), allEnd = (zone.getMin(1) >= qstart);
+    
+    if ((zone.getMin(0) > qend) || (zone.getMax(1) < qstart))
+        return;
+    if ((allStart) && (allEnd))
+        reportFrozenPartition<A>(frozen, idBase, next_from-1, offset, size, result, HasAggregates<A>());
+    else if (!frozen.isUnpacked(offset, size))
+    {
+        if (allStart)
+            scanPacked_CheckEnd<A>(frozen, idBase, offset, size, qstart, result);
+        else if (allEnd)
+            scanPacked_CheckStart<A>(frozen, idBase, offset, size, qend, result);
+        else
+            scanPacked_CheckBoth<A>(frozen, idBase, offset, size, qstart, qend, result);
+    }
+    else
+    {
+        const LocalRecordId *ids = frozen.getIds(offset);
+        const pair<LocalTimestamp, LocalTimestamp> *timestamps = frozen.getTimestamps(offset);
+        
+        if (size < SCAN_SORTED_MIN_SIZE)
+        {
+            if (allStart)
+                scan_CheckEnd<A>(idBase, ids, timestamps, size, qstart, result);
+            else if (allEnd)
+                scan_CheckStart<A>(idBase, ids, timestamps, size, qend, result);
+            else
+                scan_CheckBoth<A>(idBase, ids, timestamps, size, qstart, qend, result);
+        }
+        else if (allStart)
+            scanSorted_CheckEnd<A>(idBase, ids, timestamps, size, qstart, result);
+        else if (allEnd)
+            scanSorted_CheckStart<A>(idBase, ids, timestamps, size, qend, result);
+        else
+            scanSorted_CheckBoth<A>(idBase, ids, timestamps, size, qstart, qend, result);
+    }
+}
+
+
+// T is either the (start, end) pair or the start alone. Compacted partitions go to scanFrozen_*(); in the blocks, the zone map skips
+// the partition or reports it through its aggregates if it decides every entry alone; otherwise the sorted body is cut with a binary search
+// and the tail is compared.
+template <class A, class T>
+inline void HINT_M_Dynamic::scanPartition_CheckStart(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<vector<T> > > &pTimestamps, const vector<PartitionBlocks<ZoneMap<T> > > &pZones, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<PartitionBlocks<OverlapAggregates> > *pAggregates, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, LocalTimestamp qend, typename A::Result &result)
+{
+    if (pid < (PartitionId)pFrozen[level].getNumPartitions())
+    {
+        scanFrozen_CheckStart<A>(pFrozen[level], this->idBase, pid, qend, result);
+        return;
+    }
+    
+    const ZoneMap<T> &zone = pZones[level][pid];
+    const LocalRecordId *ids;
+    const T *timestamps;
+    size_t size, sortedSize;
+    
+    if (zone.getMin(0) > qend)
+        return;
+    if (zone.getMax(0) <= qend)
+    {
+        reportIds<A>(this->idBase, pIds[level][pid], pXors[level][pid], result, HasAggregates<A>());
+        return;
+    }
+    
+    this->getPartition(pIds, pTimestamps, pSorted, pFrozen, level, pid, ids, timestamps, size, sortedSize);
+    if ((sortedSize > 0) && (!reportSortedBody<A>(pAggregates, level, pid, timestamps, sortedSize, numeric_limits<LocalTimestamp>::min(), qend, result, HasAggregates<A>())))
+        scanSorted_CheckStart<A>(this->idBase, ids, timestamps, sortedSize, qend, result);
+    scan_CheckStart<A>(this->idBase, ids+sortedSize, timestamps+sortedSize, size-sortedSize, qend, result);
+}
+
+
+// T is either the (start, end) pair or the end alone; same as above.
+template <class A, class T>
+inline void HINT_M_Dynamic::scanPartition_CheckEnd(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<vector<T> > > &pTimestamps, const vector<PartitionBlocks<ZoneMap<T> > > &pZones, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<PartitionBlocks<OverlapAggregates> > *pAggregates, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, LocalTimestamp qstart, typename A::Result &result)
+{
+    if (pid < (PartitionId)pFrozen[level].getNumPartitions())
+    {
+        scanFrozen_CheckEnd<A>(pFrozen[level], this->idBase, pid, qstart, result);
+        return;
+    }
+    
+    const ZoneMap<T> &zone = pZones[level][pid];
+    const LocalRecordId *ids;
+    const T *timestamps;
+    size_t size, sortedSize;
+    
+    if (zone.getMax(ZoneMap<T>::NUM_COMPONENTS-1) < qstart)
+        return;
+    if (zone.getMin(ZoneMap<T>::NUM_COMPONENTS-1) >= qstart)
+    {
+        reportIds<A>(this->idBase, pIds[level][pid], pXors[level][pid], result, HasAggregates<A>());
+        return;
+    }
+    
+    this->getPartition(pIds, pTimestamps, pSorted, pFrozen, level, pid, ids, timestamps, size, sortedSize);
+    if ((sortedSize > 0) && (!reportSortedBody<A>(pAggregates, level, pid, timestamps, sortedSize, qstart, numeric_limits<LocalTimestamp>::max(), result, HasAggregates<A>())))
+        scanSorted_CheckEnd<A>(this->idBase, ids, timestamps, sortedSize, qstart, result);
+    scan_CheckEnd<A>(this->idBase, ids+sortedSize, timestamps+sortedSize, size-sortedSize, qstart, result);
+}
+
+
+// Once the zone map shows that every start or every end passes, only the other one is compared.
+template <class A>
+inline void HINT_M_Dynamic::scanPartition_CheckBoth(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<vector<pair<LocalTimestamp, LocalTimestamp> > > > &pTimestamps, const vector<PartitionBlocks<ZoneMap<pair<LocalTimestamp, LocalTimestamp> > > > &pZones, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<PartitionBlocks<OverlapAggregates> > *pAggregates, const vector<FrozenPartitions<pair<LocalTimestamp, LocalTimestamp> > > &pFrozen, unsigned int level, PartitionId pid, LocalTimestamp qstart, LocalTimestamp qend, typename A::Result &result)
+{
+    if (pid < (PartitionId)pFrozen[level].getNumPartitions())
+    {
+        scanFrozen_CheckBoth<A>(pFrozen[level], this->idBase, pid, qstart, qend, result);
+        return;
+    }
+    
+    const ZoneMap<pair<LocalTimestamp, LocalTimestamp> > &zone = pZones[level][pid];
+    const LocalRecordId *ids;
+    const pair<LocalTimestamp, LocalTimestamp> *timestamps;
+    size_t size, sortedSize;
+    
+    if (zone.getMax(0) <= qend)
+    {
+        this->scanPartition_CheckEnd<A>(pIds, pXors, pTimestamps, pZones, pSorted, pAggregates, pFrozen, level, pid, qstart, result);
+        return;
+    }
+    if (zone.getMin(1) >= qstart)
+    {
+        this->scanPartition_CheckStart<A>(pIds, pXors, pTimestamps, pZones, pSorted, pAggregates, pFrozen, level, pid, qend, result);
+        return;
+    }
+    if ((zone.getMin(0) > qend) || (zone.getMax(1) < qstart))
+        return;
+    
+    this->getPartition(pIds, pTimestamps, pSorted, pFrozen, level, pid, ids, timestamps, size, sortedSize);
+    if (!ids)
+    {
+        scanPacked_CheckBoth<A>(pFrozen[level], this->idBase, pFrozen[level].getOffset(pid), size, qstart, qend, result);
+        return;
+    }
+    if ((sortedSize > 0) && (!reportSortedBody<A>(pAggregates, level, pid, timestamps, sortedSize, qstart, qend, result, HasAggregates<A>())))
+        scanSorted_CheckBoth<A>(this->idBase, ids, timestamps, sortedSize, qstart, qend, result);
+    scan_CheckBoth<A>(this->idBase, ids+sortedSize, timestamps+sortedSize, size-sortedSize, qstart, qend, result);
+}
+
+
+// Visits the partitions that range query Q needs, level by level from the bottom, telling the visitor which comparisons each one takes:
+// visitor.noChecks(), checkStart(), checkEnd() and checkBoth() are called with the arguments of scanPartitions_NoChecks() and
+// scanPartition_CheckStart(), _CheckEnd() and _CheckBoth() respectively, but the result, and with the payloads and the endpoint columns
+// of the subdivision after its XORs, the latter null for OrgsIn; noChecks() also takes its timestamp entries there, null for RepsAft.
+// The endpoints of Q are passed as offsets from the start of the partition, like the timestamps it stores.
+// The top level is visited like the others, as it may hold every kind of entry in several partitions (see assignPartitions()).
+template <class Visitor>
+inline void HINT_M_Dynamic::traverse(RangeQuery Q, Visitor &visitor)
+{
+    // No record ends after gend, so a prefix past that of gend is placed at it; the comparisons use the actual endpoints of Q
+    Timestamp last = this->getOffset(this->gend) >> (this->maxBits-this->numBits);
+    Timestamp a = min(this->getOffset(Q.start) >> (this->maxBits-this->numBits), last); // prefix
+    Timestamp b = min(this->getOffset(Q.end)   >> (this->maxBits-this->numBits), last); // prefix
+    bool foundzero = false;
+    bool foundone = false;
+    
+
+    for (auto l = 0; l < this->height; l++)
+    {
+        if (foundone && foundzero)
+        {
+            // Partition totally covers lowest-level partition range that includes query range
+            // all contents are guaranteed to be results
+            
+            // Handle the partition that contains a: consider both originals and replicas
+            visitor.noChecks(this->pRepsInIds, this->pRepsInXors, this->pRepsInPayloads, &this->pRepsInEndpoints, &this->pRepsInEnds, this->pRepsInDirectory, this->pRepsInFrozen, l, a, a);
+            visitor.template noChecks<LocalTimestamp>(this->pRepsAftIds, this->pRepsAftXors, this->pRepsAftPayloads, &this->pRepsAftEndpoints, NULL, this->pRepsAftDirectory, this->pRepsAftFrozen, l, a, a);
+            
+            // Handle rest: consider only originals
+            visitor.noChecks(this->pOrgsInIds, this->pOrgsInXors, this->pOrgsInPayloads, NULL, &this->pOrgsInTimestamps, this->pOrgsInDirectory, this->pOrgsInFrozen, l, a, b);
+            visitor.noChecks(this->pOrgsAftIds, this->pOrgsAftXors, this->pOrgsAftPayloads, &this->pOrgsAftEndpoints, &this->pOrgsAftStarts, this->pOrgsAftDirectory, this->pOrgsAftFrozen, l, a, b);
+        }
+        else
+        {
+            // Comparisons needed
+            
+            // Handle the partition that contains a: consider both originals and replicas, comparisons needed
+            if (a == b)
+            {
+                // Special case when query overlaps only one partition, Lemma 3
+                if (!foundzero && !foundone)
+                {
+                    visitor.checkBoth(this->pOrgsInIds, this->pOrgsInXors, this->pOrgsInPayloads, NULL, this->pOrgsInTimestamps, this->pOrgsInZones, this->pOrgsInSorted, &this->pOrgsInAggregates, this->pOrgsInFrozen, l, a, this->toLocal(l, a, Q.start), this->toLocal(l, a, Q.end));
+                    visitor.checkStart(this->pOrgsAftIds, this->pOrgsAftXors, this->pOrgsAftPayloads, &this->pOrgsAftEndpoints, this->pOrgsAftStarts, this->pOrgsAftZones, this->pOrgsAftSorted, NULL, this->pOrgsAftFrozen, l, a, this->toLocal(l, a, Q.end));
                 }
                 else if (foundzero)
                 {
-                    iterI = this->pOrgsInIds[l][a].begin();
-                    iterStart = this->pOrgsInTimestamps[l][a].begin();
-                    iterEnd = this->pOrgsInTimestamps[l][a].end();
-                    for (iter = iterStart; iter != iterEnd; iter++)
-                    {
-                        if (iter->first <= Q.end)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                        iterI++;
-                    }
-                    iterI = this->pOrgsAftIds[l][a].begin();
-                    iterStart = this->pOrgsAftTimestamps[l][a].begin();
-                    iterEnd = this->pOrgsAftTimestamps[l][a].end();
-                    for (iter = iterStart; iter != iterEnd; iter++)
-                    {
-                        if (iter->first <= Q.end)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                        iterI++;
-                    }
+                    visitor.checkStart(this->pOrgsInIds, this->pOrgsInXors, this->pOrgsInPayloads, NULL, this->pOrgsInTimestamps, this->pOrgsInZones, this->pOrgsInSorted, &this->pOrgsInAggregates, this->pOrgsInFrozen, l, a, this->toLocal(l, a, Q.end));
+                    visitor.checkStart(this->pOrgsAftIds, this->pOrgsAftXors, this->pOrgsAftPayloads, &this->pOrgsAftEndpoints, this->pOrgsAftStarts, this->pOrgsAftZones, this->pOrgsAftSorted, NULL, this->pOrgsAftFrozen, l, a, this->toLocal(l, a, Q.end));
                 }
                 else if (foundone)
                 {
-                    iterI = this->pOrgsInIds[l][a].begin();
-                    iterStart = this->pOrgsInTimestamps[l][a].begin();
-                    iterEnd = this->pOrgsInTimestamps[l][a].end();
-                    for (iter = iterStart; iter != iterEnd; iter++)
-                    {
-                        if (Q.start <= iter->second)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                        iterI++;
-                    }
-                    iterIStart = this->pOrgsAftIds[l][a].begin();
-                    iterIEnd = this->pOrgsAftIds[l][a].end();
-                    for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-                    {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
-                    }
+                    visitor.checkEnd(this->pOrgsInIds, this->pOrgsInXors, this->pOrgsInPayloads, NULL, this->pOrgsInTimestamps, this->pOrgsInZones, this->pOrgsInSorted, &this->pOrgsInAggregates, this->pOrgsInFrozen, l, a, this->toLocal(l, a, Q.start));
+                    visitor.noChecks(this->pOrgsAftIds, this->pOrgsAftXors, this->pOrgsAftPayloads, &this->pOrgsAftEndpoints, &this->pOrgsAftStarts, this->pOrgsAftDirectory, this->pOrgsAftFrozen, l, a, a);
                 }
             }
             else
             {
                 // Lemma 1
                 if (!foundzero)
-                {
-                    iterI = this->pOrgsInIds[l][a].begin();
-                    iterStart = this->pOrgsInTimestamps[l][a].begin();
-                    iterEnd = this->pOrgsInTimestamps[l][a].end();
-                    for (iter = iterStart; iter != iterEnd; iter++)
-                    {
-                        if (Q.start <= iter->second)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                        iterI++;
-                    }
-                }
+                    visitor.checkEnd(this->pOrgsInIds, this->pOrgsInXors, this->pOrgsInPayloads, NULL, this->pOrgsInTimestamps, this->pOrgsInZones, this->pOrgsInSorted, &this->pOrgsInAggregates, this->pOrgsInFrozen, l, a, this->toLocal(l, a, Q.start));
                 else
+                    visitor.noChecks(this->pOrgsInIds, this->pOrgsInXors, this->pOrgsInPayloads, NULL, &this->pOrgsInTimestamps, this->pOrgsInDirectory, this->pOrgsInFrozen, l, a, a);
+                visitor.noChecks(this->pOrgsAftIds, this->pOrgsAftXors, this->pOrgsAftPayloads, &this->pOrgsAftEndpoints, &this->pOrgsAftStarts, this->pOrgsAftDirectory, this->pOrgsAftFrozen, l, a, a);
+            }
+
+            // Lemma 1, 3
+            if (!foundzero)
+                visitor.checkEnd(this->pRepsInIds, this->pRepsInXors, this->pRepsInPayloads, &this->pRepsInEndpoints, this->pRepsInEnds, this->pRepsInZones, this->pRepsInSorted, NULL, this->pRepsInFrozen, l, a, this->toLocal(l, a, Q.start));
+            else
+                visitor.noChecks(this->pRepsInIds, this->pRepsInXors, this->pRepsInPayloads, &this->pRepsInEndpoints, &this->pRepsInEnds, this->pRepsInDirectory, this->pRepsInFrozen, l, a, a);
+            visitor.template noChecks<LocalTimestamp>(this->pRepsAftIds, this->pRepsAftXors, this->pRepsAftPayloads, &this->pRepsAftEndpoints, NULL, this->pRepsAftDirectory, this->pRepsAftFrozen, l, a, a);
+
+            if (a < b)
+            {
+                if (!foundone)
                 {
-                    iterIStart = this->pOrgsInIds[l][a].begin();
-                    iterIEnd = this->pOrgsInIds[l][a].end();
-                    for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-                    {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
-                    }
+                    // Handle the rest before the partition that contains b: consider only originals, no comparisons needed
+                    visitor.noChecks(this->pOrgsInIds, this->pOrgsInXors, this->pOrgsInPayloads, NULL, &this->pOrgsInTimestamps, this->pOrgsInDirectory, this->pOrgsInFrozen, l, a+1, b-1);
+                    visitor.noChecks(this->pOrgsAftIds, this->pOrgsAftXors, this->pOrgsAftPayloads, &this->pOrgsAftEndpoints, &this->pOrgsAftStarts, this->pOrgsAftDirectory, this->pOrgsAftFrozen, l, a+1, b-1);
+
+                    // Handle the partition that contains b: consider only originals, comparisons needed
+                    visitor.checkStart(this->pOrgsInIds, this->pOrgsInXors, this->pOrgsInPayloads, NULL, this->pOrgsInTimestamps, this->pOrgsInZones, this->pOrgsInSorted, &this->pOrgsInAggregates, this->pOrgsInFrozen, l, b, this->toLocal(l, b, Q.end));
+                    visitor.checkStart(this->pOrgsAftIds, this->pOrgsAftXors, this->pOrgsAftPayloads, &this->pOrgsAftEndpoints, this->pOrgsAftStarts, this->pOrgsAftZones, this->pOrgsAftSorted, NULL, this->pOrgsAftFrozen, l, b, this->toLocal(l, b, Q.end));
                 }
-                iterI = this->pOrgsAftIds[l][a].begin();
-                iterStart = this->pOrgsAftTimestamps[l][a].begin();
-                iterEnd = this->pOrgsAftTimestamps[l][a].end();
-                for (iter = iterStart; iter != iterEnd; iter++)
+                else
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
-                    iterI++;
+                    visitor.noChecks(this->pOrgsInIds, this->pOrgsInXors, this->pOrgsInPayloads, NULL, &this->pOrgsInTimestamps, this->pOrgsInDirectory, this->pOrgsInFrozen, l, a+1, b);
+                    visitor.noChecks(this->pOrgsAftIds, this->pOrgsAftXors, this->pOrgsAftPayloads, &this->pOrgsAftEndpoints, &this->pOrgsAftStarts, this->pOrgsAftDirectory, this->pOrgsAftFrozen, l, a+1, b);
                 }
             }
+            
+            if ((!foundone) && (b%2)) //last bit of b is 1
+                foundone = 1;
+            if ((!foundzero) && (!(a%2))) //last bit of a is 0
+                foundzero = 1;
+        }
+        a >>= 1; // a = a div 2
+        b >>= 1; // b = b div 2
+    }
+}
+
+
+// Stabbing query: the range query with Q.start = Q.end = Q.point, so exactly one partition is visited per level.
+// Below the first level where the point's prefix is even, starts are known to precede the point, and below the first where it is odd,
+// ends are known to follow it; each subdivision compares only the endpoint that can still fail, and none once both are known.
+template <class Visitor>
+inline void HINT_M_Dynamic::traverse(StabbingQuery Q, Visitor &visitor)
+{
+    Timestamp last = this->getOffset(this->gend) >> (this->maxBits-this->numBits);
+    Timestamp a = min(this->getOffset(Q.point) >> (this->maxBits-this->numBits), last); // prefix, placed as above
+    bool foundzero = false;
+    bool foundone = false;
+    
+    
+    for (auto l = 0; l < this->height; l++)
+    {
+        if (foundone && foundzero)
+        {
+            // All contents are guaranteed to be results
+            visitor.noChecks(this->pOrgsInIds, this->pOrgsInXors, this->pOrgsInPayloads, NULL, &this->pOrgsInTimestamps, this->pOrgsInDirectory, this->pOrgsInFrozen, l, a, a);
+            visitor.noChecks(this->pOrgsAftIds, this->pOrgsAftXors, this->pOrgsAftPayloads, &this->pOrgsAftEndpoints, &this->pOrgsAftStarts, this->pOrgsAftDirectory, this->pOrgsAftFrozen, l, a, a);
+            visitor.noChecks(this->pRepsInIds, this->pRepsInXors, this->pRepsInPayloads, &this->pRepsInEndpoints, &this->pRepsInEnds, this->pRepsInDirectory, this->pRepsInFrozen, l, a, a);
+        }
+        else if (foundzero)
+        {
+            // Ends follow the point
+            visitor.checkStart(this->pOrgsInIds, this->pOrgsInXors, this->pOrgsInPayloads, NULL, this->pOrgsInTimestamps, this->pOrgsInZones, this->pOrgsInSorted, &this->pOrgsInAggregates, this->pOrgsInFrozen, l, a, this->toLocal(l, a, Q.point));
+            visitor.checkStart(this->pOrgsAftIds, this->pOrgsAftXors, this->pOrgsAftPayloads, &this->pOrgsAftEndpoints, this->pOrgsAftStarts, this->pOrgsAftZones, this->pOrgsAftSorted, NULL, this->pOrgsAftFrozen, l, a, this->toLocal(l, a, Q.point));
+            visitor.noChecks(this->pRepsInIds, this->pRepsInXors, this->pRepsInPayloads, &this->pRepsInEndpoints, &this->pRepsInEnds, this->pRepsInDirectory, this->pRepsInFrozen, l, a, a);
+        }
+        else if (foundone)
+        {
+            // Starts precede the point
+            visitor.checkEnd(this->pOrgsInIds, this->pOrgsInXors, this->pOrgsInPayloads, NULL, this->pOrgsInTimestamps, this->pOrgsInZones, this->pOrgsInSorted, &this->pOrgsInAggregates, this->pOrgsInFrozen, l, a, this->toLocal(l, a, Q.point));
+            visitor.noChecks(this->pOrgsAftIds, this->pOrgsAftXors, this->pOrgsAftPayloads, &this->pOrgsAftEndpoints, &this->pOrgsAftStarts, this->pOrgsAftDirectory, this->pOrgsAftFrozen, l, a, a);
+            visitor.checkEnd(this->pRepsInIds, this->pRepsInXors, this->pRepsInPayloads, &this->pRepsInEndpoints, this->pRepsInEnds, this->pRepsInZones, this->pRepsInSorted, NULL, this->pRepsInFrozen, l, a, this->toLocal(l, a, Q.point));
+        }
+        else
+        {
+            // Lemma 3
+            visitor.checkBoth(this->pOrgsInIds, this->pOrgsInXors, this->pOrgsInPayloads, NULL, this->pOrgsInTimestamps, this->pOrgsInZones, this->pOrgsInSorted, &this->pOrgsInAggregates, this->pOrgsInFrozen, l, a, this->toLocal(l, a, Q.point), this->toLocal(l, a, Q.point));
+            visitor.checkStart(this->pOrgsAftIds, this->pOrgsAftXors, this->pOrgsAftPayloads, &this->pOrgsAftEndpoints, this->pOrgsAftStarts, this->pOrgsAftZones, this->pOrgsAftSorted, NULL, this->pOrgsAftFrozen, l, a, this->toLocal(l, a, Q.point));
+            visitor.checkEnd(this->pRepsInIds, this->pRepsInXors, this->pRepsInPayloads, &this->pRepsInEndpoints, this->pRepsInEnds, this->pRepsInZones, this->pRepsInSorted, NULL, this->pRepsInFrozen, l, a, this->toLocal(l, a, Q.point));
+        }
+        visitor.template noChecks<LocalTimestamp>(this->pRepsAftIds, this->pRepsAftXors, this->pRepsAftPayloads, &this->pRepsAftEndpoints, NULL, this->pRepsAftDirectory, this->pRepsAftFrozen, l, a, a);
+        
+        if (a%2) //last bit of a is 1
+            foundone = true;
+        else
+            foundzero = true;
+        a >>= 1; // a = a div 2
+    }
+}
+
+
+// Visitor of traverse() that reports every partition it is told of right away, through policy A.
+template <class A>
+struct HINT_M_Dynamic::Reporter
+{
+    HINT_M_Dynamic *index;
+    typename A::Result &result;
+    
+    template <class T>
+    inline void noChecks(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<PartitionPayloads> > &pPayloads, const vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, const vector<PartitionBlocks<vector<T> > > *pTimestamps, const vector<PartitionDirectory> &pDirectory, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId from, PartitionId to)
+    {
+        this->index->template scanPartitions_NoChecks<A>(pIds, pXors, pDirectory, pFrozen, level, from, to, this->result);
+    }
+    
+    template <class T>
+    inline void checkStart(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<PartitionPayloads> > &pPayloads, const vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, const vector<PartitionBlocks<vector<T> > > &pTimestamps, const vector<PartitionBlocks<ZoneMap<T> > > &pZones, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<PartitionBlocks<OverlapAggregates> > *pAggregates, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, LocalTimestamp qend)
+    {
+        this->index->template scanPartition_CheckStart<A>(pIds, pXors, pTimestamps, pZones, pSorted, pAggregates, pFrozen, level, pid, qend, this->result);
+    }
+    
+    template <class T>
+    inline void checkEnd(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<PartitionPayloads> > &pPayloads, const vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, const vector<PartitionBlocks<vector<T> > > &pTimestamps, const vector<PartitionBlocks<ZoneMap<T> > > &pZones, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<PartitionBlocks<OverlapAggregates> > *pAggregates, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, LocalTimestamp qstart)
+    {
+        this->index->template scanPartition_CheckEnd<A>(pIds, pXors, pTimestamps, pZones, pSorted, pAggregates, pFrozen, level, pid, qstart, this->result);
+    }
+    
+    inline void checkBoth(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<PartitionPayloads> > &pPayloads, const vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, const vector<PartitionBlocks<vector<pair<LocalTimestamp, LocalTimestamp> > > > &pTimestamps, const vector<PartitionBlocks<ZoneMap<pair<LocalTimestamp, LocalTimestamp> > > > &pZones, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<PartitionBlocks<OverlapAggregates> > *pAggregates, const vector<FrozenPartitions<pair<LocalTimestamp, LocalTimestamp> > > &pFrozen, unsigned int level, PartitionId pid, LocalTimestamp qstart, LocalTimestamp qend)
+    {
+        this->index->template scanPartition_CheckBoth<A>(pIds, pXors, pTimestamps, pZones, pSorted, pAggregates, pFrozen, level, pid, qstart, qend, this->result);
+    }
+};
+
+
+// Visitor of traverse() that lays out the runs of a cursor, or of a parallel query, instead of scanning them through policy A.
+// A partition that needs no comparisons, or whose zone map decides every entry, becomes a single run; otherwise its entries
+// in the packed layout, or its sorted body and its tail, become runs that are scanned with the kernels of the queries.
+template <class A>
+struct HINT_M_Dynamic::Planner
+{
+    HINT_M_Dynamic *index;
+    vector<Run<typename A::Result> > &runs;
+    
+    inline void addRun(size_t size, function<void(size_t, size_t, typename A::Result&)> scan)
+    {
+        if (size > 0)
+            this->runs.push_back({size, move(scan)});
+    }
+    
+    template <class T>
+    inline void addFrozen(const FrozenPartitions<T> &frozen, size_t offset, size_t size)
+    {
+        RecordId idBase = this->index->idBase;
+        
+        this->addRun(size, [&frozen, idBase, offset](size_t first, size_t size, typename A::Result &result) {
+            reportFrozenEntries<A>(frozen, idBase, offset+first, size, result);
+        });
+    }
+    
+    template <class T>
+    inline void addPartition(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid)
+    {
+        const FrozenPartitions<T> &frozen = pFrozen[level];
+        
+        if (pid < (PartitionId)frozen.getNumPartitions())
+        {
+            size_t next_from = 0, offset, size;
+            
+            frozen.getBounds(pid, next_from, offset, size);
+            this->addFrozen(frozen, offset, size);
+        }
+        else
+        {
+            const LocalRelationId &pIdsP = pIds[level][pid];
+            RecordId idBase = this->index->idBase;
+            
+            this->addRun(pIdsP.size(), [&pIdsP, idBase](size_t first, size_t size, typename A::Result &result) {
+                scan_NoChecks<A>(idBase, pIdsP.data()+first, size, result);
+            });
+        }
+    }
+    
+    template <class T>
+    inline void noChecks(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<PartitionPayloads> > &pPayloads, const vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, const vector<PartitionBlocks<vector<T> > > *pTimestamps, const vector<PartitionDirectory> &pDirectory, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId from, PartitionId to)
+    {
+        const FrozenPartitions<T> &frozen = pFrozen[level];
+        PartitionId numFrozen = frozen.getNumPartitions();
+        
+        if (from == to)
+            this->addPartition(pIds, pFrozen, level, from);
+        else if (from < to)
+        {
+            const PartitionDirectory &directory = pDirectory[level];
+            
+            if (from < numFrozen)
+            {
+                PartitionId last = min(to+1, numFrozen);
+                size_t offset = frozen.getOffset(from);
+                
+                this->addFrozen(frozen, offset, frozen.getOffset(last)-offset);
+                from = last;
+            }
+            for (size_t k = directory.find(from); (k < directory.pids.size()) && (directory.pids[k] <= to); k++)
+                this->addPartition(pIds, pFrozen, level, directory.pids[k]);
+        }
+    }
+    
+    template <class T>
+    inline void checkStart(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<PartitionPayloads> > &pPayloads, const vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, const vector<PartitionBlocks<vector<T> > > &pTimestamps, const vector<PartitionBlocks<ZoneMap<T> > > &pZones, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<PartitionBlocks<OverlapAggregates> > *pAggregates, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, LocalTimestamp qend)
+    {
+        ZoneMap<T> zone = getZone(pZones, pFrozen, level, pid);
+        const FrozenPartitions<T> &frozen = pFrozen[level];
+        RecordId idBase = this->index->idBase;
+        const LocalRecordId *ids;
+        const T *timestamps;
+        size_t size, sortedSize;
+        
+        if (zone.getMin(0) > qend)
+            return;
+        if (zone.getMax(0) <= qend)
+        {
+            this->addPartition(pIds, pFrozen, level, pid);
+            return;
+        }
+        
+        this->index->getPartition(pIds, pTimestamps, pSorted, pFrozen, level, pid, ids, timestamps, size, sortedSize);
+        if (!ids)
+        {
+            size_t offset = frozen.getOffset(pid);
+            
+            this->addRun(size, [&frozen, idBase, offset, qend](size_t first, size_t size, typename A::Result &result) {
+                scanPacked_CheckStart<A>(frozen, idBase, offset+first, size, qend, result);
+            });
+            return;
+        }
+        this->addRun(sortedSize, [idBase, ids, timestamps, qend](size_t first, size_t size, typename A::Result &result) {
+            scanSorted_CheckStart<A>(idBase, ids+first, timestamps+first, size, qend, result);
+        });
+        ids += sortedSize;
+        timestamps += sortedSize;
+        this->addRun(size-sortedSize, [idBase, ids, timestamps, qend](size_t first, size_t size, typename A::Result &result) {
+            scan_CheckStart<A>(idBase, ids+first, timestamps+first, size, qend, result);
+        });
+    }
+    
+    template <class T>
+    inline void checkEnd(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<PartitionPayloads> > &pPayloads, const vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, const vector<PartitionBlocks<vector<T> > > &pTimestamps, const vector<PartitionBlocks<ZoneMap<T> > > &pZones, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<PartitionBlocks<OverlapAggregates> > *pAggregates, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, LocalTimestamp qstart)
+    {
+        ZoneMap<T> zone = getZone(pZones, pFrozen, level, pid);
+        const FrozenPartitions<T> &frozen = pFrozen[level];
+        RecordId idBase = this->index->idBase;
+        const LocalRecordId *ids;
+        const T *timestamps;
+        size_t size, sortedSize;
+        
+        if (zone.getMax(ZoneMap<T>::NUM_COMPONENTS-1) < qstart)
+            return;
+        if (zone.getMin(ZoneMap<T>::NUM_COMPONENTS-1) >= qstart)
+        {
+            this->addPartition(pIds, pFrozen, level, pid);
+            return;
+        }
+        
+        this->index->getPartition(pIds, pTimestamps, pSorted, pFrozen, level, pid, ids, timestamps, size, sortedSize);
+        if (!ids)
+        {
+            size_t offset = frozen.getOffset(pid);
+            
+            this->addRun(size, [&frozen, idBase, offset, qstart](size_t first, size_t size, typename A::Result &result) {
+                scanPacked_CheckEnd<A>(frozen, idBase, offset+first, size, qstart, result);
+            });
+            return;
+        }
+        this->addRun(sortedSize, [idBase, ids, timestamps, qstart](size_t first, size_t size, typename A::Result &result) {
+            scanSorted_CheckEnd<A>(idBase, ids+first, timestamps+first, size, qstart, result);
+        });
+        ids += sortedSize;
+        timestamps += sortedSize;
+        this->addRun(size-sortedSize, [idBase, ids, timestamps, qstart](size_t first, size_t size, typename A::Result &result) {
+            scan_CheckEnd<A>(idBase, ids+first, timestamps+first, size, qstart, result);
+        });
+    }
+    
+    inline void checkBoth(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<PartitionPayloads> > &pPayloads, const vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, const vector<PartitionBlocks<vector<pair<LocalTimestamp, LocalTimestamp> > > > &pTimestamps, const vector<PartitionBlocks<ZoneMap<pair<LocalTimestamp, LocalTimestamp> > > > &pZones, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<PartitionBlocks<OverlapAggregates> > *pAggregates, const vector<FrozenPartitions<pair<LocalTimestamp, LocalTimestamp> > > &pFrozen, unsigned int level, PartitionId pid, LocalTimestamp qstart, LocalTimestamp qend)
+    {
+        ZoneMap<pair<LocalTimestamp, LocalTimestamp> > zone = getZone(pZones, pFrozen, level, pid);
+        const FrozenPartitions<pair<LocalTimestamp, LocalTimestamp> > &frozen = pFrozen[level];
+        RecordId idBase = this->index->idBase;
+        const LocalRecordId *ids;
+        const pair<LocalTimestamp, LocalTimestamp> *timestamps;
+        size_t size, sortedSize;
+        
+        if (zone.getMax(0) <= qend)
+        {
+            this->checkEnd(pIds, pXors, pPayloads, pEndpoints, pTimestamps, pZones, pSorted, pAggregates, pFrozen, level, pid, qstart);
+            return;
+        }
+        if (zone.getMin(1) >= qstart)
+        {
+            this->checkStart(pIds, pXors, pPayloads, pEndpoints, pTimestamps, pZones, pSorted, pAggregates, pFrozen, level, pid, qend);
+            return;
+        }
+        if ((zone.getMin(0) > qend) || (zone.getMax(1) < qstart))
+            return;
+        
+        this->index->getPartition(pIds, pTimestamps, pSorted, pFrozen, level, pid, ids, timestamps, size, sortedSize);
+        if (!ids)
+        {
+            size_t offset = frozen.getOffset(pid);
+            
+            this->addRun(size, [&frozen, idBase, offset, qstart, qend](size_t first, size_t size, typename A::Result &result) {
+                scanPacked_CheckBoth<A>(frozen, idBase, offset+first, size, qstart, qend, result);
+            });
+            return;
+        }
+        this->addRun(sortedSize, [idBase, ids, timestamps, qstart, qend](size_t first, size_t size, typename A::Result &result) {
+            scanSorted_CheckBoth<A>(idBase, ids+first, timestamps+first, size, qstart, qend, result);
+        });
+        ids += sortedSize;
+        timestamps += sortedSize;
+        this->addRun(size-sortedSize, [idBase, ids, timestamps, qstart, qend](size_t first, size_t size, typename A::Result &result) {
+            scan_CheckBoth<A>(idBase, ids+first, timestamps+first, size, qstart, qend, result);
+        });
+    }
+};
+
+
+// Scans the runs into result; once they hold at least MIN_PARALLEL_ENTRIES entries and there is a pool, they are cut into equal shares
+// of entries swept by the pool, whose partial results are merged into result through merge(result, partial) in the order of the runs.
+template <class Result, class Merge>
+inline void HINT_M_Dynamic::scanRuns(const vector<Run<Result> > &runs, Result &result, Merge merge)
+{
+    vector<size_t> runOffsets(1, 0);
+    
+    for (const auto &run : runs)
+        runOffsets.push_back(runOffsets.back()+run.size);
+    
+    size_t numEntries = runOffsets.back();
+    
+    if ((!this->queryPool) || (numEntries < MIN_PARALLEL_ENTRIES))
+    {
+        for (const auto &run : runs)
+            run.scan(0, run.size, result);
+        return;
+    }
+    
+    // A few shares per thread, handed out dynamically, even out the threads
+    size_t numShares = 4*this->queryPool->getNumThreads();
+    size_t shareSize = (numEntries+numShares-1)/numShares;
+    vector<Result> partialResults(numShares);
+    
+    this->queryPool->run(numShares, [&](size_t share) {
+        size_t from = share*shareSize, to = min(numEntries, from+shareSize);
+        size_t k = upper_bound(runOffsets.begin(), runOffsets.end(), from)-runOffsets.begin()-1;
+        
+        for (; (k < runs.size()) && (runOffsets[k] < to); k++)
+        {
+            size_t first = max(from, runOffsets[k]), last = min(to, runOffsets[k+1]);
+            
+            runs[k].scan(first-runOffsets[k], last-first, partialResults[share]);
+        }
+    });
+    
+    for (const auto &partialResult : partialResults)
+        merge(result, partialResult);
+}
+
+
+// Policies with aggregates report the partitions that need no comparisons in O(1) and are left serial. The others, with a pool,
+// lay out the runs of the query first and scan them through scanRuns(), in parallel if they are long enough.
+// The overflow adds its results after those of the index.
+template <class A, class Query>
+inline void HINT_M_Dynamic::query(Query Q, typename A::Result &result)
+{
+    if ((!A::HAS_AGGREGATES) && (this->queryPool))
+    {
+        vector<Run<typename A::Result> > runs;
+        Planner<A> planner = {this, runs};
+        
+        this->traverse(Q, planner);
+        this->scanRuns(runs, result, A::merge);
+    }
+    else
+    {
+        Reporter<A> reporter = {this, result};
+        
+        this->traverse(Q, reporter);
+    }
+    if (this->overflow)
+        this->overflow->template query<A>(Q, result);
+}
+
+
+template <class A>
+void HINT_M_Dynamic::execute_pureTimeTravel(RangeQuery Q, typename A::Result &result)
+{
+    this->query<A>(Q, result);
+}
+
+
+template <class A>
+void HINT_M_Dynamic::execute_pureTimeTravel(StabbingQuery Q, typename A::Result &result)
+{
+    this->query<A>(Q, result);
+}
+
+
+size_t HINT_M_Dynamic::execute_pureTimeTravel(RangeQuery Q)
+{
+    size_t result = 0;
+    
+    this->execute_pureTimeTravel<WorkloadAggregator>(Q, result);
+    
+    return result;
+}
 
-            // Lemma 1, 3
-            if (!foundzero)
-            {
-                iterI = this->pRepsInIds[l][a].begin();
-                iterStart = this->pRepsInTimestamps[l][a].begin();
-                iterEnd = this->pRepsInTimestamps[l][a].end();
-                for (iter = iterStart; iter != iterEnd; iter++)
-                {
-                    if (Q.start <= iter->second)
-                    {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
-                    }
-                    iterI++;
-                }
-            }
-            else
-            {
-                iterIStart = this->pRepsInIds[l][a].begin();
-                iterIEnd = this->pRepsInIds[l][a].end();
-                for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-                {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
-                }
-            }
 
-            iterIStart = this->pRepsAftIds[l][a].begin();
-            iterIEnd = this->pRepsAftIds[l][a].end();
-            for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-            {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
-            }
+size_t HINT_M_Dynamic::execute_pureTimeTravel(StabbingQuery Q)
+{
+    size_t result = 0;
+    
+    this->execute_pureTimeTravel<WorkloadAggregator>(Q, result);
+    
+    return result;
+}
 
-            if (a < b)
-            {
-                if (!foundone)
-                {
-                    // Handle the rest before the partition that contains b: consider only originals, no comparisons needed
-                    for (auto j = a+1; j < b; j++)
-                    {
-                        iterIStart = this->pOrgsInIds[l][j].begin();
-                        iterIEnd = this->pOrgsInIds[l][j].end();
-                        for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                        iterIStart = this->pOrgsAftIds[l][j].begin();
-                        iterIEnd = this->pOrgsAftIds[l][j].end();
-                        for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                    }
 
-                    // Handle the partition that contains b: consider only originals, comparisons needed
-                    iterI = this->pOrgsInIds[l][b].begin();
-                    iterStart = this->pOrgsInTimestamps[l][b].begin();
-                    iterEnd = this->pOrgsInTimestamps[l][b].end();
-                    for (iter = iterStart; iter != iterEnd; iter++)
-                    {
-                        if (iter->first <= Q.end)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                        iterI++;
-                    }
-                    iterI = this->pOrgsAftIds[l][b].begin();
-                    iterStart = this->pOrgsAftTimestamps[l][b].begin();
-                    iterEnd = this->pOrgsAftTimestamps[l][b].end();
-                    for (iter = iterStart; iter != iterEnd; iter++)
-                    {
-                        if (iter->first <= Q.end)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                        iterI++;
-                    }
-                }
-                else
-                {
-                    for (auto j = a+1; j <= b; j++)
-                    {
-                        iterIStart = this->pOrgsInIds[l][j].begin();
-                        iterIEnd = this->pOrgsInIds[l][j].end();
-                        for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                        iterIStart = this->pOrgsAftIds[l][j].begin();
-                        iterIEnd = this->pOrgsAftIds[l][j].end();
-                        for (iterI = iterIStart; iterI != iterIEnd; iterI++)
-                        {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
-                        }
-                    }
-                }
+template void HINT_M_Dynamic::execute_pureTimeTravel<CountAggregator>(RangeQuery Q, size_t &result);
+template void HINT_M_Dynamic::execute_pureTimeTravel<XorAggregator>(RangeQuery Q, size_t &result);
+template void HINT_M_Dynamic::execute_pureTimeTravel<SumAggregator>(RangeQuery Q, size_t &result);
+template void HINT_M_Dynamic::execute_pureTimeTravel<CollectAggregator>(RangeQuery Q, vector<RecordId> &result);
+template void HINT_M_Dynamic::execute_pureTimeTravel<CountAggregator>(StabbingQuery Q, size_t &result);
+template void HINT_M_Dynamic::execute_pureTimeTravel<XorAggregator>(StabbingQuery Q, size_t &result);
+template void HINT_M_Dynamic::execute_pureTimeTravel<SumAggregator>(StabbingQuery Q, size_t &result);
+template void HINT_M_Dynamic::execute_pureTimeTravel<CollectAggregator>(StabbingQuery Q, vector<RecordId> &result);
+
+
+// Visitor of traverse() that aggregates the payloads of the results. A partition that needs no comparisons,
+// or whose zone map decides every entry, is taken through the aggregate of its payloads, and so is a run of compacted ones;
+// otherwise its payloads are scanned along its timestamps, with the sorted body cut as in the queries; with a pool,
+// the scans are laid out as runs for scanRuns().
+struct HINT_M_Dynamic::PayloadReporter
+{
+    HINT_M_Dynamic *index;
+    PayloadAggregate &result;
+    vector<Run<PayloadAggregate> > *runs;       // If not null, the scans are laid out there as runs instead
+    
+    template <class T>
+    inline void addPartition(const vector<PartitionBlocks<PartitionPayloads> > &pPayloads, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid)
+    {
+        if (pid < (PartitionId)pFrozen[level].getNumPartitions())
+            this->result.merge(pFrozen[level].getPayloadAggregate(pid));
+        else
+            this->result.merge(pPayloads[level][pid].aggregate);
+    }
+    
+    // Scans entries [0, size) through scan(first, size, result), right away or as a run.
+    template <class Scan>
+    inline void addRun(size_t size, Scan scan)
+    {
+        if (size == 0)
+            return;
+        if (this->runs)
+            this->runs->push_back({size, scan});
+        else
+            scan(0, size, this->result);
+    }
+    
+    // Scans partition pid through scan(payloads, timestamps, size, result), and its sorted body through scanSorted();
+    // packed entries are unpacked a block at a time and compared as a tail.
+    template <class T, class Scan, class ScanSorted>
+    inline void scanPartition(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<PartitionPayloads> > &pPayloads, const vector<PartitionBlocks<vector<T> > > &pTimestamps, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, Scan scan, ScanSorted scanSorted)
+    {
+        const FrozenPartitions<T> &frozen = pFrozen[level];
+        const LocalRecordId *ids;
+        const T *timestamps;
+        const Payload *payloads;
+        size_t size, sortedSize;
+        
+        this->index->getPartition(pIds, pTimestamps, pSorted, pFrozen, level, pid, ids, timestamps, size, sortedSize);
+        if (size == 0)
+            return;
+        if (pid < (PartitionId)frozen.getNumPartitions())
+        {
+            size_t offset = frozen.getOffset(pid);
+            
+            payloads = frozen.getPayloads(offset);
+            if (!ids)
+            {
+                this->addRun(size, [&frozen, offset, payloads, scan](size_t first, size_t size, PayloadAggregate &result) {
+                    size_t position = first;
+                    
+                    frozen.visit(offset+first, size, [&](const LocalRecordId *, const T *timestamps, size_t n) {
+                        scan(payloads+position, timestamps, n, result);
+                        position += n;
+                    });
+                });
+                return;
             }
+        }
+        else
+            payloads = pPayloads[level][pid].values.data();
+        
+        this->addRun(sortedSize, [payloads, timestamps, scanSorted](size_t first, size_t size, PayloadAggregate &result) {
+            scanSorted(payloads+first, timestamps+first, size, result);
+        });
+        payloads += sortedSize;
+        timestamps += sortedSize;
+        this->addRun(size-sortedSize, [payloads, timestamps, scan](size_t first, size_t size, PayloadAggregate &result) {
+            scan(payloads+first, timestamps+first, size, result);
+        });
+    }
+    
+    template <class T>
+    inline void noChecks(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<PartitionPayloads> > &pPayloads, const vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, const vector<PartitionBlocks<vector<T> > > *pTimestamps, const vector<PartitionDirectory> &pDirectory, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId from, PartitionId to)
+    {
+        const FrozenPartitions<T> &frozen = pFrozen[level];
+        const PartitionDirectory &directory = pDirectory[level];
+        PartitionId numFrozen = frozen.getNumPartitions();
+        
+        if (from > to)
+            return;
+        if (from < numFrozen)
+        {
+            PartitionId last = min(to+1, numFrozen);
             
-            if ((!foundone) && (b%2)) //last bit of b is 1
-                foundone = 1;
-            if ((!foundzero) && (!(a%2))) //last bit of a is 0
-                foundzero = 1;
+            frozen.aggregatePayloads(from, last, this->result);
+            from = last;
         }
-        a >>= 1; // a = a div 2
-        b >>= 1; // b = b div 2
+        for (size_t k = directory.find(from); (k < directory.pids.size()) && (directory.pids[k] <= to); k++)
+            this->result.merge(pPayloads[level][directory.pids[k]].aggregate);
     }
     
-    // Handle root.
-    if (foundone && foundzero)
+    template <class T>
+    inline void checkStart(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<PartitionPayloads> > &pPayloads, const vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, const vector<PartitionBlocks<vector<T> > > &pTimestamps, const vector<PartitionBlocks<ZoneMap<T> > > &pZones, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<PartitionBlocks<OverlapAggregates> > *pAggregates, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, LocalTimestamp qend)
     {
-        // All contents are guaranteed to be results
-        iterIStart = this->pOrgsInIds[this->numBits][0].begin();
-        iterIEnd = this->pOrgsInIds[this->numBits][0].end();
-        for (iterI = iterIStart; iterI != iterIEnd; iterI++)
+        ZoneMap<T> zone = getZone(pZones, pFrozen, level, pid);
+        
+        if (zone.getMin(0) > qend)
+            return;
+        if (zone.getMax(0) <= qend)
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= (*iterI);
-#endif
+            this->addPartition(pPayloads, pFrozen, level, pid);
+            return;
         }
+        
+        this->scanPartition(pIds, pPayloads, pTimestamps, pSorted, pFrozen, level, pid, [qend](const Payload *payloads, const T *timestamps, size_t size, PayloadAggregate &result) {
+            scanPayloads_CheckStart(payloads, timestamps, size, qend, result);
+        }, [qend](const Payload *payloads, const T *timestamps, size_t size, PayloadAggregate &result) {
+            scanSortedPayloads_CheckStart(payloads, timestamps, size, qend, result);
+        });
     }
-    else
+    
+    template <class T>
+    inline void checkEnd(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<PartitionPayloads> > &pPayloads, const vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, const vector<PartitionBlocks<vector<T> > > &pTimestamps, const vector<PartitionBlocks<ZoneMap<T> > > &pZones, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<PartitionBlocks<OverlapAggregates> > *pAggregates, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, LocalTimestamp qstart)
     {
-        // Comparisons needed
-        iterI = this->pOrgsInIds[this->numBits][0].begin();
-        iterStart = this->pOrgsInTimestamps[this->numBits][0].begin();
-        iterEnd = this->pOrgsInTimestamps[this->numBits][0].end();
-        for (iter = iterStart; iter != iterEnd; iter++)
+        ZoneMap<T> zone = getZone(pZones, pFrozen, level, pid);
+        
+        if (zone.getMax(ZoneMap<T>::NUM_COMPONENTS-1) < qstart)
+            return;
+        if (zone.getMin(ZoneMap<T>::NUM_COMPONENTS-1) >= qstart)
         {
-            if ((iter->first <= Q.end) && (Q.start <= iter->second))
-            {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
-            }
-            iterI++;
+            this->addPartition(pPayloads, pFrozen, level, pid);
+            return;
         }
+        
+        this->scanPartition(pIds, pPayloads, pTimestamps, pSorted, pFrozen, level, pid, [qstart](const Payload *payloads, const T *timestamps, size_t size, PayloadAggregate &result) {
+            scanPayloads_CheckEnd(payloads, timestamps, size, qstart, result);
+        }, [qstart](const Payload *payloads, const T *timestamps, size_t size, PayloadAggregate &result) {
+            scanSortedPayloads_CheckEnd(payloads, timestamps, size, qstart, result);
+        });
     }
     
-    return result;
+    inline void checkBoth(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<PartitionPayloads> > &pPayloads, const vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, const vector<PartitionBlocks<vector<pair<LocalTimestamp, LocalTimestamp> > > > &pTimestamps, const vector<PartitionBlocks<ZoneMap<pair<LocalTimestamp, LocalTimestamp> > > > &pZones, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<PartitionBlocks<OverlapAggregates> > *pAggregates, const vector<FrozenPartitions<pair<LocalTimestamp, LocalTimestamp> > > &pFrozen, unsigned int level, PartitionId pid, LocalTimestamp qstart, LocalTimestamp qend)
+    {
+        ZoneMap<pair<LocalTimestamp, LocalTimestamp> > zone = getZone(pZones, pFrozen, level, pid);
+        
+        if (zone.getMax(0) <= qend)
+        {
+            this->checkEnd(pIds, pXors, pPayloads, pEndpoints, pTimestamps, pZones, pSorted, pAggregates, pFrozen, level, pid, qstart);
+            return;
+        }
+        if (zone.getMin(1) >= qstart)
+        {
+            this->checkStart(pIds, pXors, pPayloads, pEndpoints, pTimestamps, pZones, pSorted, pAggregates, pFrozen, level, pid, qend);
+            return;
+        }
+        if ((zone.getMin(0) > qend) || (zone.getMax(1) < qstart))
+            return;
+        
+        this->scanPartition(pIds, pPayloads, pTimestamps, pSorted, pFrozen, level, pid, [qstart, qend](const Payload *payloads, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, PayloadAggregate &result) {
+            scanPayloads_CheckBoth(payloads, timestamps, size, qstart, qend, result);
+        }, [qstart, qend](const Payload *payloads, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, PayloadAggregate &result) {
+            scanSortedPayloads_CheckBoth(payloads, timestamps, size, qstart, qend, result);
+        });
+    }
+};
+
+
+void HINT_M_Dynamic::execute_payloadTimeTravel(RangeQuery Q, PayloadAggregate &result)
+{
+    vector<Run<PayloadAggregate> > runs;
+    PayloadReporter reporter = {this, result, (this->queryPool)? &runs: NULL};
+    
+    if (!this->keepsPayloads)
+        throw logic_error("Index keeps no payloads");
+    this->traverse(Q, reporter);
+    this->scanRuns(runs, result, [](PayloadAggregate &result, const PayloadAggregate &partialResult) {
+        result.merge(partialResult);
+    });
+    if (this->overflow)
+        this->overflow->execute_payloadTimeTravel(Q, result);
 }
 
 
-void HINT_M_Dynamic::deleteFossilsFromPartition(Timestamp Tf, Relation &deletedIntervals, unordered_set<int> &processed, vector<int> &ids, vector<pair<Timestamp, Timestamp>> &timestamps) {
-    size_t i = 0;
-    vector<int> remainingIds;
-    vector<pair<Timestamp, Timestamp>> remainingTimestamps;
+void HINT_M_Dynamic::execute_payloadTimeTravel(StabbingQuery Q, PayloadAggregate &result)
+{
+    vector<Run<PayloadAggregate> > runs;
+    PayloadReporter reporter = {this, result, (this->queryPool)? &runs: NULL};
+    
+    if (!this->keepsPayloads)
+        throw logic_error("Index keeps no payloads");
+    this->traverse(Q, reporter);
+    this->scanRuns(runs, result, [](PayloadAggregate &result, const PayloadAggregate &partialResult) {
+        result.merge(partialResult);
+    });
+    if (this->overflow)
+        this->overflow->execute_payloadTimeTravel(Q, result);
+}
 
-    for (size_t i = 0; i < ids.size(); ++i) {
-        if (timestamps[i].second < Tf) {
-            if (processed.find(ids[i]) == processed.end()) {
-                deletedIntervals.emplace_back(ids[i], timestamps[i].first, timestamps[i].second);
-                processed.insert(ids[i]);
-            }
-            this->numIndexedRecords--;
-        } else {
-            remainingIds.push_back(ids[i]);
-            remainingTimestamps.push_back(timestamps[i]);
+
+// Adds to results the entries [0, size) of a partition that start by qend and end from qstart on, with their intervals;
+// an entry takes its start and its end from starts and ends, or if null from the first and the last component of its timestamp entry.
+// All timestamps are offsets from partitionStart, the ids from idBase.
+template <class T>
+static inline void scanResults(RecordId idBase, Timestamp partitionStart, const LocalRecordId *ids, const T *timestamps, const Timestamp *starts, const Timestamp *ends, size_t size, LocalTimestamp qstart, LocalTimestamp qend, vector<QueryResult> &results)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        Timestamp start = (starts)? starts[i]: getTimestampComponent(timestamps[i], 0);
+        Timestamp end   = (ends)? ends[i]: getTimestampComponent(timestamps[i], ZoneMap<T>::NUM_COMPONENTS-1);
+        
+        if ((start <= qend) && (qstart <= end))
+            results.push_back({idBase+ids[i], partitionStart+start, partitionStart+end});
+    }
+}
+
+
+// Visitor of traverse() that lays out the runs of a cursor, which reports each result with its interval, the endpoints a subdivision
+// does not keep coming from its endpoint columns. A partition that needs no comparisons, or whose zone map decides every entry,
+// becomes a single run compared against no bounds; otherwise it is compared entry by entry against the bounds it needs.
+struct HINT_M_Dynamic::ResultPlanner
+{
+    static const LocalTimestamp NO_START = numeric_limits<LocalTimestamp>::min();
+    static const LocalTimestamp NO_END   = numeric_limits<LocalTimestamp>::max();
+    
+    HINT_M_Dynamic *index;
+    vector<Run<vector<QueryResult> > > &runs;
+    
+    // Partition pid as a run of the entries that start by qend and end from qstart on; pTimestamps is null for RepsAft, pEndpoints for OrgsIn.
+    template <class T>
+    inline void addPartition(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, const vector<PartitionBlocks<vector<T> > > *pTimestamps, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, LocalTimestamp qstart, LocalTimestamp qend)
+    {
+        const FrozenPartitions<T> &frozen = pFrozen[level];
+        Timestamp partitionStart = this->index->getPartitionStart(level, pid);
+        RecordId idBase = this->index->idBase;
+        
+        if (pid < (PartitionId)frozen.getNumPartitions())
+        {
+            size_t next_from = 0, offset, size;
+            
+            frozen.getBounds(pid, next_from, offset, size);
+            
+            const Timestamp *starts = frozen.getStarts(offset), *ends = frozen.getEnds(offset);
+            
+            if (size > 0)
+                this->runs.push_back({size, [&frozen, idBase, partitionStart, offset, starts, ends, qstart, qend](size_t first, size_t size, vector<QueryResult> &results) {
+                    size_t position = first;
+                    
+                    frozen.visit(offset+first, size, [&](const LocalRecordId *ids, const T *timestamps, size_t n) {
+                        scanResults(idBase, partitionStart, ids, timestamps, (starts)? starts+position: NULL, (ends)? ends+position: NULL, n, qstart, qend, results);
+                        position += n;
+                    });
+                }});
+        }
+        else
+        {
+            const LocalRecordId *ids = pIds[level][pid].data();
+            const T *timestamps = (pTimestamps)? (*pTimestamps)[level][pid].data(): NULL;
+            const PartitionEndpoints *endpoints = (pEndpoints)? &(*pEndpoints)[level][pid]: NULL;
+            const Timestamp *starts = ((endpoints) && (!endpoints->starts.empty()))? endpoints->starts.data(): NULL;
+            const Timestamp *ends = ((endpoints) && (!endpoints->ends.empty()))? endpoints->ends.data(): NULL;
+            size_t size = pIds[level][pid].size();
+            
+            if (size > 0)
+                this->runs.push_back({size, [idBase, partitionStart, ids, timestamps, starts, ends, qstart, qend](size_t first, size_t size, vector<QueryResult> &results) {
+                    scanResults(idBase, partitionStart, ids+first, (timestamps)? timestamps+first: NULL, (starts)? starts+first: NULL, (ends)? ends+first: NULL, size, qstart, qend, results);
+                }});
         }
     }
+    
+    template <class T>
+    inline void noChecks(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<PartitionPayloads> > &pPayloads, const vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, const vector<PartitionBlocks<vector<T> > > *pTimestamps, const vector<PartitionDirectory> &pDirectory, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId from, PartitionId to)
+    {
+        const FrozenPartitions<T> &frozen = pFrozen[level];
+        const PartitionDirectory &directory = pDirectory[level];
+        
+        // The compacted partitions one by one, each has its own origin
+        for (; (from <= to) && (from < (PartitionId)frozen.getNumPartitions()); from++)
+            this->addPartition(pIds, pEndpoints, pTimestamps, pFrozen, level, from, NO_START, NO_END);
+        for (size_t k = directory.find(from); (k < directory.pids.size()) && (directory.pids[k] <= to); k++)
+            this->addPartition(pIds, pEndpoints, pTimestamps, pFrozen, level, directory.pids[k], NO_START, NO_END);
+    }
+    
+    template <class T>
+    inline void checkStart(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<PartitionPayloads> > &pPayloads, const vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, const vector<PartitionBlocks<vector<T> > > &pTimestamps, const vector<PartitionBlocks<ZoneMap<T> > > &pZones, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<PartitionBlocks<OverlapAggregates> > *pAggregates, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, LocalTimestamp qend)
+    {
+        ZoneMap<T> zone = getZone(pZones, pFrozen, level, pid);
+        
+        if (zone.getMin(0) > qend)
+            return;
+        this->addPartition(pIds, pEndpoints, &pTimestamps, pFrozen, level, pid, NO_START, (zone.getMax(0) <= qend)? NO_END: qend);
+    }
+    
+    template <class T>
+    inline void checkEnd(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<PartitionPayloads> > &pPayloads, const vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, const vector<PartitionBlocks<vector<T> > > &pTimestamps, const vector<PartitionBlocks<ZoneMap<T> > > &pZones, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<PartitionBlocks<OverlapAggregates> > *pAggregates, const vector<FrozenPartitions<T> > &pFrozen, unsigned int level, PartitionId pid, LocalTimestamp qstart)
+    {
+        ZoneMap<T> zone = getZone(pZones, pFrozen, level, pid);
+        
+        if (zone.getMax(ZoneMap<T>::NUM_COMPONENTS-1) < qstart)
+            return;
+        this->addPartition(pIds, pEndpoints, &pTimestamps, pFrozen, level, pid, (zone.getMin(ZoneMap<T>::NUM_COMPONENTS-1) >= qstart)? NO_START: qstart, NO_END);
+    }
+    
+    inline void checkBoth(const vector<PartitionBlocks<LocalRelationId> > &pIds, const vector<PartitionBlocks<RecordId> > &pXors, const vector<PartitionBlocks<PartitionPayloads> > &pPayloads, const vector<PartitionBlocks<PartitionEndpoints> > *pEndpoints, const vector<PartitionBlocks<vector<pair<LocalTimestamp, LocalTimestamp> > > > &pTimestamps, const vector<PartitionBlocks<ZoneMap<pair<LocalTimestamp, LocalTimestamp> > > > &pZones, const vector<PartitionBlocks<uint32_t> > &pSorted, const vector<PartitionBlocks<OverlapAggregates> > *pAggregates, const vector<FrozenPartitions<pair<LocalTimestamp, LocalTimestamp> > > &pFrozen, unsigned int level, PartitionId pid, LocalTimestamp qstart, LocalTimestamp qend)
+    {
+        ZoneMap<pair<LocalTimestamp, LocalTimestamp> > zone = getZone(pZones, pFrozen, level, pid);
+        
+        if ((zone.getMin(0) > qend) || (zone.getMax(1) < qstart))
+            return;
+        this->addPartition(pIds, pEndpoints, &pTimestamps, pFrozen, level, pid, (zone.getMin(1) >= qstart)? NO_START: qstart, (zone.getMax(0) <= qend)? NO_END: qend);
+    }
+};
 
-    ids = move(remainingIds);
-    timestamps = move(remainingTimestamps);
+
+// The cursors report the intervals of the results, which needs the endpoint columns; the runs of the overflow follow those of the index.
+HINT_M_Dynamic::Cursor::Cursor(HINT_M_Dynamic *index, RangeQuery Q, size_t batchSize) : QueryCursor(batchSize), current(0), offset(0)
+{
+    if (!index->keepsEndpoints)
+        throw logic_error("Index keeps no endpoints");
+    for (; index; index = index->overflow.get())
+    {
+        ResultPlanner planner = {index, this->runs};
+        
+        index->traverse(Q, planner);
+    }
 }
 
 
-Relation HINT_M_Dynamic::deleteFossils(Timestamp Tf) {
-    Relation deletedIntervals;
-    unordered_set<int> processedIds;
+HINT_M_Dynamic::Cursor::Cursor(HINT_M_Dynamic *index, StabbingQuery Q, size_t batchSize) : QueryCursor(batchSize), current(0), offset(0)
+{
+    if (!index->keepsEndpoints)
+        throw logic_error("Index keeps no endpoints");
+    for (; index; index = index->overflow.get())
+    {
+        ResultPlanner planner = {index, this->runs};
+        
+        index->traverse(Q, planner);
+    }
+}
 
-    for (int level = 0; level < this->height; ++level) {
-        size_t maxPartitions = max({
-            this->pOrgsInIds[level].size(),
-            this->pOrgsAftIds[level].size(),
-            this->pRepsInIds[level].size(),
-            this->pRepsAftIds[level].size()
-        });
 
-        for (size_t partition = 0; partition < maxPartitions; ++partition) {
-            if (partition < this->pOrgsInIds[level].size()) 
-                deleteFossilsFromPartition(Tf, deletedIntervals, processedIds, this->pOrgsInIds[level][partition], this->pOrgsInTimestamps[level][partition]);
-            if (partition < this->pOrgsAftIds[level].size()) 
-                deleteFossilsFromPartition(Tf, deletedIntervals, processedIds, this->pOrgsAftIds[level][partition], this->pOrgsAftTimestamps[level][partition]);
-            if (partition < this->pRepsInIds[level].size()) 
-                deleteFossilsFromPartition(Tf, deletedIntervals, processedIds, this->pRepsInIds[level][partition], this->pRepsInTimestamps[level][partition]);
-            if (partition < this->pRepsAftIds[level].size()) 
-                deleteFossilsFromPartition(Tf, deletedIntervals, processedIds, this->pRepsAftIds[level][partition], this->pRepsAftTimestamps[level][partition]);
+// Scans the next batchSize entries of the current run, so a batch holds at most batchSize results.
+bool HINT_M_Dynamic::Cursor::fill(vector<QueryResult> &results)
+{
+    for (; this->current < this->runs.size(); this->current++, this->offset = 0)
+    {
+        const Run<vector<QueryResult> > &run = this->runs[this->current];
+        
+        if (this->offset < run.size)
+        {
+            size_t size = min(this->batchSize, run.size-this->offset);
+            
+            run.scan(this->offset, size, results);
+            this->offset += size;
+            
+            return true;
         }
     }
+    
+    return false;
+}
 
-    return deletedIntervals;
+
+QueryCursor* HINT_M_Dynamic::openCursor(RangeQuery Q, size_t batchSize)
+{
+    return new Cursor(this, Q, batchSize);
 }
 
 
-size_t HINT_M_Dynamic::getMemoryUsage() {
-    size_t totalSize = 0;
-    // Memory for pOrgsInIds, related timestamps etc
-    for (const auto& level : pOrgsInIds) {
-        for (const auto& partition : level) 
-            totalSize += partition.size() * sizeof(RecordId); // Memory for RecordIds
-    }
-    for (const auto& level : pOrgsInTimestamps) {
-        for (const auto& partition : level) 
-            totalSize += partition.size() * sizeof(pair<Timestamp, Timestamp>); // Memory for timestamps
+QueryCursor* HINT_M_Dynamic::openCursor(StabbingQuery Q, size_t batchSize)
+{
+    return new Cursor(this, Q, batchSize);
+}
+
+
+// Removes, in place, the fossils of one level of a subdivision (compacted layout and blocks).
+// Partitions before numExpired hold fossils only; their entries go to expire() and the partitions are dropped as a whole.
+// Partitions in [numExpired, numAffected) may hold fossils; isFossil gets the partition, the id and the timestamp entry of each of their entries,
+// the latter is null for a subdivision that keeps ids only. Both get the id itself, offset back by idBase, and the timestamps of the partition. Partitions from numAffected on hold no fossils and are not visited.
+// Entries keep their order, so the remaining part of a sorted body stays sorted; payloads and endpoints, if kept, stay with their entries.
+// Partitions left empty are dropped from the compacted layout and the directory.
+// memoryUsage is updated with the memory given back; partitions are shrunk once down to half.
+template <class T, class Expire, class IsFossil>
+static void deleteFromLevel(RecordId idBase, FrozenPartitions<T> &frozen, PartitionBlocks<LocalRelationId> &pIds, PartitionBlocks<RecordId> &pXors, PartitionBlocks<PartitionPayloads> &pPayloads, PartitionBlocks<PartitionEndpoints> *pEndpoints, PartitionBlocks<vector<T> > *pTimestamps, PartitionBlocks<ZoneMap<T> > *pZones, PartitionBlocks<uint32_t> *pSorted, PartitionDirectory &directory, PartitionId numExpired, PartitionId numAffected, Expire expire, IsFossil isFossil, size_t &memoryUsage) {
+    size_t numRemaining, numNonEmpty = 0, k = 0, numExpiredFrozen = frozen.getOffset(numExpired);
+
+    memoryUsage -= getLevelMemoryUsage(frozen, pIds, pXors, pPayloads, pEndpoints, pTimestamps, pZones, pSorted, directory);
+
+    frozen.visitPartitions(numExpired, [&](PartitionId pid, const LocalRecordId *ids, const T *timestamps, size_t size) {
+        for (size_t i = 0; i < size; ++i)
+            expire(pid, idBase+ids[i], (pTimestamps)? &timestamps[i]: NULL);
+    });
+    frozen.removeIf(numExpired, numAffected, idBase, isFossil);
+
+    for (; (k < directory.pids.size()) && (directory.pids[k] < numExpired); ++k) {
+        PartitionId pid = directory.pids[k];
+        const LocalRelationId &ids = pIds[pid];
+        const vector<T> *timestamps = (pTimestamps)? &(*pTimestamps)[pid]: NULL;
+
+        for (size_t i = 0; i < ids.size(); ++i)
+            expire(pid, idBase+ids[i], (timestamps)? &(*timestamps)[i]: NULL);
+        memoryUsage -= getPartitionMemoryUsage(pIds, pPayloads, pEndpoints, pTimestamps, pid);
     }
-    for (const auto& level : pOrgsAftIds) {
-        for (const auto& partition : level) 
-            totalSize += partition.size() * sizeof(RecordId);
+    if (k > 0) {
+        pIds.release(numExpired);
+        pXors.release(numExpired);
+        pPayloads.release(numExpired);
+        if (pEndpoints)
+            pEndpoints->release(numExpired);
+        if (pTimestamps)
+        {
+            pTimestamps->release(numExpired);
+            pZones->release(numExpired);
+        }
+        if (pSorted)
+            pSorted->release(numExpired);
     }
-    for (const auto& level : pOrgsAftTimestamps) {
-        for (const auto& partition : level)
-            totalSize += partition.size() * sizeof(pair<Timestamp, Timestamp>);
+
+    for (; (k < directory.pids.size()) && (directory.pids[k] < numAffected); ++k) {
+        PartitionId pid = directory.pids[k];
+        LocalRelationId &ids = pIds.touch(pid);
+        vector<T> *timestamps = (pTimestamps)? &pTimestamps->touch(pid): NULL;
+        size_t sortedSize = (pSorted)? (*pSorted)[pid]: 0, numRemainingSorted = 0;
+        RecordId &idsXor = pXors.touch(pid);
+        vector<Payload> *payloads = (!pPayloads[pid].values.empty())? &pPayloads.touch(pid).values: NULL;
+        vector<Timestamp> *starts = ((pEndpoints) && (!(*pEndpoints)[pid].starts.empty()))? &pEndpoints->touch(pid).starts: NULL;
+        vector<Timestamp> *ends = ((pEndpoints) && (!(*pEndpoints)[pid].ends.empty()))? &pEndpoints->touch(pid).ends: NULL;
+
+        memoryUsage -= getPartitionMemoryUsage(pIds, pPayloads, pEndpoints, pTimestamps, pid);
+        numRemaining = 0;
+        for (size_t i = 0; i < ids.size(); ++i) {
+            if (isFossil(pid, idBase+ids[i], (timestamps)? &(*timestamps)[i]: NULL)) {
+                idsXor ^= idBase+ids[i];
+                continue;
+            }
+            ids[numRemaining] = ids[i];
+            if (timestamps)
+                (*timestamps)[numRemaining] = (*timestamps)[i];
+            if (payloads)
+                (*payloads)[numRemaining] = (*payloads)[i];
+            if (starts)
+                (*starts)[numRemaining] = (*starts)[i];
+            if (ends)
+                (*ends)[numRemaining] = (*ends)[i];
+            numRemaining++;
+            if (i < sortedSize)
+                numRemainingSorted++;
+        }
+        ids.resize(numRemaining);
+        if (timestamps)
+            timestamps->resize(numRemaining);
+        if (payloads)
+            payloads->resize(numRemaining);
+        if (starts)
+            starts->resize(numRemaining);
+        if (ends)
+            ends->resize(numRemaining);
+        if (numRemaining <= ids.capacity()/2) {
+            ids.shrink_to_fit();
+            if (timestamps)
+                timestamps->shrink_to_fit();
+            if (payloads)
+                payloads->shrink_to_fit();
+            if (starts)
+                starts->shrink_to_fit();
+            if (ends)
+                ends->shrink_to_fit();
+        }
+        if (payloads)
+            pPayloads.touch(pid).updateAggregate();
+        if (sortedSize > 0)
+            pSorted->touch(pid) = numRemainingSorted;
+        if (timestamps)
+            updateZone(*pTimestamps, *pZones, pid);
+        if (numRemaining > 0)
+            directory.pids[numNonEmpty++] = pid;
+        memoryUsage += getPartitionMemoryUsage(pIds, pPayloads, pEndpoints, pTimestamps, pid);
     }
-    for (const auto& level : pRepsInIds) {
-        for (const auto& partition : level) 
-            totalSize += partition.size() * sizeof(RecordId);
+    directory.pids.erase(directory.pids.begin()+numNonEmpty, directory.pids.begin()+k);
+
+    memoryUsage += getLevelMemoryUsage(frozen, pIds, pXors, pPayloads, pEndpoints, pTimestamps, pZones, pSorted, directory);
+}
+
+
+// Every record has exactly one entry in OrgsIn or OrgsAft, which keeps its start,
+// and exactly one in OrgsIn or RepsIn, which keeps its end.
+// Fossils are found on the latter; the ones spanning several partitions then get their start from OrgsAft and lose their RepsAft replicas.
+// Only the partitions that start before Tf are visited, and the ones that end by Tf are dropped without comparisons.
+// Every fossil is passed to consume() once, when its start is found; returns the number of fossils.
+size_t HINT_M_Dynamic::deleteFossils(Timestamp Tf, const function<void(const Record&)> &consume) {
+    size_t numFossils = 0, numOverflowFossils = 0;
+    unordered_map<RecordId, Timestamp> fossilEnds;  // Fossils found in RepsIn
+
+    if (Tf <= 0)
+        return 0;
+
+    // An overflow left empty is dropped, the next record this index cannot store creates a new one
+    if (this->overflow)
+    {
+        numOverflowFossils = this->overflow->deleteFossils(Tf, consume);
+        if (this->overflow->numIndexedRecords == 0)
+            this->overflow = move(this->overflow->overflow);
     }
-    for (const auto& level : pRepsInTimestamps) {
-        for (const auto& partition : level) 
-            totalSize += partition.size() * sizeof(pair<Timestamp, Timestamp>);
+
+    for (int level = 0; level < this->height; ++level) {
+        auto shift = this->maxBits-this->numBits+level;
+
+        // Partition j of level l covers offsets [j << shift, (j+1) << shift); the first one is affected even if Tf precedes the origin,
+        // and none holds records past the one of gend
+        Timestamp numPartitions = (shift < sizeof(Timestamp)*8-1)? (this->getOffset(this->gend) >> shift)+1: 1;
+        PartitionId numExpired  = (shift < sizeof(Timestamp)*8-1)? PartitionId(min(this->getOffset(Tf) >> shift, numPartitions)): 0;
+        PartitionId numAffected = (shift < sizeof(Timestamp)*8-1)? PartitionId(min(((max<Timestamp>(this->getOffset(Tf), 1)-1) >> shift)+1, numPartitions)): 1;
+        auto emitOrgIn = [&](PartitionId pid, RecordId id, const pair<LocalTimestamp, LocalTimestamp> *timestamp) {
+            Timestamp partitionStart = this->getPartitionStart(level, pid);
+            
+            consume(Record(id, partitionStart+timestamp->first, partitionStart+timestamp->second));
+            numFossils++;
+        };
+        
+        deleteFromLevel(this->idBase, this->pOrgsInFrozen[level], this->pOrgsInIds[level], this->pOrgsInXors[level], this->pOrgsInPayloads[level], NULL, &this->pOrgsInTimestamps[level], &this->pOrgsInZones[level], &this->pOrgsInSorted[level], this->pOrgsInDirectory[level], numExpired, numAffected, emitOrgIn, [&](PartitionId pid, RecordId id, const pair<LocalTimestamp, LocalTimestamp> *timestamp) {
+            if (this->getPartitionStart(level, pid)+timestamp->second >= Tf)
+                return false;
+            emitOrgIn(pid, id, timestamp);
+            return true;
+        }, this->memoryUsage);
+        deleteFromLevel(this->idBase, this->pRepsInFrozen[level], this->pRepsInIds[level], this->pRepsInXors[level], this->pRepsInPayloads[level], &this->pRepsInEndpoints[level], &this->pRepsInEnds[level], &this->pRepsInZones[level], &this->pRepsInSorted[level], this->pRepsInDirectory[level], numExpired, numAffected, [&](PartitionId pid, RecordId id, const LocalTimestamp *end) {
+            fossilEnds[id] = this->getPartitionStart(level, pid)+*end;
+        }, [&](PartitionId pid, RecordId id, const LocalTimestamp *end) {
+            Timestamp t = this->getPartitionStart(level, pid)+*end;
+            
+            if (t >= Tf)
+                return false;
+            fossilEnds[id] = t;
+            return true;
+        }, this->memoryUsage);
     }
-    for (const auto& level : pRepsAftIds) {
-        for (const auto& partition : level)
-            totalSize += partition.size() * sizeof(RecordId);
+    this->numIndexedRecords -= numFossils;
+    this->updateAggregates();
+
+    if (fossilEnds.empty())
+        return numOverflowFossils+numFossils;
+
+    for (int level = 0; level < this->height; ++level) {
+        auto shift = this->maxBits-this->numBits+level;
+
+        // Entries of OrgsAft and RepsAft end after their partition, so fossils lie only in the partitions that end before Tf-1
+        Timestamp numPartitions = (shift < sizeof(Timestamp)*8-1)? (this->getOffset(this->gend) >> shift)+1: 1;
+        PartitionId numAffected = (shift < sizeof(Timestamp)*8-1)? PartitionId(min((max<Timestamp>(this->getOffset(Tf), 1)-1) >> shift, numPartitions)): 0;
+        auto noneExpired = [](PartitionId, RecordId, const LocalTimestamp *) {};
+
+        deleteFromLevel(this->idBase, this->pOrgsAftFrozen[level], this->pOrgsAftIds[level], this->pOrgsAftXors[level], this->pOrgsAftPayloads[level], &this->pOrgsAftEndpoints[level], &this->pOrgsAftStarts[level], &this->pOrgsAftZones[level], &this->pOrgsAftSorted[level], this->pOrgsAftDirectory[level], 0, numAffected, noneExpired, [&](PartitionId pid, RecordId id, const LocalTimestamp *start) {
+            auto iter = fossilEnds.find(id);
+
+            if (iter == fossilEnds.end())
+                return false;
+            consume(Record(id, this->getPartitionStart(level, pid)+*start, iter->second));
+            this->numIndexedRecords--;
+            numFossils++;
+            return true;
+        }, this->memoryUsage);
+        deleteFromLevel<LocalTimestamp>(this->idBase, this->pRepsAftFrozen[level], this->pRepsAftIds[level], this->pRepsAftXors[level], this->pRepsAftPayloads[level], &this->pRepsAftEndpoints[level], NULL, NULL, NULL, this->pRepsAftDirectory[level], 0, numAffected, noneExpired, [&](PartitionId, RecordId id, const LocalTimestamp *) {
+            return (fossilEnds.find(id) != fossilEnds.end());
+        }, this->memoryUsage);
     }
-    for (const auto& level : pRepsAftTimestamps) {
-        for (const auto& partition : level)
-            totalSize += partition.size() * sizeof(pair<Timestamp, Timestamp>);
+
+    return numOverflowFossils+numFossils;
+}
+
+
+// Same, collecting the fossils.
+Relation HINT_M_Dynamic::deleteFossils(Timestamp Tf) {
+    Relation deletedIntervals;
+
+    this->deleteFossils(Tf, [&](const Record &r) {
+        deletedIntervals.push_back(r);
+    });
+
+    return deletedIntervals;
+}
+
+
+// Memory of one subdivision, walking all of its partitions.
+template <class C>
+static size_t computeMemoryUsage(const vector<PartitionBlocks<C> > &levels) {
+    size_t totalSize = getAllocationSize(levels);
+
+    for (const auto& level : levels) {
+        totalSize += level.getMemoryUsage();
+        for (size_t pid = 0; pid < level.size(); pid++)
+            totalSize += getAllocationSize(level[pid]);
     }
+
+    return totalSize;
+}
+
+
+// Sorted body lengths and directories and compacted layouts, which own their memory as a whole.
+template <class L>
+static size_t computeMemoryUsage(const vector<L> &levels) {
+    size_t totalSize = getAllocationSize(levels);
+
+    for (const auto& level : levels)
+        totalSize += level.getMemoryUsage();
+
+    return totalSize;
+}
+
+
+static size_t computeMemoryUsage(const vector<PartitionBlocks<RecordId> > &levels) {
+    return computeMemoryUsage<PartitionBlocks<RecordId> >(levels);
+}
+
+
+static size_t computeMemoryUsage(const vector<PartitionBlocks<uint32_t> > &levels) {
+    return computeMemoryUsage<PartitionBlocks<uint32_t> >(levels);
+}
+
+
+template <class T>
+static size_t computeMemoryUsage(const vector<PartitionBlocks<ZoneMap<T> > > &levels) {
+    return computeMemoryUsage<PartitionBlocks<ZoneMap<T> > >(levels);
+}
+
+
+// Memory of the index from scratch, in O(#partitions); getMemoryUsage() returns the same, kept up to date, plus that of the overflow.
+size_t HINT_M_Dynamic::computeMemoryUsage() const {
+    size_t totalSize = 0;
+
+    // Memory for ids and the endpoints each subdivision keeps
+    totalSize += ::computeMemoryUsage(this->pOrgsInIds);
+    totalSize += ::computeMemoryUsage(this->pOrgsInTimestamps);
+    totalSize += ::computeMemoryUsage(this->pOrgsAftIds);
+    totalSize += ::computeMemoryUsage(this->pOrgsAftStarts);
+    totalSize += ::computeMemoryUsage(this->pRepsInIds);
+    totalSize += ::computeMemoryUsage(this->pRepsInEnds);
+    totalSize += ::computeMemoryUsage(this->pRepsAftIds);
+    totalSize += ::computeMemoryUsage(this->pOrgsInXors);
+    totalSize += ::computeMemoryUsage(this->pOrgsAftXors);
+    totalSize += ::computeMemoryUsage(this->pRepsInXors);
+    totalSize += ::computeMemoryUsage(this->pRepsAftXors);
+    totalSize += ::computeMemoryUsage(this->pOrgsInPayloads);
+    totalSize += ::computeMemoryUsage(this->pOrgsAftPayloads);
+    totalSize += ::computeMemoryUsage(this->pRepsInPayloads);
+    totalSize += ::computeMemoryUsage(this->pRepsAftPayloads);
+    totalSize += ::computeMemoryUsage(this->pOrgsAftEndpoints);
+    totalSize += ::computeMemoryUsage(this->pRepsInEndpoints);
+    totalSize += ::computeMemoryUsage(this->pRepsAftEndpoints);
+    totalSize += ::computeMemoryUsage(this->pOrgsInZones);
+    totalSize += ::computeMemoryUsage(this->pOrgsAftZones);
+    totalSize += ::computeMemoryUsage(this->pRepsInZones);
+    totalSize += ::computeMemoryUsage(this->pOrgsInSorted);
+    totalSize += ::computeMemoryUsage(this->pOrgsAftSorted);
+    totalSize += ::computeMemoryUsage(this->pRepsInSorted);
+    totalSize += ::computeMemoryUsage(this->pOrgsInAggregates);
+    totalSize += ::computeMemoryUsage(this->pOrgsInDirectory);
+    totalSize += ::computeMemoryUsage(this->pOrgsAftDirectory);
+    totalSize += ::computeMemoryUsage(this->pRepsInDirectory);
+    totalSize += ::computeMemoryUsage(this->pRepsAftDirectory);
+
+    // Memory for the compacted partitions
+    totalSize += ::computeMemoryUsage(this->pOrgsInFrozen);
+    totalSize += ::computeMemoryUsage(this->pOrgsAftFrozen);
+    totalSize += ::computeMemoryUsage(this->pRepsInFrozen);
+    totalSize += ::computeMemoryUsage(this->pRepsAftFrozen);
+
     return totalSize;
 }
+
+
+size_t HINT_M_Dynamic::getMemoryUsage() const {
+    return this->memoryUsage+((this->overflow)? sizeof(HINT_M_Dynamic)+this->overflow->getMemoryUsage(): 0);
+}
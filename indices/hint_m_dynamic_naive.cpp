@@ -379,21 +379,13 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
             iterIEnd = this->pRepsInIds[l][a].end();
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                WorkloadAggregator::add(result, (*iterI));
             }
             iterIStart =this->pRepsAftIds[l][a].begin();
             iterIEnd = this->pRepsAftIds[l][a].end();
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                WorkloadAggregator::add(result, (*iterI));
             }
 
             //handle alive intervals in the partition that contains a: both originals and replicas
@@ -401,11 +393,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
             iterIEnd = this->pTmpRepsIds[l][a].end();
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                WorkloadAggregator::add(result, (*iterI));
             }
 
             
@@ -416,21 +404,13 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                 iterIEnd = this->pOrgsInIds[l][j].end();
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
                 iterIStart = this->pOrgsAftIds[l][j].begin();
                 iterIEnd = this->pOrgsAftIds[l][j].end();
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
 
                 // handle the alive Orgs for the rest
@@ -438,11 +418,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                 iterIEnd = this->pTmpOrgsIds[l][j].end();
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
             }
         }
@@ -463,11 +439,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if ((iter->first <= Q.end) && (Q.start <= iter->second))
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -479,11 +451,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -496,11 +464,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }                    
@@ -514,11 +478,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -529,11 +489,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -546,11 +502,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }                    
@@ -564,11 +516,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (Q.start <= iter->second)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -576,22 +524,14 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     iterIEnd = this->pOrgsAftIds[l][a].end();
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
 
                     iterIStart = this->pTmpOrgsIds[l][a].begin();
                     iterIEnd = this->pTmpOrgsIds[l][a].end();
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
 
                 }
@@ -608,11 +548,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (Q.start <= iter->second)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -623,11 +559,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     iterIEnd = this->pOrgsInIds[l][a].end();
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
                 }
                 iterI = this->pOrgsAftIds[l][a].begin();
@@ -635,11 +567,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                 iterEnd = this->pOrgsAftTimestamps[l][a].end();
                 for (iter = iterStart; iter != iterEnd; iter++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                     iterI++;
                 }
 
@@ -649,11 +577,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                 iterEnd = this->pTmpOrgsTimestamps[l][a].end();
                 for (iter = iterStart; iter != iterEnd; iter++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                     iterI++;
                 }                    
             }
@@ -668,11 +592,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                 {
                     if (Q.start <= iter->second)
                     {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
                     iterI++;
                 }
@@ -683,11 +603,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                 iterIEnd = this->pRepsInIds[l][a].end();
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
             }
 
@@ -695,11 +611,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
             iterIEnd = this->pRepsAftIds[l][a].end();
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                WorkloadAggregator::add(result, (*iterI));
             }
 
 
@@ -708,11 +620,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
             iterIEnd = this->pTmpRepsIds[l][a].end();
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                WorkloadAggregator::add(result, (*iterI));
             }
 
             if (a < b)
@@ -726,32 +634,20 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                         iterIEnd = this->pOrgsInIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterIStart = this->pOrgsAftIds[l][j].begin();
                         iterIEnd = this->pOrgsAftIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
 
                         iterIStart = this->pTmpOrgsIds[l][j].begin();
                         iterIEnd = this->pTmpOrgsIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
 
                     }
@@ -764,11 +660,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -781,11 +673,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -798,11 +686,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -816,32 +700,20 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
                         iterIEnd = this->pOrgsInIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterIStart = this->pOrgsAftIds[l][j].begin();
                         iterIEnd = this->pOrgsAftIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         // consider original alive intervals
                         iterIStart = this->pTmpOrgsIds[l][j].begin();
                         iterIEnd = this->pTmpOrgsIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iter++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
 
                     }
@@ -865,22 +737,14 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
         iterIEnd = this->pOrgsInIds[this->numBits][0].end();
         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= (*iterI);
-#endif
+            WorkloadAggregator::add(result, (*iterI));
         }
 
         iterIStart = this->pTmpOrgsIds[this->numBits][0].begin();
         iterIEnd = this->pTmpOrgsIds[this->numBits][0].end();
         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= (*iterI);
-#endif
+            WorkloadAggregator::add(result, (*iterI));
         }
 
     }
@@ -894,11 +758,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
         {
             if ((iter->first <= Q.end) && (Q.start <= iter->second))
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                WorkloadAggregator::add(result, (*iterI));
             }
             iterI++;
         }
@@ -910,11 +770,7 @@ size_t HINT_M_Dynamic_Naive::execute_pureTimeTravel(RangeQuery Q)
         {
             if ((iter->first <= Q.end) && (Q.start <= iter->second))
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                WorkloadAggregator::add(result, (*iterI));
             }
             iterI++;
         }
@@ -398,21 +398,13 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
             iterIEnd = this->pRepsInIds[l][a].end();
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                WorkloadAggregator::add(result, (*iterI));
             }
             iterIStart =this->pRepsAftIds[l][a].begin();
             iterIEnd = this->pRepsAftIds[l][a].end();
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                WorkloadAggregator::add(result, (*iterI));
             }
             
             // Handle rest: consider only originals
@@ -422,21 +414,13 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                 iterIEnd = this->pOrgsInIds[l][j].end();
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
                 iterIStart = this->pOrgsAftIds[l][j].begin();
                 iterIEnd = this->pOrgsAftIds[l][j].end();
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
             }
         }
@@ -457,11 +441,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if ((iter->first <= Q.end) && (Q.start <= iter->second))
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -472,11 +452,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -490,11 +466,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -505,11 +477,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -523,11 +491,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (Q.start <= iter->second)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -535,11 +499,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                     iterIEnd = this->pOrgsAftIds[l][a].end();
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
                 }
             }
@@ -555,11 +515,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (Q.start <= iter->second)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -570,11 +526,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                     iterIEnd = this->pOrgsInIds[l][a].end();
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
                 }
                 iterI = this->pOrgsAftIds[l][a].begin();
@@ -582,11 +534,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                 iterEnd = this->pOrgsAftTimestamps[l][a].end();
                 for (iter = iterStart; iter != iterEnd; iter++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                     iterI++;
                 }
             }
@@ -601,11 +549,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                 {
                     if (Q.start <= iter->second)
                     {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
                     iterI++;
                 }
@@ -616,11 +560,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                 iterIEnd = this->pRepsInIds[l][a].end();
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
             }
 
@@ -628,11 +568,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
             iterIEnd = this->pRepsAftIds[l][a].end();
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                WorkloadAggregator::add(result, (*iterI));
             }
 
             if (a < b)
@@ -646,21 +582,13 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                         iterIEnd = this->pOrgsInIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterIStart = this->pOrgsAftIds[l][j].begin();
                         iterIEnd = this->pOrgsAftIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                     }
 
@@ -672,11 +600,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -687,11 +611,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -704,21 +624,13 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
                         iterIEnd = this->pOrgsInIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterIStart = this->pOrgsAftIds[l][j].begin();
                         iterIEnd = this->pOrgsAftIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                     }
                 }
@@ -741,11 +653,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
         iterIEnd = this->pOrgsInIds[this->numBits][0].end();
         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= (*iterI);
-#endif
+            WorkloadAggregator::add(result, (*iterI));
         }
     }
     else
@@ -758,11 +666,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_pureTimeTravel(RangeQuery Q)
         {
             if ((iter->first <= Q.end) && (Q.start <= iter->second))
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                WorkloadAggregator::add(result, (*iterI));
             }
             iterI++;
         }
@@ -797,11 +701,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
                 if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
                 iterA++;
             }
@@ -811,11 +711,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
                 if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
                 iterA++;
             }
@@ -829,11 +725,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
                     if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
                     iterA++;
                 }
@@ -844,11 +736,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
                     if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
                     iterA++;
                 }
@@ -873,11 +761,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         if ((iter->first <= Q.end) && (Q.start <= iter->second))
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterI++;
@@ -893,11 +777,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterI++;
@@ -915,11 +795,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterI++;
@@ -935,11 +811,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterI++;
@@ -957,11 +829,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         if (Q.start <= iter->second)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterI++;
@@ -974,11 +842,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
                         if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterA++;
                     }
@@ -998,11 +862,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         if (Q.start <= iter->second)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterI++;
@@ -1017,11 +877,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
                         if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterA++;
                     }
@@ -1033,11 +889,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                 for (iter = iterStart; iter != iterEnd; iter++)
                 {
                     if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
                     iterI++;
                     iterA++;
@@ -1056,11 +908,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                     if (Q.start <= iter->second)
                     {
                         if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                     }
                     iterI++;
@@ -1075,11 +923,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
                     if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
                     iterA++;
                 }
@@ -1091,11 +935,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
                 if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
                 iterA++;
             }
@@ -1113,11 +953,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                             iterA++;
                         }
@@ -1127,11 +963,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                             iterA++;
                         }
@@ -1147,11 +979,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterA++;
@@ -1166,11 +994,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterI++;
@@ -1187,11 +1011,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                             iterA++;
                         }
@@ -1201,11 +1021,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                             iterA++;
                         }
@@ -1232,11 +1048,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
         {
             if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                WorkloadAggregator::add(result, (*iterI));
             }
             iterA++;
         }
@@ -1253,11 +1065,7 @@ size_t HINT_M_Dynamic_Second_Attr::execute_rangeTimeTravel(RangeQuery Q, int sec
             if ((iter->first <= Q.end) && (Q.start <= iter->second))
             {
                 if((*iterA) > secondAttrLowerConstraint && (*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
             }
             iterI++;
@@ -1296,11 +1104,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
                 if((*iterA) > secondAttrLowerConstraint){
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
                 iterA++;
             }
@@ -1313,11 +1117,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
                 if((*iterA) > secondAttrLowerConstraint){
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
                 iterA++;
             }
@@ -1332,11 +1132,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
                     if((*iterA) > secondAttrLowerConstraint){
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
                     iterA++;
                 }
@@ -1347,11 +1143,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
                     if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
                     iterA++;
                 }
@@ -1378,11 +1170,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterI++;
@@ -1399,11 +1187,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterI++;
@@ -1422,11 +1206,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterI++;
@@ -1443,11 +1223,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterI++;
@@ -1466,11 +1242,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         if (Q.start <= iter->second)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterI++;
@@ -1484,11 +1256,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
                         if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterA++;
                     }
@@ -1509,11 +1277,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         if (Q.start <= iter->second)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterA++;
@@ -1529,11 +1293,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
                         if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterA++;
                     }
@@ -1547,11 +1307,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                 for (iter = iterStart; iter != iterEnd; iter++)
                 {
                     if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
                     iterA++;
                     iterI++;
@@ -1571,11 +1327,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                     if (Q.start <= iter->second)
                     {
                         if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                     }
                     iterA++;
@@ -1591,11 +1343,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
                     if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
                     iterA++;
                 }
@@ -1608,11 +1356,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
                 if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
                 iterA++;
             }
@@ -1631,11 +1375,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                             iterA++;
                         }
@@ -1647,11 +1387,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                             iterA++;
                         }
@@ -1668,11 +1404,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterI++;
@@ -1687,11 +1419,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterA++;
@@ -1709,11 +1437,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                             iterA++;
                         }
@@ -1725,11 +1449,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                             iterA++;
                         }
@@ -1757,11 +1477,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
         {
             if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                WorkloadAggregator::add(result, (*iterI));
             }
             iterA++;
         }
@@ -1779,11 +1495,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_greaterthan(RangeQuery Q, i
             if ((iter->first <= Q.end) && (Q.start <= iter->second))
             {
                 if((*iterA) > secondAttrLowerConstraint){ 
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
             }
             iterA++;
@@ -1823,11 +1535,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
                 if((*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
                 iterA++;
             }
@@ -1840,11 +1548,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
                 if((*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
                 iterA++;
             }
@@ -1859,11 +1563,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
                     if((*iterA) < secondAttrUpperConstraint){
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
                     iterA++;
                 }
@@ -1874,11 +1574,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
                     if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
                     iterA++;
                 }
@@ -1905,11 +1601,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterI++;
@@ -1926,11 +1618,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterI++;
@@ -1949,11 +1637,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterI++;
@@ -1970,11 +1654,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterI++;
@@ -1993,11 +1673,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         if (Q.start <= iter->second)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterI++;
@@ -2011,11 +1687,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
                         if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterA++;
                     }
@@ -2036,11 +1708,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         if (Q.start <= iter->second)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterA++;
@@ -2056,11 +1724,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
                         if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterA++;
                     }
@@ -2074,11 +1738,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                 for (iter = iterStart; iter != iterEnd; iter++)
                 {
                     if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
                     iterA++;
                     iterI++;
@@ -2098,11 +1758,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                     if (Q.start <= iter->second)
                     {
                         if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                     }
                     iterA++;
@@ -2118,11 +1774,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
                     if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
                     iterA++;
                 }
@@ -2135,11 +1787,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
                 if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
                 iterA++;
             }
@@ -2158,11 +1806,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                             iterA++;
                         }
@@ -2174,11 +1818,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                             iterA++;
                         }
@@ -2195,11 +1835,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterI++;
@@ -2214,11 +1850,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         if (iter->first <= Q.end)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                         }
                         iterA++;
@@ -2236,11 +1868,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                             iterA++;
                         }
@@ -2252,11 +1880,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
                             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                                result++;
-#else
-                                result ^= (*iterI);
-#endif
+                                WorkloadAggregator::add(result, (*iterI));
                             }
                             iterA++;
                         }
@@ -2284,11 +1908,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
         {
             if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                WorkloadAggregator::add(result, (*iterI));
             }
             iterA++;
         }
@@ -2306,11 +1926,7 @@ size_t HINT_M_Dynamic_Second_Attr::executeTimeTravel_lowerthan(RangeQuery Q, int
             if ((iter->first <= Q.end) && (Q.start <= iter->second))
             {
                 if((*iterA) < secondAttrUpperConstraint){ 
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
             }
             iterA++;
@@ -0,0 +1,317 @@
+#include "hint_m_logarithmic.h"
+
+
+
+// Records of the batch that overlap the query, a batch at a time
+class HINT_M_Logarithmic::BatchCursor : public QueryCursor
+{
+private:
+    const Relation &batch;
+    Timestamp qstart, qend;
+    size_t position;
+
+protected:
+    bool fill(vector<QueryResult> &results)
+    {
+        size_t numFound = 0;
+
+        for (; (this->position < this->batch.size()) && (numFound < this->batchSize); this->position++)
+        {
+            const Record &r = this->batch[this->position];
+
+            if ((r.start <= this->qend) && (this->qstart <= r.end))
+            {
+                results.push_back({r.id, r.start, r.end});
+                numFound++;
+            }
+        }
+
+        return (numFound > 0);
+    }
+
+public:
+    BatchCursor(const Relation &batch, Timestamp qstart, Timestamp qend, size_t batchSize) : QueryCursor(batchSize), batch(batch), qstart(qstart), qend(qend), position(0) {};
+};
+
+
+
+HINT_M_Logarithmic::HINT_M_Logarithmic(Timestamp leafPartitionExtent, size_t batchSize, unsigned int numThreads)
+{
+    this->leafPartitionExtent = leafPartitionExtent;
+    this->batchSize           = max<size_t>(batchSize, 1);
+    this->numThreads          = numThreads;
+    this->compressFrozen      = false;
+    this->keepsEndpoints      = false;
+    this->isAnchored          = false;
+    this->batch.reserve(this->batchSize);
+}
+
+
+void HINT_M_Logarithmic::setCompression(bool compress)
+{
+    this->compressFrozen = compress;
+    for (auto &slot : this->slots)
+    {
+        if (slot)
+            slot->setCompression(compress);
+    }
+}
+
+
+// The static indices are bulk-loaded from records alone
+void HINT_M_Logarithmic::enablePayloads()
+{
+    throw logic_error("Logarithmic dead index keeps no payloads");
+}
+
+
+// The batch keeps whole records, the static indices are built with endpoints from then on
+void HINT_M_Logarithmic::enableEndpoints()
+{
+    if (this->getNumIndices() > 0)
+        throw logic_error("Endpoints must be enabled on an empty index");
+    this->keepsEndpoints = true;
+}
+
+
+// Number of static indices
+size_t HINT_M_Logarithmic::getNumIndices() const
+{
+    size_t numIndices = 0;
+
+    for (auto &slot : this->slots)
+    {
+        if (slot)
+            numIndices++;
+    }
+
+    return numIndices;
+}
+
+
+size_t HINT_M_Logarithmic::getMemoryUsage() const
+{
+    size_t memoryUsage = getAllocationSize(this->batch) + getAllocationSize(this->slots);
+
+    for (auto &slot : this->slots)
+    {
+        if (slot)
+            memoryUsage += getAllocationSize(sizeof(HINT_M_Dynamic)) + slot->getMemoryUsage();
+    }
+
+    return memoryUsage;
+}
+
+
+// Static HINT^m of R: bulk-loaded with the partitioning of the dynamic index, then compacted as a whole
+HINT_M_Dynamic* HINT_M_Logarithmic::build(const Relation &R)
+{
+    HINT_M_Dynamic *index = new HINT_M_Dynamic(this->leafPartitionExtent, R, this->numThreads, this->keepsEndpoints);
+
+    index->setCompression(this->compressFrozen);
+    index->freeze(numeric_limits<Timestamp>::max());
+
+    return index;
+}
+
+
+// Indexes the full batch: as in binary addition, the static indices of the occupied slots from 0 on are merged with it
+// into one for the first empty slot. Merging takes the records back out of an index, which all end before the largest timestamp.
+void HINT_M_Logarithmic::carry()
+{
+    Relation R;
+    size_t k = 0;
+
+    R.swap(this->batch);
+    for (; (k < this->slots.size()) && (this->slots[k]); k++)
+    {
+        this->slots[k]->deleteFossils(numeric_limits<Timestamp>::max(), [&](const Record &r) {
+            R.push_back(r);
+        });
+        this->slots[k].reset();
+    }
+    if (k == this->slots.size())
+        this->slots.emplace_back();
+    this->slots[k].reset(this->build(R));
+    this->batch.reserve(this->batchSize);
+}
+
+
+// Calls visit() on the static indices that hold records ending from start on
+template <class Visit>
+inline void HINT_M_Logarithmic::visitIndices(Timestamp start, Visit visit)
+{
+    for (auto &slot : this->slots)
+    {
+        if ((slot) && (start <= slot->gend))
+            visit(slot.get());
+    }
+}
+
+
+template <class A>
+inline void HINT_M_Logarithmic::scanBatch(Timestamp qstart, Timestamp qend, typename A::Result &result)
+{
+    for (const Record &r : this->batch)
+    {
+        if ((r.start <= qend) && (qstart <= r.end))
+            A::add(result, r.id);
+    }
+}
+
+
+template <class A, class Query>
+inline void HINT_M_Logarithmic::query(Query Q, Timestamp start, Timestamp end, typename A::Result &result)
+{
+    this->scanBatch<A>(start, end, result);
+    this->visitIndices(start, [&](HINT_M_Dynamic *index) {
+        index->template execute_pureTimeTravel<A>(Q, result);
+    });
+}
+
+
+void HINT_M_Logarithmic::execute_pureTimeTravel(RangeQuery Q, CountAggregator, size_t &result)
+{
+    this->query<CountAggregator>(Q, Q.start, Q.end, result);
+}
+
+
+void HINT_M_Logarithmic::execute_pureTimeTravel(RangeQuery Q, XorAggregator, size_t &result)
+{
+    this->query<XorAggregator>(Q, Q.start, Q.end, result);
+}
+
+
+void HINT_M_Logarithmic::execute_pureTimeTravel(RangeQuery Q, SumAggregator, size_t &result)
+{
+    this->query<SumAggregator>(Q, Q.start, Q.end, result);
+}
+
+
+void HINT_M_Logarithmic::execute_pureTimeTravel(RangeQuery Q, CollectAggregator, vector<RecordId> &result)
+{
+    this->query<CollectAggregator>(Q, Q.start, Q.end, result);
+}
+
+
+void HINT_M_Logarithmic::execute_pureTimeTravel(StabbingQuery Q, CountAggregator, size_t &result)
+{
+    this->query<CountAggregator>(Q, Q.point, Q.point, result);
+}
+
+
+void HINT_M_Logarithmic::execute_pureTimeTravel(StabbingQuery Q, XorAggregator, size_t &result)
+{
+    this->query<XorAggregator>(Q, Q.point, Q.point, result);
+}
+
+
+void HINT_M_Logarithmic::execute_pureTimeTravel(StabbingQuery Q, SumAggregator, size_t &result)
+{
+    this->query<SumAggregator>(Q, Q.point, Q.point, result);
+}
+
+
+void HINT_M_Logarithmic::execute_pureTimeTravel(StabbingQuery Q, CollectAggregator, vector<RecordId> &result)
+{
+    this->query<CollectAggregator>(Q, Q.point, Q.point, result);
+}
+
+
+void HINT_M_Logarithmic::execute_payloadTimeTravel(RangeQuery Q, PayloadAggregate &result)
+{
+    throw logic_error("Index keeps no payloads");
+}
+
+
+void HINT_M_Logarithmic::execute_payloadTimeTravel(StabbingQuery Q, PayloadAggregate &result)
+{
+    throw logic_error("Index keeps no payloads");
+}
+
+
+// The cursor of the batch, then those of the static indices the query visits
+QueryCursor* HINT_M_Logarithmic::openCursor(RangeQuery Q, size_t batchSize)
+{
+    if (!this->keepsEndpoints)
+        throw logic_error("Index keeps no endpoints");
+
+    ChainedCursor *cursor = new ChainedCursor(batchSize);
+
+    cursor->add(new BatchCursor(this->batch, Q.start, Q.end, batchSize));
+    this->visitIndices(Q.start, [&](HINT_M_Dynamic *index) {
+        cursor->add(index->openCursor(Q, batchSize));
+    });
+
+    return cursor;
+}
+
+
+QueryCursor* HINT_M_Logarithmic::openCursor(StabbingQuery Q, size_t batchSize)
+{
+    if (!this->keepsEndpoints)
+        throw logic_error("Index keeps no endpoints");
+
+    ChainedCursor *cursor = new ChainedCursor(batchSize);
+
+    cursor->add(new BatchCursor(this->batch, Q.point, Q.point, batchSize));
+    this->visitIndices(Q.point, [&](HINT_M_Dynamic *index) {
+        cursor->add(index->openCursor(Q, batchSize));
+    });
+
+    return cursor;
+}
+
+
+// The domain spans the records inserted so far
+void HINT_M_Logarithmic::insert(const Record &r)
+{
+    if (!this->isAnchored)
+    {
+        this->gstart     = r.start;
+        this->gend       = r.end;
+        this->isAnchored = true;
+    }
+    this->gstart = min(this->gstart, r.start);
+    this->gend   = max(this->gend, r.end);
+
+    this->batch.push_back(r);
+    if (this->batch.size() == this->batchSize)
+        this->carry();
+}
+
+
+void HINT_M_Logarithmic::insert(const Record &r, Payload payload)
+{
+    throw logic_error("Index keeps no payloads");
+}
+
+
+// The batch and every static index delete their fossils in place; an index left empty frees its slot.
+size_t HINT_M_Logarithmic::deleteFossils(Timestamp Tf, const function<void(const Record&)> &consume)
+{
+    size_t numFossils = 0, numRemaining = 0;
+
+    for (const Record &r : this->batch)
+    {
+        if (r.end < Tf)
+        {
+            consume(r);
+            numFossils++;
+        }
+        else
+            this->batch[numRemaining++] = r;
+    }
+    this->batch.resize(numRemaining);
+
+    for (auto &slot : this->slots)
+    {
+        if (!slot)
+            continue;
+        numFossils += slot->deleteFossils(Tf, consume);
+        if (slot->getNumRecords() == 0)
+            slot.reset();
+    }
+
+    return numFossils;
+}
@@ -0,0 +1,72 @@
+// Dead index built with the logarithmic method (Bentley-Saxe) from static HINT^m.
+// The ended intervals gather in a batch; a full batch becomes an immutable HINT^m, bulk-loaded and compacted as a whole,
+// and two of the same size are merged into one twice as large.
+
+#ifndef _HINT_M_LOGARITHMIC_H_
+#define _HINT_M_LOGARITHMIC_H_
+
+#include "hint_m.h"
+
+
+
+// Slot i holds a static HINT^m of about batchSize*2^i records, or none; the records of the batch that is filling up are scanned.
+// An insert costs O(log n) amortized rebuilds of its record, and a query visits the batch and the O(log n) static indices
+// it overlaps, each in the sorted and compacted layout of a frozen HINT_M_Dynamic. Deletions remove the fossils in place,
+// so the slots hold at most their size. The static indices keep no payloads.
+class HINT_M_Logarithmic : public DeadIndex
+{
+private:
+    Timestamp leafPartitionExtent;
+    size_t batchSize;
+    Relation batch;                                 // Records not indexed yet, fewer than batchSize
+    vector<unique_ptr<HINT_M_Dynamic> > slots;      // Slot i null while it is empty
+    unsigned int numThreads;                        // For the bulk loads
+    bool compressFrozen;
+    bool keepsEndpoints;
+    bool isAnchored;
+
+    HINT_M_Dynamic* build(const Relation &R);
+    void carry();
+    template <class Visit>
+    inline void visitIndices(Timestamp start, Visit visit);
+    template <class A>
+    inline void scanBatch(Timestamp qstart, Timestamp qend, typename A::Result &result);
+    template <class A, class Query>
+    inline void query(Query Q, Timestamp start, Timestamp end, typename A::Result &result);
+
+    class BatchCursor;
+
+public:
+    HINT_M_Logarithmic(Timestamp leafPartitionExtent, size_t batchSize, unsigned int numThreads = 1);
+    void setCompression(bool compress);
+    void enablePayloads();
+    bool hasPayloads() const { return false; };
+    void enableEndpoints();
+    bool hasEndpoints() const { return this->keepsEndpoints; };
+    size_t getNumIndices() const;
+    size_t getMemoryUsage() const;
+    ~HINT_M_Logarithmic() {};
+
+    // Querying
+    using DeadIndex::execute_pureTimeTravel;
+    void execute_pureTimeTravel(RangeQuery Q, CountAggregator, size_t &result);
+    void execute_pureTimeTravel(RangeQuery Q, XorAggregator, size_t &result);
+    void execute_pureTimeTravel(RangeQuery Q, SumAggregator, size_t &result);
+    void execute_pureTimeTravel(RangeQuery Q, CollectAggregator, vector<RecordId> &result);
+    void execute_pureTimeTravel(StabbingQuery Q, CountAggregator, size_t &result);
+    void execute_pureTimeTravel(StabbingQuery Q, XorAggregator, size_t &result);
+    void execute_pureTimeTravel(StabbingQuery Q, SumAggregator, size_t &result);
+    void execute_pureTimeTravel(StabbingQuery Q, CollectAggregator, vector<RecordId> &result);
+    void execute_payloadTimeTravel(RangeQuery Q, PayloadAggregate &result);
+    void execute_payloadTimeTravel(StabbingQuery Q, PayloadAggregate &result);
+    QueryCursor* openCursor(RangeQuery Q, size_t batchSize);
+    QueryCursor* openCursor(StabbingQuery Q, size_t batchSize);
+
+    // Updating
+    void insert(const Record &r);
+    void insert(const Record &r, Payload payload);
+
+    // Deletion
+    size_t deleteFossils(Timestamp Tf, const function<void(const Record&)> &consume);
+};
+#endif // _HINT_M_LOGARITHMIC_H_
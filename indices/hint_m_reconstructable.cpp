@@ -5,44 +5,72 @@ using namespace std;
 HINT_Reconstructable::HINT_Reconstructable(Timestamp leafPartitionExtent)
     : HINT_M_Dynamic(leafPartitionExtent) {}
 
+HINT_Reconstructable::HINT_Reconstructable(Timestamp leafPartitionExtent, const Relation &R, unsigned int numThreads, bool keepEndpoints)
+    : HINT_M_Dynamic(leafPartitionExtent, R, numThreads, keepEndpoints) {}
+
 bool isFossil(const Record& r, Timestamp Tf) {
     return r.end <= Tf; // Mark as tombstoned if the record's end timestamp is less than or equal to Tf
 }
 
 // Reconstructs the HINT without the fossils.
-void processPartition(vector<int>& ids, vector<pair<Timestamp, Timestamp>>& timestamps, Timestamp Tf, unordered_set<int>& processed, Relation& valid, Relation& fossils) {
-    for (size_t i = 0; i < ids.size(); ++i) {
-        if (processed.count(ids[i])) continue; // Skip processed IDs
-        processed.insert(ids[i]);
+// The start of every record is kept in OrgsIn or OrgsAft and its end in OrgsIn or RepsIn, records spanning partitions are joined on their id.
+// Ids and timestamps come from a hot partition or a piece of a compacted layout, see FrozenPartitions::visit(); they are offsets
+// from idBase and from partitionStart, the start of their partition.
+void processPartition(RecordId idBase, Timestamp partitionStart, const LocalRecordId* ids, const pair<LocalTimestamp, LocalTimestamp>* timestamps, size_t size, Timestamp Tf, Relation& valid, Relation& fossils) {
+    for (size_t i = 0; i < size; ++i) {
+        Record r = {idBase+ids[i], partitionStart+timestamps[i].first, partitionStart+timestamps[i].second};
+
+        (isFossil(r, Tf) ? fossils : valid).push_back(r);
+    }
+}
 
-        Record r = {ids[i], timestamps[i].first, timestamps[i].second};
+void processPartition(RecordId idBase, Timestamp partitionStart, const LocalRecordId* ids, const LocalTimestamp* starts, size_t size, const unordered_map<RecordId, Timestamp>& ends, Timestamp Tf, Relation& valid, Relation& fossils) {
+    for (size_t i = 0; i < size; ++i) {
+        Record r = {idBase+ids[i], partitionStart+starts[i], ends.at(idBase+ids[i])};
 
         (isFossil(r, Tf) ? fossils : valid).push_back(r);
     }
 }
 
+void collectEnds(RecordId idBase, Timestamp partitionStart, const LocalRecordId* ids, const LocalTimestamp* ends, size_t size, unordered_map<RecordId, Timestamp>& recordEnds) {
+    for (size_t i = 0; i < size; ++i)
+        recordEnds[idBase+ids[i]] = partitionStart+ends[i];
+}
+
 Relation HINT_Reconstructable::rebuild(Timestamp Tf) {
     Relation valid, fossils;
-    unordered_set<int> processedIds; // Prevent duplicates
+    unordered_map<RecordId, Timestamp> recordEnds; // Ends of the records spanning partitions
 
-    // Iterate through all partitions and separate intervals
+    // Iterate through all non-empty partitions and separate intervals
+    for (size_t level = 0; level < this->height; ++level) {
+        this->visitPartitions(this->pRepsInIds[level], &this->pRepsInEnds[level], this->pRepsInDirectory[level], this->pRepsInFrozen[level], [&](PartitionId pid, const LocalRecordId* ids, const LocalTimestamp* ends, size_t size) {
+            collectEnds(this->idBase, this->getPartitionStart(level, pid), ids, ends, size, recordEnds);
+        });
+    }
     for (size_t level = 0; level < this->height; ++level) {
-        for (size_t partition = 0; partition < this->pOrgsInIds[level].size(); ++partition) 
-            processPartition(this->pOrgsInIds[level][partition], this->pOrgsInTimestamps[level][partition], Tf, processedIds, valid, fossils);
-        for (size_t partition = 0; partition < this->pOrgsAftIds[level].size(); ++partition) 
-            processPartition(this->pOrgsAftIds[level][partition], this->pOrgsAftTimestamps[level][partition], Tf, processedIds, valid, fossils);
-        for (size_t partition = 0; partition < this->pRepsInIds[level].size(); ++partition) 
-            processPartition(this->pRepsInIds[level][partition], this->pRepsInTimestamps[level][partition], Tf, processedIds, valid, fossils);
-        for (size_t partition = 0; partition < this->pRepsAftIds[level].size(); ++partition) 
-            processPartition(this->pRepsAftIds[level][partition], this->pRepsAftTimestamps[level][partition], Tf, processedIds, valid, fossils);
+        this->visitPartitions(this->pOrgsInIds[level], &this->pOrgsInTimestamps[level], this->pOrgsInDirectory[level], this->pOrgsInFrozen[level], [&](PartitionId pid, const LocalRecordId* ids, const pair<LocalTimestamp, LocalTimestamp>* timestamps, size_t size) {
+            processPartition(this->idBase, this->getPartitionStart(level, pid), ids, timestamps, size, Tf, valid, fossils);
+        });
+        this->visitPartitions(this->pOrgsAftIds[level], &this->pOrgsAftStarts[level], this->pOrgsAftDirectory[level], this->pOrgsAftFrozen[level], [&](PartitionId pid, const LocalRecordId* ids, const LocalTimestamp* starts, size_t size) {
+            processPartition(this->idBase, this->getPartitionStart(level, pid), ids, starts, size, recordEnds, Tf, valid, fossils);
+        });
+    }
+
+    // The overflow drops its fossils in place, those that end before Tf+1
+    if (this->overflow) {
+        this->overflow->deleteFossils((Tf < numeric_limits<Timestamp>::max())? Tf+1: Tf, [&](const Record &r) {
+            fossils.push_back(r);
+        });
     }
 
     // Rebuild the index with valid records
     if (!fossils.empty()) {
-        // Question: There is a contrusctor that takes a relationship as input. But it requires numbits. How do i decide that?
-        HINT_Reconstructable newIndex(this->leafPartitionExtent);
-        for (const auto& record : valid)
-            newIndex.insert(record);
+        // Bulk-loaded with the layout of the incremental index, on the threads of the index if any, keeping endpoints if it does;
+        // the new index may split off an overflow of its own, the old one follows it
+        HINT_Reconstructable newIndex(this->leafPartitionExtent, valid, (this->queryPool)? this->queryPool->getNumThreads(): 1, this->keepsEndpoints);
+        newIndex.appendOverflow(move(this->overflow));
+        newIndex.shareQueryPool(this->queryPool);
+        newIndex.setCompression(this->compressFrozen);
         *this = move(newIndex);
     }
 
@@ -50,53 +78,5 @@ Relation HINT_Reconstructable::rebuild(Timestamp Tf) {
 }
 
 size_t HINT_Reconstructable::getMemoryUsage() const {
-
-    size_t totalSize = 0;
-
-    // Memory for pOrgsInIds and related timestamps
-    for (const auto& level : pOrgsInIds) {
-        for (const auto& partition : level) {
-            totalSize += partition.size() * sizeof(RecordId); // Memory for RecordIds
-        }
-    }
-    for (const auto& level : pOrgsInTimestamps) {
-        for (const auto& partition : level) {
-            totalSize += partition.size() * sizeof(pair<Timestamp, Timestamp>); // Memory for timestamps
-        }
-    }
-
-    // Repeat for pOrgsAft, pRepsIn, pRepsAft
-    for (const auto& level : pOrgsAftIds) {
-        for (const auto& partition : level) {
-            totalSize += partition.size() * sizeof(RecordId);
-        }
-    }
-    for (const auto& level : pOrgsAftTimestamps) {
-        for (const auto& partition : level) {
-            totalSize += partition.size() * sizeof(pair<Timestamp, Timestamp>);
-        }
-    }
-    for (const auto& level : pRepsInIds) {
-        for (const auto& partition : level) {
-            totalSize += partition.size() * sizeof(RecordId);
-        }
-    }
-    for (const auto& level : pRepsInTimestamps) {
-        for (const auto& partition : level) {
-            totalSize += partition.size() * sizeof(pair<Timestamp, Timestamp>);
-        }
-    }
-    for (const auto& level : pRepsAftIds) {
-        for (const auto& partition : level) {
-            totalSize += partition.size() * sizeof(RecordId);
-        }
-    }
-    for (const auto& level : pRepsAftTimestamps) {
-        for (const auto& partition : level) {
-            totalSize += partition.size() * sizeof(pair<Timestamp, Timestamp>);
-        }
-    }
-
-    return totalSize;
+    return HINT_M_Dynamic::getMemoryUsage();
 }
-
@@ -10,6 +10,9 @@
 class HINT_Reconstructable : public HINT_M_Dynamic {
 public:
     HINT_Reconstructable(Timestamp leafPartitionExtent);
+    HINT_Reconstructable(Timestamp leafPartitionExtent, const Relation &R, unsigned int numThreads = 1, bool keepEndpoints = false);
+    HINT_Reconstructable(HINT_Reconstructable &&) = default;
+    HINT_Reconstructable& operator=(HINT_Reconstructable &&) = default;
     Relation rebuild(Timestamp Tf); // Rebuild index without tombstones
     size_t getMemoryUsage() const;
 };
@@ -0,0 +1,333 @@
+#include "hint_m_segmented.h"
+
+
+
+HINT_M_Segmented::HINT_M_Segmented(Timestamp leafPartitionExtent, Timestamp segmentExtent) : crossIndex(leafPartitionExtent)
+{
+    this->leafPartitionExtent = leafPartitionExtent;
+    this->segmentExtent       = segmentExtent;
+    this->firstSegment        = 0;
+    this->numFrozenSegments   = 0;
+    this->isAnchored          = false;
+    this->compressFrozen      = false;
+    this->keepsPayloads       = false;
+    this->keepsEndpoints      = false;
+}
+
+
+void HINT_M_Segmented::setCompression(bool compress)
+{
+    this->compressFrozen = compress;
+    this->crossIndex.setCompression(compress);
+    for (auto &segment : this->segments)
+    {
+        if (segment)
+            segment->setCompression(compress);
+    }
+}
+
+
+void HINT_M_Segmented::enablePayloads()
+{
+    this->crossIndex.enablePayloads();
+    for (auto &segment : this->segments)
+    {
+        if ((segment) && (segment->getNumRecords() > 0))
+            throw logic_error("Payloads must be enabled on an empty index");
+    }
+    this->keepsPayloads = true;
+}
+
+
+void HINT_M_Segmented::enableEndpoints()
+{
+    this->crossIndex.enableEndpoints();
+    for (auto &segment : this->segments)
+    {
+        if ((segment) && (segment->getNumRecords() > 0))
+            throw logic_error("Endpoints must be enabled on an empty index");
+    }
+    this->keepsEndpoints = true;
+}
+
+
+// Number of segments that hold records
+size_t HINT_M_Segmented::getNumSegments() const
+{
+    size_t numSegments = 0;
+
+    for (auto &segment : this->segments)
+    {
+        if (segment)
+            numSegments++;
+    }
+
+    return numSegments;
+}
+
+
+size_t HINT_M_Segmented::getMemoryUsage() const
+{
+    size_t memoryUsage = this->crossIndex.getMemoryUsage() + this->segments.size()*sizeof(unique_ptr<HINT_M_Dynamic>);
+
+    for (auto &segment : this->segments)
+    {
+        if (segment)
+            memoryUsage += getAllocationSize(sizeof(HINT_M_Dynamic)) + segment->getMemoryUsage();
+    }
+
+    return memoryUsage;
+}
+
+
+// Segment of timestamp t, for t from gstart on
+inline int HINT_M_Segmented::getSegment(Timestamp t) const
+{
+    return (t-this->gstart)/this->segmentExtent;
+}
+
+
+// Segment k, created with the settings of the index if it is not there
+HINT_M_Dynamic* HINT_M_Segmented::touchSegment(int k)
+{
+    if (this->segments.empty())
+        this->firstSegment = k;
+    for (; k < this->firstSegment; this->firstSegment--)
+        this->segments.emplace_front();
+    while (k >= this->firstSegment+(int)this->segments.size())
+        this->segments.emplace_back();
+
+    auto &segment = this->segments[k-this->firstSegment];
+
+    if (!segment)
+    {
+        segment.reset(new HINT_M_Dynamic(this->leafPartitionExtent));
+        segment->setCompression(this->compressFrozen);
+        if (this->keepsPayloads)
+            segment->enablePayloads();
+        if (this->keepsEndpoints)
+            segment->enableEndpoints();
+    }
+
+    return segment.get();
+}
+
+
+// Calls visit() on the cross-segment index and on the segments that [start, end] overlaps, skipping the ones that end before start
+template <class Visit>
+inline void HINT_M_Segmented::visitIndices(Timestamp start, Timestamp end, Visit visit)
+{
+    if (start <= this->crossIndex.gend)
+        visit(&this->crossIndex);
+    if ((this->segments.empty()) || (end < this->gstart))
+        return;
+
+    int from = max(this->getSegment(max(start, this->gstart)), this->firstSegment);
+    int to   = min(this->getSegment(end), this->firstSegment+(int)this->segments.size()-1);
+
+    for (int k = from; k <= to; k++)
+    {
+        HINT_M_Dynamic *segment = this->segments[k-this->firstSegment].get();
+
+        if ((segment) && (start <= segment->gend))
+            visit(segment);
+    }
+}
+
+
+template <class A, class Query>
+inline void HINT_M_Segmented::query(Query Q, Timestamp start, Timestamp end, typename A::Result &result)
+{
+    this->visitIndices(start, end, [&](HINT_M_Dynamic *index) {
+        index->template execute_pureTimeTravel<A>(Q, result);
+    });
+}
+
+
+void HINT_M_Segmented::execute_pureTimeTravel(RangeQuery Q, CountAggregator, size_t &result)
+{
+    this->query<CountAggregator>(Q, Q.start, Q.end, result);
+}
+
+
+void HINT_M_Segmented::execute_pureTimeTravel(RangeQuery Q, XorAggregator, size_t &result)
+{
+    this->query<XorAggregator>(Q, Q.start, Q.end, result);
+}
+
+
+void HINT_M_Segmented::execute_pureTimeTravel(RangeQuery Q, SumAggregator, size_t &result)
+{
+    this->query<SumAggregator>(Q, Q.start, Q.end, result);
+}
+
+
+void HINT_M_Segmented::execute_pureTimeTravel(RangeQuery Q, CollectAggregator, vector<RecordId> &result)
+{
+    this->query<CollectAggregator>(Q, Q.start, Q.end, result);
+}
+
+
+void HINT_M_Segmented::execute_pureTimeTravel(StabbingQuery Q, CountAggregator, size_t &result)
+{
+    this->query<CountAggregator>(Q, Q.point, Q.point, result);
+}
+
+
+void HINT_M_Segmented::execute_pureTimeTravel(StabbingQuery Q, XorAggregator, size_t &result)
+{
+    this->query<XorAggregator>(Q, Q.point, Q.point, result);
+}
+
+
+void HINT_M_Segmented::execute_pureTimeTravel(StabbingQuery Q, SumAggregator, size_t &result)
+{
+    this->query<SumAggregator>(Q, Q.point, Q.point, result);
+}
+
+
+void HINT_M_Segmented::execute_pureTimeTravel(StabbingQuery Q, CollectAggregator, vector<RecordId> &result)
+{
+    this->query<CollectAggregator>(Q, Q.point, Q.point, result);
+}
+
+
+void HINT_M_Segmented::execute_payloadTimeTravel(RangeQuery Q, PayloadAggregate &result)
+{
+    if (!this->keepsPayloads)
+        throw logic_error("Index keeps no payloads");
+    this->visitIndices(Q.start, Q.end, [&](HINT_M_Dynamic *index) {
+        index->execute_payloadTimeTravel(Q, result);
+    });
+}
+
+
+void HINT_M_Segmented::execute_payloadTimeTravel(StabbingQuery Q, PayloadAggregate &result)
+{
+    if (!this->keepsPayloads)
+        throw logic_error("Index keeps no payloads");
+    this->visitIndices(Q.point, Q.point, [&](HINT_M_Dynamic *index) {
+        index->execute_payloadTimeTravel(Q, result);
+    });
+}
+
+
+// The cursors of the indices the query visits, one after the other
+QueryCursor* HINT_M_Segmented::openCursor(RangeQuery Q, size_t batchSize)
+{
+    if (!this->keepsEndpoints)
+        throw logic_error("Index keeps no endpoints");
+
+    ChainedCursor *cursor = new ChainedCursor(batchSize);
+
+    this->visitIndices(Q.start, Q.end, [&](HINT_M_Dynamic *index) {
+        cursor->add(index->openCursor(Q, batchSize));
+    });
+
+    return cursor;
+}
+
+
+QueryCursor* HINT_M_Segmented::openCursor(StabbingQuery Q, size_t batchSize)
+{
+    if (!this->keepsEndpoints)
+        throw logic_error("Index keeps no endpoints");
+
+    ChainedCursor *cursor = new ChainedCursor(batchSize);
+
+    this->visitIndices(Q.point, Q.point, [&](HINT_M_Dynamic *index) {
+        cursor->add(index->openCursor(Q, batchSize));
+    });
+
+    return cursor;
+}
+
+
+void HINT_M_Segmented::insert(const Record &r)
+{
+    this->insert(r, 0);
+}
+
+
+// The first record anchors the segments at its start
+void HINT_M_Segmented::insert(const Record &r, Payload payload)
+{
+    if (!this->isAnchored)
+    {
+        this->gstart     = (r.start > 0)? r.start-r.start%this->segmentExtent: 0;
+        this->isAnchored = true;
+    }
+
+    if ((r.start >= this->gstart) && (this->getSegment(r.start) == this->getSegment(r.end)))
+        this->touchSegment(this->getSegment(r.start))->insert(r, payload);
+    else
+        this->crossIndex.insert(r, payload);
+    this->gend = max(this->gend, r.end);
+}
+
+
+// No record inserted from now on starts before t, so the segments that end by t get no more inserts and are compacted as a whole, once;
+// the segment of t and the cross-segment index compact the partitions that end before t.
+void HINT_M_Segmented::freeze(Timestamp t)
+{
+    this->crossIndex.freeze(t);
+    if ((this->segments.empty()) || (t <= this->gstart))
+        return;
+
+    int last = min(this->getSegment(t), this->firstSegment+(int)this->segments.size()-1);
+
+    for (int k = max(this->numFrozenSegments, this->firstSegment); k <= last; k++)
+    {
+        HINT_M_Dynamic *segment = this->segments[k-this->firstSegment].get();
+
+        if (segment)
+            segment->freeze((k < this->getSegment(t))? numeric_limits<Timestamp>::max(): t);
+    }
+    this->numFrozenSegments = max(this->numFrozenSegments, this->getSegment(t));
+}
+
+
+// The segments that end by Tf hold fossils only; they hand over their records and are freed.
+// The segment of Tf and the cross-segment index delete theirs in place.
+size_t HINT_M_Segmented::deleteFossils(Timestamp Tf, const function<void(const Record&)> &consume)
+{
+    size_t numFossils = this->crossIndex.deleteFossils(Tf, consume);
+
+    if (Tf <= this->gstart)
+        return numFossils;
+
+    int k = this->getSegment(Tf);
+
+    for (; (!this->segments.empty()) && (this->firstSegment < k); this->firstSegment++)
+    {
+        if (this->segments.front())
+            numFossils += this->segments.front()->deleteFossils(Tf, consume);
+        this->segments.pop_front();
+    }
+    if ((!this->segments.empty()) && (this->firstSegment == k) && (this->segments.front()))
+        numFossils += this->segments.front()->deleteFossils(Tf, consume);
+
+    return numFossils;
+}
+
+
+// Drops the history that ends before the start of the segment of t: the segments before it are freed as a whole,
+// without visiting their records, and the cross-segment index deletes its records that end before that start.
+// Returns the number of records dropped.
+size_t HINT_M_Segmented::expire(Timestamp t)
+{
+    if (t <= this->gstart)
+        return 0;
+
+    int k = this->getSegment(t);
+    size_t numExpired = this->crossIndex.deleteFossils(this->gstart+k*this->segmentExtent, [](const Record &) {});
+
+    for (; (!this->segments.empty()) && (this->firstSegment < k); this->firstSegment++)
+    {
+        if (this->segments.front())
+            numExpired += this->segments.front()->getNumRecords();
+        this->segments.pop_front();
+    }
+
+    return numExpired;
+}
@@ -0,0 +1,73 @@
+// Time-segmented dead index.
+// A sequence of HINT^m segments of a fixed time span, and a small HINT^m for the records that cross segment boundaries.
+
+#ifndef _HINT_M_SEGMENTED_H_
+#define _HINT_M_SEGMENTED_H_
+
+#include "hint_m.h"
+#include <deque>
+
+
+
+// Segment k holds the records that start and end in [gstart + k*segmentExtent, gstart + (k+1)*segmentExtent), with gstart
+// the first start inserted, aligned down to the segment extent; the records that span several segments, or start before gstart,
+// go to the cross-segment index. A query visits the cross-segment index and only the segments it overlaps.
+// Expiring the history before a time frees whole segments, and a segment is compacted for good on its own
+// once no insert can reach it any more.
+class HINT_M_Segmented : public DeadIndex
+{
+private:
+    Timestamp leafPartitionExtent;
+    Timestamp segmentExtent;
+    deque<unique_ptr<HINT_M_Dynamic> > segments;    // Segment firstSegment+i at i, null while it is empty
+    int firstSegment;
+    int numFrozenSegments;                          // Segments before it are compacted for good
+    HINT_M_Dynamic crossIndex;
+    bool isAnchored;
+    bool compressFrozen;
+    bool keepsPayloads;
+    bool keepsEndpoints;
+
+    inline int getSegment(Timestamp t) const;
+    HINT_M_Dynamic* touchSegment(int k);
+    template <class Visit>
+    inline void visitIndices(Timestamp start, Timestamp end, Visit visit);
+    template <class A, class Query>
+    inline void query(Query Q, Timestamp start, Timestamp end, typename A::Result &result);
+
+public:
+    HINT_M_Segmented(Timestamp leafPartitionExtent, Timestamp segmentExtent);
+    void setCompression(bool compress);
+    void enablePayloads();
+    bool hasPayloads() const { return this->keepsPayloads; };
+    void enableEndpoints();
+    bool hasEndpoints() const { return this->keepsEndpoints; };
+    size_t getNumSegments() const;
+    size_t getMemoryUsage() const;
+    ~HINT_M_Segmented() {};
+
+    // Querying
+    using DeadIndex::execute_pureTimeTravel;
+    void execute_pureTimeTravel(RangeQuery Q, CountAggregator, size_t &result);
+    void execute_pureTimeTravel(RangeQuery Q, XorAggregator, size_t &result);
+    void execute_pureTimeTravel(RangeQuery Q, SumAggregator, size_t &result);
+    void execute_pureTimeTravel(RangeQuery Q, CollectAggregator, vector<RecordId> &result);
+    void execute_pureTimeTravel(StabbingQuery Q, CountAggregator, size_t &result);
+    void execute_pureTimeTravel(StabbingQuery Q, XorAggregator, size_t &result);
+    void execute_pureTimeTravel(StabbingQuery Q, SumAggregator, size_t &result);
+    void execute_pureTimeTravel(StabbingQuery Q, CollectAggregator, vector<RecordId> &result);
+    void execute_payloadTimeTravel(RangeQuery Q, PayloadAggregate &result);
+    void execute_payloadTimeTravel(StabbingQuery Q, PayloadAggregate &result);
+    QueryCursor* openCursor(RangeQuery Q, size_t batchSize);
+    QueryCursor* openCursor(StabbingQuery Q, size_t batchSize);
+
+    // Updating
+    void insert(const Record &r);
+    void insert(const Record &r, Payload payload);
+    void freeze(Timestamp t);
+
+    // Deletion
+    size_t deleteFossils(Timestamp Tf, const function<void(const Record&)> &consume);
+    size_t expire(Timestamp t);
+};
+#endif // _HINT_M_SEGMENTED_H_
@@ -544,21 +544,13 @@ size_t HINT_M_Subs_CM::executeBottomUp_gOverlaps(RangeQuery Q)
             iterIEnd = this->pRepsInIds[l][a].end();
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                WorkloadAggregator::add(result, (*iterI));
             }
             iterIStart =this->pRepsAftIds[l][a].begin();
             iterIEnd = this->pRepsAftIds[l][a].end();
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                WorkloadAggregator::add(result, (*iterI));
             }
             
             // Handle rest: consider only originals
@@ -568,21 +560,13 @@ size_t HINT_M_Subs_CM::executeBottomUp_gOverlaps(RangeQuery Q)
                 iterIEnd = this->pOrgsInIds[l][j].end();
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
                 iterIStart = this->pOrgsAftIds[l][j].begin();
                 iterIEnd = this->pOrgsAftIds[l][j].end();
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
             }
         }
@@ -603,11 +587,7 @@ size_t HINT_M_Subs_CM::executeBottomUp_gOverlaps(RangeQuery Q)
                     {
                         if ((iter->first <= Q.end) && (Q.start <= iter->second))
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -618,11 +598,7 @@ size_t HINT_M_Subs_CM::executeBottomUp_gOverlaps(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -636,11 +612,7 @@ size_t HINT_M_Subs_CM::executeBottomUp_gOverlaps(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -651,11 +623,7 @@ size_t HINT_M_Subs_CM::executeBottomUp_gOverlaps(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -669,11 +637,7 @@ size_t HINT_M_Subs_CM::executeBottomUp_gOverlaps(RangeQuery Q)
                     {
                         if (Q.start <= iter->second)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -681,11 +645,7 @@ size_t HINT_M_Subs_CM::executeBottomUp_gOverlaps(RangeQuery Q)
                     iterIEnd = this->pOrgsAftIds[l][a].end();
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
                 }
             }
@@ -701,11 +661,7 @@ size_t HINT_M_Subs_CM::executeBottomUp_gOverlaps(RangeQuery Q)
                     {
                         if (Q.start <= iter->second)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -716,11 +672,7 @@ size_t HINT_M_Subs_CM::executeBottomUp_gOverlaps(RangeQuery Q)
                     iterIEnd = this->pOrgsInIds[l][a].end();
                     for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                     {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
                 }
                 iterI = this->pOrgsAftIds[l][a].begin();
@@ -728,11 +680,7 @@ size_t HINT_M_Subs_CM::executeBottomUp_gOverlaps(RangeQuery Q)
                 iterEnd = this->pOrgsAftTimestamps[l][a].end();
                 for (iter = iterStart; iter != iterEnd; iter++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                     iterI++;
                 }
             }
@@ -747,11 +695,7 @@ size_t HINT_M_Subs_CM::executeBottomUp_gOverlaps(RangeQuery Q)
                 {
                     if (Q.start <= iter->second)
                     {
-#ifdef WORKLOAD_COUNT
-                        result++;
-#else
-                        result ^= (*iterI);
-#endif
+                        WorkloadAggregator::add(result, (*iterI));
                     }
                     iterI++;
                 }
@@ -762,22 +706,14 @@ size_t HINT_M_Subs_CM::executeBottomUp_gOverlaps(RangeQuery Q)
                 iterIEnd = this->pRepsInIds[l][a].end();
                 for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                 {
-#ifdef WORKLOAD_COUNT
-                    result++;
-#else
-                    result ^= (*iterI);
-#endif
+                    WorkloadAggregator::add(result, (*iterI));
                 }
             }
             iterIStart = this->pRepsAftIds[l][a].begin();
             iterIEnd = this->pRepsAftIds[l][a].end();
             for (iterI = iterIStart; iterI != iterIEnd; iterI++)
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                WorkloadAggregator::add(result, (*iterI));
             }
 
             if (a < b)
@@ -791,21 +727,13 @@ size_t HINT_M_Subs_CM::executeBottomUp_gOverlaps(RangeQuery Q)
                         iterIEnd = this->pOrgsInIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterIStart = this->pOrgsAftIds[l][j].begin();
                         iterIEnd = this->pOrgsAftIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                     }
 
@@ -817,11 +745,7 @@ size_t HINT_M_Subs_CM::executeBottomUp_gOverlaps(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -832,11 +756,7 @@ size_t HINT_M_Subs_CM::executeBottomUp_gOverlaps(RangeQuery Q)
                     {
                         if (iter->first <= Q.end)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterI++;
                     }
@@ -849,21 +769,13 @@ size_t HINT_M_Subs_CM::executeBottomUp_gOverlaps(RangeQuery Q)
                         iterIEnd = this->pOrgsInIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                         iterIStart = this->pOrgsAftIds[l][j].begin();
                         iterIEnd = this->pOrgsAftIds[l][j].end();
                         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
                         {
-#ifdef WORKLOAD_COUNT
-                            result++;
-#else
-                            result ^= (*iterI);
-#endif
+                            WorkloadAggregator::add(result, (*iterI));
                         }
                     }
                 }
@@ -886,11 +798,7 @@ size_t HINT_M_Subs_CM::executeBottomUp_gOverlaps(RangeQuery Q)
         iterIEnd = this->pOrgsInIds[this->numBits][0].end();
         for (iterI = iterIStart; iterI != iterIEnd; iterI++)
         {
-#ifdef WORKLOAD_COUNT
-            result++;
-#else
-            result ^= (*iterI);
-#endif
+            WorkloadAggregator::add(result, (*iterI));
         }
     }
     else
@@ -903,11 +811,7 @@ size_t HINT_M_Subs_CM::executeBottomUp_gOverlaps(RangeQuery Q)
         {
             if ((iter->first <= Q.end) && (Q.start <= iter->second))
             {
-#ifdef WORKLOAD_COUNT
-                result++;
-#else
-                result ^= (*iterI);
-#endif
+                WorkloadAggregator::add(result, (*iterI));
             }
             iterI++;
         }
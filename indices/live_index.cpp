@@ -8,6 +8,7 @@ LiveIndexCapacityConstrainted<T>::LiveIndexCapacityConstrainted(size_t maxCapaci
     this->maxCapacity = maxCapacity;
     this->minCapacity = ceil(this->maxCapacity*0.4);
     this->merged = false;
+    this->memoryUsage = 0;
 
 //    this->buffers.emplace_back(this->maxCapacity);
 //    this->lastBuffer = this->buffers.begin();
@@ -29,11 +30,15 @@ void LiveIndexCapacityConstrainted<T>::insert(RecordId id, Timestamp start)
         this->lastBuffer = (this->buffers.end()-1);
         
         this->lastBufferSize = 0;
+        this->memoryUsage += this->lastBuffer->getMemoryUsage();
 //        cout<<"\tNEW buffer created" << endl;
 //        this->print('r');
     }
+    size_t memoryUsage = this->lastBuffer->getMemoryUsage();
+    
     this->lastBuffer->insert(id, start);
     this->lastBufferSize++;
+    this->memoryUsage += this->lastBuffer->getMemoryUsage()-memoryUsage;
 //    this->latestStart = start;
 //    cout << "\tINSERTED in b" << (this->buffers.size()-1) << ": r" << id << " starting at " << start << endl;
 }
@@ -53,12 +58,16 @@ void LiveIndexCapacityConstrainted<T>::insert_secAttr(RecordId id, Timestamp sta
         this->lastBuffer = (this->buffers.end()-1);
         
         this->lastBufferSize = 0;
+        this->memoryUsage += this->lastBuffer->getMemoryUsage();
 //        cout<<"\tNEW buffer created" << endl;
 //        this->print('r');
     }
+    size_t memoryUsage = this->lastBuffer->getMemoryUsage();
+    
     // this->lastBuffer->insert(id, start);
     this->lastBuffer->insert_secAttr(id, start, secAttr);
     this->lastBufferSize++;
+    this->memoryUsage += this->lastBuffer->getMemoryUsage()-memoryUsage;
 //    this->latestStart = start;
    // cout << "\tINSERTED in b" << (this->buffers.size()-1) << ": r" << id << " starting at " << start << endl;
 }
@@ -72,9 +81,12 @@ Timestamp LiveIndexCapacityConstrainted<T>::remove(RecordId id)
     Timestamp start;
     
 
-    // First locate the buffer that contains the record.
-    if (!merged)
-        bid = id/this->maxCapacity;
+    // First locate the buffer that contains the record; until a merge and as long as the ids are consecutive, buffer i holds
+    // the maxCapacity ids from the i-th after the first one, otherwise the buffer is found among the first ids of the buffers.
+    RecordId guess = (merged)? -1: (id-this->offsets_ids[0])/RecordId(this->maxCapacity);
+    
+    if ((guess >= 0) && (guess < RecordId(this->offsets_ids.size())) && (this->offsets_ids[guess] <= id) && ((guess+1 == RecordId(this->offsets_ids.size())) || (id < this->offsets_ids[guess+1])))
+        bid = guess;
     else
     {
         vector<RecordId>::iterator pivot = lower_bound(this->offsets_ids.begin(), this->offsets_ids.end(), id+1);
@@ -82,8 +94,10 @@ Timestamp LiveIndexCapacityConstrainted<T>::remove(RecordId id)
     }
 
     // Remove record from buffer bid.
+    size_t memoryUsage = this->buffers[bid].getMemoryUsage();
 
     start = this->buffers[bid].remove(id);
+    this->memoryUsage += this->buffers[bid].getMemoryUsage()-memoryUsage;
 
 //     // Merge bid with one of the adjacent buffers if its capacity dropped below the minCapacity threshold.
 //     bsize = this->buffers[bid].getSize();
@@ -127,7 +141,10 @@ Timestamp LiveIndexCapacityConstrainted<T>::remove_secAttr(RecordId id)
     // }
     // Remove record from buffer bid.
     // cout << bid << " " << id << endl;
+    size_t memoryUsage = this->buffers[bid].getMemoryUsage();
+
     start = this->buffers[bid].remove_secAttr(id);
+    this->memoryUsage += this->buffers[bid].getMemoryUsage()-memoryUsage;
     // cout << bid << " " << id << endl;
 
     // Merge bid with one of the adjacent buffers if its capacity dropped below the minCapacity threshold.
@@ -161,6 +178,22 @@ size_t LiveIndexCapacityConstrainted<T>::getNumBuffers()
 
 
 
+// Lower bound on the start of every record that is live or will be inserted from now on:
+// the lowest start of the first non-empty buffer, or of the last buffer as starts arrive in order.
+template <class T>
+Timestamp LiveIndexCapacityConstrainted<T>::getLowestStart()
+{
+    if (this->buffers.empty())
+        return numeric_limits<Timestamp>::min();
+
+    auto b = 0;
+    while ((b < this->buffers.size()-1) && (this->buffers[b].getSize() == 0))
+        b++;
+
+    return this->offsets_starts[b];
+}
+
+
 template <class T>
 void LiveIndexCapacityConstrainted<T>::mergeBuffers(size_t from, size_t to)
 {
@@ -177,6 +210,7 @@ void LiveIndexCapacityConstrainted<T>::mergeBuffers(size_t from, size_t to)
     this->lastBuffer = (this->buffers.end()-1);
     this->lastBufferSize = this->lastBuffer->getSize();
     this->merged = true;
+    this->memoryUsage = this->computeMemoryUsage();
 }
 
 template <class T>
@@ -195,6 +229,7 @@ void LiveIndexCapacityConstrainted<T>::mergeBuffers_secAttr(size_t from, size_t
     this->lastBuffer = (this->buffers.end()-1);
     this->lastBufferSize = this->lastBuffer->getSize();
     this->merged = true;
+    this->memoryUsage = this->computeMemoryUsage();
 }
 
 template <class T>
@@ -283,6 +318,7 @@ void LiveIndexCapacityConstrainted<T>::mergeBuffers()
     this->lastBuffer = (this->buffers.end()-1);
     this->lastBufferSize = this->lastBuffer->getSize();
     this->merged = true;
+    this->memoryUsage = this->computeMemoryUsage();
 }
 
 
@@ -384,6 +420,7 @@ void LiveIndexCapacityConstrainted<T>::reorganize(size_t maxCapacity)
     this->lastBuffer = (this->buffers.end()-1);
     this->lastBufferSize = this->lastBuffer->getSize();
     this->merged = true;
+    this->memoryUsage = this->computeMemoryUsage();
 }
 
 
@@ -447,6 +484,50 @@ void LiveIndexCapacityConstrainted<T>::print(char c)
 }
 
 
+template <class T>
+void LiveIndexCapacityConstrainted<T>::save(SnapshotWriter &writer)
+{
+    writer.write(this->maxCapacity);
+    writer.write(this->minCapacity);
+    writer.write(this->lastBufferSize);
+    writer.write(this->merged);
+    writer.write(this->offsets_starts);
+    writer.write(this->offsets_ids);
+    writer.write(this->buffers.size());
+    for (auto i = 0; i < this->buffers.size(); i++)
+        this->buffers[i].save(writer);
+    this->savePayloads(writer);
+}
+
+
+template <class T>
+void LiveIndexCapacityConstrainted<T>::load(Snapshot &snapshot)
+{
+    if (snapshot.read<size_t>() != this->maxCapacity)
+        throw runtime_error("Snapshot of a live index with another capacity constraint.");
+    this->minCapacity    = snapshot.read<size_t>();
+    this->lastBufferSize = snapshot.read<size_t>();
+    this->merged         = snapshot.read<bool>();
+    snapshot.read(this->offsets_starts);
+    snapshot.read(this->offsets_ids);
+
+    size_t numBuffers = snapshot.read<size_t>();
+
+    for (auto i = 0; i < this->buffers.size(); i++)
+        this->buffers[i].destroy();
+    this->buffers.clear();
+    this->buffers.reserve(numBuffers);
+    for (auto i = 0; i < numBuffers; i++)
+    {
+        this->buffers.emplace_back(this->maxCapacity);
+        this->buffers.back().load(snapshot);
+    }
+    this->lastBuffer = (this->buffers.end()-1);
+    this->memoryUsage = this->computeMemoryUsage();
+    this->loadPayloads(snapshot);
+}
+
+
 template <class T>
 LiveIndexCapacityConstrainted<T>::~LiveIndexCapacityConstrainted()
 {
@@ -456,9 +537,9 @@ LiveIndexCapacityConstrainted<T>::~LiveIndexCapacityConstrainted()
 
 
 template <class T>
-size_t LiveIndexCapacityConstrainted<T>::execute_pureTimeTravel(RangeQuery Q)
+template <class A>
+void LiveIndexCapacityConstrainted<T>::execute_pureTimeTravel(RangeQuery Q, typename A::Result &result)
 {
-    size_t result = 0;
     vector<Timestamp>::iterator iterO    = this->offsets_starts.begin();
     vector<Timestamp>::iterator iterOEnd = lower_bound(iterO, this->offsets_starts.end(), Q.end+1);
     typename vector<T>::iterator iterB   = this->buffers.begin();
@@ -466,20 +547,54 @@ size_t LiveIndexCapacityConstrainted<T>::execute_pureTimeTravel(RangeQuery Q)
 //    size_t cnt = 0;
 
 
+    // No live interval starts by the end of the query, e.g., one that stabs the past
+    if (iterOEnd == iterO)
+        return;
+
     // Comparisons are needed only at the last buffer - contents sorted on start by construction.
     while (iterB != pivot)
     {
-        result ^= iterB->execute_gOverlaps();
+        iterB->template execute_gOverlaps<A>(result);
         iterB++;
 //        cnt++;
     }
 
-    result ^= iterB->execute_gOverlaps(Q);
+    iterB->template execute_gOverlaps<A>(Q, result);
+}
 
 
+template <class T>
+size_t LiveIndexCapacityConstrainted<T>::execute_pureTimeTravel(RangeQuery Q)
+{
+    size_t result = 0;
+
+    this->template execute_pureTimeTravel<WorkloadAggregator>(Q, result);
+
     return result;
 }
 
+template <class T>
+bool LiveIndexCapacityConstrainted<T>::fetch_pureTimeTravel(RangeQuery Q, size_t &position, size_t maxSize, vector<QueryResult> &result)
+{
+    // The buffers of execute_pureTimeTravel(), comparisons only at the last one
+    size_t numBuffers = lower_bound(this->offsets_starts.begin(), this->offsets_starts.end(), Q.end+1) - this->offsets_starts.begin();
+    size_t size = result.size();
+
+
+    if (position >= numBuffers)
+        return false;
+    for (; (position < numBuffers) && (result.size()-size < maxSize); position++)
+    {
+        Timestamp qend = (position < numBuffers-1)? numeric_limits<Timestamp>::max(): Q.end;
+
+        this->buffers[position].visit_gOverlaps(qend, [&](RecordId id, Timestamp start) {
+            result.push_back({id, start, OPEN_END});
+        });
+    }
+
+    return true;
+}
+
 
 template <class T>
 size_t LiveIndexCapacityConstrainted<T>::execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint)
@@ -494,18 +609,10 @@ size_t LiveIndexCapacityConstrainted<T>::execute_rangeTimeTravel(RangeQuery Q, i
     // Comparisons are needed only at the last buffer - contents sorted on start by construction.
     while (iterB != pivot)
     {
-#ifdef WORKLOAD_COUNT
-        result += iterB->executeTimeTravel(secondAttrLowerConstraint, secondAttrUpperConstraint);
-#else
-        result ^= iterB->executeTimeTravel(secondAttrLowerConstraint, secondAttrUpperConstraint);
-#endif
+        WorkloadAggregator::merge(result, iterB->executeTimeTravel(secondAttrLowerConstraint, secondAttrUpperConstraint));
         iterB++;
     }
-#ifdef WORKLOAD_COUNT
-    result += iterB->executeTimeTravel(Q, secondAttrLowerConstraint, secondAttrUpperConstraint);
-#else
-    result ^= iterB->executeTimeTravel(Q, secondAttrLowerConstraint, secondAttrUpperConstraint);
-#endif
+    WorkloadAggregator::merge(result, iterB->executeTimeTravel(Q, secondAttrLowerConstraint, secondAttrUpperConstraint));
     return result;
 }
 
@@ -522,18 +629,10 @@ size_t LiveIndexCapacityConstrainted<T>::executeTimeTravel_greaterthan(RangeQuer
     // Comparisons are needed only at the last buffer - contents sorted on start by construction.
     while (iterB != pivot)
     {
-#ifdef WORKLOAD_COUNT
-        result += iterB->executeTimeTravel_greaterthan(secondAttrLowerConstraint);
-#else
-        result ^= iterB->executeTimeTravel_greaterthan(secondAttrLowerConstraint);
-#endif
+        WorkloadAggregator::merge(result, iterB->executeTimeTravel_greaterthan(secondAttrLowerConstraint));
         iterB++;
     }
-#ifdef WORKLOAD_COUNT
-    result += iterB->executeTimeTravel_greaterthan(Q, secondAttrLowerConstraint);
-#else
-    result ^= iterB->executeTimeTravel_greaterthan(Q, secondAttrLowerConstraint);
-#endif
+    WorkloadAggregator::merge(result, iterB->executeTimeTravel_greaterthan(Q, secondAttrLowerConstraint));
     return result;
 }
 
@@ -550,31 +649,34 @@ size_t LiveIndexCapacityConstrainted<T>::executeTimeTravel_lowerthan(RangeQuery
     // Comparisons are needed only at the last buffer - contents sorted on start by construction.
     while (iterB != pivot)
     {
-#ifdef WORKLOAD_COUNT
-        result += iterB->executeTimeTravel_lowerthan(secondAttrUpperConstraint);
-#else
-        result ^= iterB->executeTimeTravel_lowerthan(secondAttrUpperConstraint);
-#endif
+        WorkloadAggregator::merge(result, iterB->executeTimeTravel_lowerthan(secondAttrUpperConstraint));
         iterB++;
     }
-#ifdef WORKLOAD_COUNT
-    result += iterB->executeTimeTravel_lowerthan(Q, secondAttrUpperConstraint);
-#else
-    result ^= iterB->executeTimeTravel_lowerthan(Q, secondAttrUpperConstraint);
-#endif
+    WorkloadAggregator::merge(result, iterB->executeTimeTravel_lowerthan(Q, secondAttrUpperConstraint));
     return result;
 }
 
+// Memory of the buffers from scratch, used only when buffers are merged.
 template <class T>
-size_t LiveIndexCapacityConstrainted<T>::getMemoryUsage(){
+size_t LiveIndexCapacityConstrainted<T>::computeMemoryUsage(){
     size_t totalSize = 0;
 
     for (auto i = 0; i < this->buffers.size(); i++)
-        totalSize += this->buffers[i].getSize() * sizeof(RecordId); // Assuming `buffer.getSize()` gives the record count in each buffer
+        totalSize += this->buffers[i].getMemoryUsage();
+
+    return totalSize;
+}
+
+
+template <class T>
+size_t LiveIndexCapacityConstrainted<T>::getMemoryUsage(){
+    size_t totalSize = this->memoryUsage;
 
-    // Memory used by offsets
-    totalSize += this->offsets_starts.size() * sizeof(Timestamp);
-    totalSize += this->offsets_ids.size() * sizeof(RecordId);
+    // Memory used by offsets and the buffer objects
+    totalSize += getAllocationSize(this->offsets_starts);
+    totalSize += getAllocationSize(this->offsets_ids);
+    totalSize += getAllocationSize(this->buffers);
+    totalSize += this->getPayloadsMemoryUsage();
 
     return totalSize;
 }
@@ -585,20 +687,18 @@ template <class T>
 LiveIndexDurationConstrainted<T>::LiveIndexDurationConstrainted(Timestamp duration)
 {
     this->duration = duration;
+    this->memoryUsage = 0;
 }
 
 template <class T>
 size_t LiveIndexDurationConstrainted<T>::getMemoryUsage(){
-    size_t totalSize = 0;
-
-    for (auto i = 0; i < this->buffers.size(); i++)
-    {
-        totalSize += this->buffers[i].getSize() * sizeof(RecordId); // Assuming `buffer.getSize()` gives the record count in each buffer
-    }
+    size_t totalSize = this->memoryUsage;
 
-    // Memory used by offsets
-    totalSize += this->offsets_starts.size() * sizeof(Timestamp);
-    totalSize += this->offsets_ids.size() * sizeof(RecordId);
+    // Memory used by offsets and the buffer objects
+    totalSize += getAllocationSize(this->offsets_starts);
+    totalSize += getAllocationSize(this->offsets_ids);
+    totalSize += getAllocationSize(this->buffers);
+    totalSize += this->getPayloadsMemoryUsage();
 
     return totalSize;
 }
@@ -614,13 +714,17 @@ void LiveIndexDurationConstrainted<T>::insert(RecordId id, Timestamp start)
         this->offsets_ids.push_back(id);
         this->buffers.emplace_back();
         
-        auto bid = ceil((float)start/this->duration);  // Id of the buffer to store the id
+        Timestamp bid = start/this->duration + (start%this->duration > 0);  // Id of the buffer to store the id, ceil(start/duration) without rounding start through a float
         this->lastBuffer = (this->buffers.end()-1);
         this->lastBufferEnd = (bid+1)*this->duration - 1;
+        this->memoryUsage += this->lastBuffer->getMemoryUsage();
 //        cout<<"\tNEW buffer created with end = " << lastBufferEnd << endl;
 //        cout << "\tINSERTED in b" << (this->buffers.size()-1) << ": r" << id << " starting at " << start << endl;
     }
+    size_t memoryUsage = this->lastBuffer->getMemoryUsage();
+    
     this->lastBuffer->insert(id, start);
+    this->memoryUsage += this->lastBuffer->getMemoryUsage()-memoryUsage;
 //    cout << "\tINSERTED in b" << (this->buffers.size()-1) << ": r" << id << " starting at " << start << endl;
 }
 
@@ -630,8 +734,11 @@ Timestamp LiveIndexDurationConstrainted<T>::remove(RecordId id)
 {
     vector<RecordId>::iterator pivot = lower_bound(this->offsets_ids.begin(), this->offsets_ids.end(), id+1);
     auto bid = (pivot-1-this->offsets_ids.begin());
+    size_t memoryUsage = this->buffers[bid].getMemoryUsage();
     Timestamp start = this->buffers[bid].remove(id);
     
+    this->memoryUsage += this->buffers[bid].getMemoryUsage()-memoryUsage;
+
 
     return start;
 }
@@ -644,6 +751,20 @@ size_t LiveIndexDurationConstrainted<T>::getNumBuffers()
 }
 
 
+template <class T>
+Timestamp LiveIndexDurationConstrainted<T>::getLowestStart()
+{
+    if (this->buffers.empty())
+        return numeric_limits<Timestamp>::min();
+
+    auto b = 0;
+    while ((b < this->buffers.size()-1) && (this->buffers[b].getSize() == 0))
+        b++;
+
+    return this->offsets_starts[b];
+}
+
+
 template <class T>
 void LiveIndexDurationConstrainted<T>::mergeBuffers()
 {
@@ -677,6 +798,46 @@ void LiveIndexDurationConstrainted<T>::print(char c)
 }
 
 
+template <class T>
+void LiveIndexDurationConstrainted<T>::save(SnapshotWriter &writer)
+{
+    writer.write(this->duration);
+    writer.write(this->lastBufferEnd);
+    writer.write(this->offsets_starts);
+    writer.write(this->offsets_ids);
+    writer.write(this->buffers.size());
+    for (auto i = 0; i < this->buffers.size(); i++)
+        this->buffers[i].save(writer);
+    this->savePayloads(writer);
+}
+
+
+template <class T>
+void LiveIndexDurationConstrainted<T>::load(Snapshot &snapshot)
+{
+    if (snapshot.read<Timestamp>() != this->duration)
+        throw runtime_error("Snapshot of a live index with another duration constraint.");
+    this->lastBufferEnd = snapshot.read<Timestamp>();
+    snapshot.read(this->offsets_starts);
+    snapshot.read(this->offsets_ids);
+
+    size_t numBuffers = snapshot.read<size_t>();
+
+    for (auto i = 0; i < this->buffers.size(); i++)
+        this->buffers[i].destroy();
+    this->buffers.clear();
+    this->buffers.reserve(numBuffers);
+    this->memoryUsage = 0;
+    for (auto i = 0; i < numBuffers; i++)
+    {
+        this->buffers.emplace_back();
+        this->buffers.back().load(snapshot);
+        this->memoryUsage += this->buffers.back().getMemoryUsage();
+    }
+    this->lastBuffer = (this->buffers.end()-1);    this->loadPayloads(snapshot);
+}
+
+
 template <class T>
 LiveIndexDurationConstrainted<T>::~LiveIndexDurationConstrainted()
 {
@@ -686,25 +847,314 @@ LiveIndexDurationConstrainted<T>::~LiveIndexDurationConstrainted()
 
 
 template <class T>
-size_t LiveIndexDurationConstrainted<T>::execute_gOverlaps(RangeQuery Q)
+template <class A>
+void LiveIndexDurationConstrainted<T>::execute_pureTimeTravel(RangeQuery Q, typename A::Result &result)
 {
-    size_t result = 0;
     vector<Timestamp>::iterator iter    = this->offsets_starts.begin();
     vector<Timestamp>::iterator iterEnd = lower_bound(iter, this->offsets_starts.end(), Q.end+1);
     typename vector<T>::iterator iterB  = this->buffers.begin();
     typename vector<T>::iterator pivot = iterB+(iterEnd-iter-1);
 
 
+    // No live interval starts by the end of the query
+    if (iterEnd == iter)
+        return;
+
     // Comparisons are needed only at the last buffer - contents sorted on start by construction.
     while (iterB != pivot)
     {
-        result ^= iterB->execute_gOverlaps();
+        iterB->template execute_gOverlaps<A>(result);
         iterB++;
     }
-    result ^= iterB->execute_gOverlaps(Q);
-    
-    
+    iterB->template execute_gOverlaps<A>(Q, result);
+}
+
+
+template <class T>
+size_t LiveIndexDurationConstrainted<T>::execute_pureTimeTravel(RangeQuery Q)
+{
+    size_t result = 0;
+
+    this->template execute_pureTimeTravel<WorkloadAggregator>(Q, result);
+
     return result;
 }
 
+template <class T>
+bool LiveIndexDurationConstrainted<T>::fetch_pureTimeTravel(RangeQuery Q, size_t &position, size_t maxSize, vector<QueryResult> &result)
+{
+    // The buffers of execute_pureTimeTravel(), comparisons only at the last one
+    size_t numBuffers = lower_bound(this->offsets_starts.begin(), this->offsets_starts.end(), Q.end+1) - this->offsets_starts.begin();
+    size_t size = result.size();
+
+
+    if (position >= numBuffers)
+        return false;
+    for (; (position < numBuffers) && (result.size()-size < maxSize); position++)
+    {
+        Timestamp qend = (position < numBuffers-1)? numeric_limits<Timestamp>::max(): Q.end;
+
+        this->buffers[position].visit_gOverlaps(qend, [&](RecordId id, Timestamp start) {
+            result.push_back({id, start, OPEN_END});
+        });
+    }
 
+    return true;
+}
+
+
+template <class T>
+size_t LiveIndexDurationConstrainted<T>::execute_gOverlaps(RangeQuery Q)
+{
+    return this->execute_pureTimeTravel(Q);
+}
+
+
+// Not a template, yet this file is compiled on its own and included by the drivers: the definitions are inline
+inline LiveIndexFenwick::LiveIndexFenwick()
+{
+    this->numRemoved = 0;
+    this->tree.push_back({0, 0});   // Dummy, the tree is 1-based
+}
+
+
+// Appends the value of a new rank; the node covers (i-lowbit(i), i] so it absorbs the nodes of its children.
+inline void LiveIndexFenwick::append(Node value)
+{
+    size_t i = this->tree.size();
+    size_t lo = i - (i & (~i+1));
+
+    for (size_t j = i-1; j > lo; j -= (j & (~j+1)))
+        value.add(this->tree[j]);
+    this->tree.push_back(value);
+}
+
+
+// A removal adds a count of -1, which wraps around.
+inline void LiveIndexFenwick::update(size_t rank, Node value)
+{
+    size_t n = this->tree.size();
+
+    for (size_t i = rank+1; i < n; i += (i & (~i+1)))
+        this->tree[i].add(value);
+}
+
+
+inline LiveIndexFenwick::Node LiveIndexFenwick::prefix(size_t numRanks)
+{
+    Node result = {0, 0};
+
+    for (size_t i = numRanks; i > 0; i -= (i & (~i+1)))
+        result.add(this->tree[i]);
+
+    return result;
+}
+
+
+// Drops the ranks of removed records and rebuilds the tree bottom-up in linear time.
+inline void LiveIndexFenwick::compact()
+{
+    size_t n = 0;
+
+    for (size_t r = 0; r < this->starts.size(); r++)
+    {
+        if (!this->alive[r])
+            continue;
+
+        this->starts[n] = this->starts[r];
+        this->ids[n] = this->ids[r];
+        this->ranks[this->ids[r]] = n;
+        n++;
+    }
+    this->starts.resize(n);
+    this->ids.resize(n);
+    this->alive.assign(n, true);
+    this->numRemoved = 0;
+
+    this->tree.assign(n+1, {0, 0});
+    for (size_t i = 1; i <= n; i++)
+    {
+        this->tree[i].add({1, this->ids[i-1]});
+        size_t j = i + (i & (~i+1));
+        if (j <= n)
+            this->tree[j].add(this->tree[i]);
+    }
+}
+
+
+inline void LiveIndexFenwick::insert(RecordId id, Timestamp start)
+{
+    this->ranks[id] = this->starts.size();
+    this->starts.push_back(start);
+    this->ids.push_back(id);
+    this->alive.push_back(true);
+    this->append({1, id});
+}
+
+
+inline Timestamp LiveIndexFenwick::remove(RecordId id)
+{
+    auto iter = this->ranks.find(id);
+    size_t rank = iter->second;
+    Timestamp start = this->starts[rank];
+
+    this->ranks.erase(iter);
+    this->alive[rank] = false;
+    this->update(rank, {(size_t)-1, id});
+
+    // Compact once removed ranks dominate, amortized O(1) per removal.
+    this->numRemoved++;
+    if ((this->numRemoved > 1024) && (this->numRemoved > this->ranks.size()))
+        this->compact();
+
+    return start;
+}
+
+
+inline size_t LiveIndexFenwick::getNumBuffers()
+{
+    return 1;
+}
+
+
+inline size_t LiveIndexFenwick::getSize()
+{
+    return this->ranks.size();
+}
+
+
+// Start of the earliest live rank, or of the latest rank if none is live.
+inline Timestamp LiveIndexFenwick::getLowestStart()
+{
+    if (this->starts.empty())
+        return numeric_limits<Timestamp>::min();
+
+    size_t r = 0;
+    while ((r < this->starts.size()-1) && (!this->alive[r]))
+        r++;
+
+    return this->starts[r];
+}
+
+
+inline void LiveIndexFenwick::print(char c)
+{
+    cout << "\tLIVE INDEX:" << endl;
+    cout << "\t\tFenwick tree: " << this->ranks.size() << " live of " << this->starts.size() << " ranks" << endl;
+}
+
+
+inline size_t LiveIndexFenwick::getMemoryUsage()
+{
+    size_t totalSize = 0;
+
+    totalSize += getAllocationSize(this->starts);
+    totalSize += getAllocationSize(this->ids);
+    totalSize += getAllocationSize(this->alive);
+    totalSize += getAllocationSize(this->tree);
+
+    // One node per live record, the next link next to the entry (hashes of integers are not cached), plus the bucket array
+    totalSize += this->ranks.size() * getAllocationSize(sizeof(void*) + sizeof(pair<const RecordId, size_t>));
+    totalSize += getAllocationSize(this->ranks.bucket_count() * sizeof(void*));
+    totalSize += this->getPayloadsMemoryUsage();
+
+    return totalSize;
+}
+
+
+// The ranks of the live records are the only part that is rebuilt, the tree is read back as it is.
+inline void LiveIndexFenwick::save(SnapshotWriter &writer)
+{
+    vector<uint8_t> alive(this->alive.begin(), this->alive.end());
+
+    writer.write(this->numRemoved);
+    writer.write(this->starts);
+    writer.write(this->ids);
+    writer.write(alive);
+    writer.write(this->tree);
+    this->savePayloads(writer);
+}
+
+
+inline void LiveIndexFenwick::load(Snapshot &snapshot)
+{
+    size_t numRanks;
+
+    this->numRemoved = snapshot.read<size_t>();
+    snapshot.read(this->starts);
+    snapshot.read(this->ids);
+
+    const uint8_t *alive = snapshot.view<uint8_t>(numRanks);
+
+    this->alive.assign(alive, alive+numRanks);
+    snapshot.read(this->tree);
+    if ((this->starts.size() != numRanks) || (this->ids.size() != numRanks) || (this->tree.size() != numRanks+1))
+        throw runtime_error("Corrupt snapshot");
+
+    this->ranks.clear();
+    this->ranks.reserve(numRanks-this->numRemoved);
+    for (size_t r = 0; r < numRanks; r++)
+    {
+        if (this->alive[r])
+            this->ranks[this->ids[r]] = r;
+    }
+    this->loadPayloads(snapshot);
+}
+
+
+template <class A>
+void LiveIndexFenwick::report(size_t numRanks, typename A::Result &result, true_type)
+{
+    Node aggregate = this->prefix(numRanks);
+
+    A::addAggregate(result, aggregate.count, aggregate.idsXor);
+}
+
+
+template <class A>
+void LiveIndexFenwick::report(size_t numRanks, typename A::Result &result, false_type)
+{
+    for (size_t r = 0; r < numRanks; r++)
+    {
+        if (this->alive[r])
+            A::add(result, this->ids[r]);
+    }
+}
+
+
+template <class A>
+void LiveIndexFenwick::execute_pureTimeTravel(RangeQuery Q, typename A::Result &result)
+{
+    // Ranks whose start is <= Q.end form a prefix, contents sorted on start by construction.
+    size_t numRanks = upper_bound(this->starts.begin(), this->starts.end(), Q.end) - this->starts.begin();
+
+    this->report<A>(numRanks, result, integral_constant<bool, A::HAS_AGGREGATES>());
+}
+
+
+inline size_t LiveIndexFenwick::execute_pureTimeTravel(RangeQuery Q)
+{
+    size_t result = 0;
+
+    this->execute_pureTimeTravel<WorkloadAggregator>(Q, result);
+
+    return result;
+}
+
+
+inline bool LiveIndexFenwick::fetch_pureTimeTravel(RangeQuery Q, size_t &position, size_t maxSize, vector<QueryResult> &result)
+{
+    size_t numRanks = upper_bound(this->starts.begin(), this->starts.end(), Q.end) - this->starts.begin();
+    size_t size = result.size();
+
+
+    if (position >= numRanks)
+        return false;
+    for (; (position < numRanks) && (result.size()-size < maxSize); position++)
+    {
+        if (this->alive[position])
+            result.push_back({this->ids[position], this->starts[position], OPEN_END});
+    }
+
+    return true;
+}
@@ -3,19 +3,103 @@
 
 #include "../def_global.h"
 #include "../containers/buffer.h"
+#include "../indices/query_cursor.h"
+
+
+
+// The buffers keep ids and starts only, so the payloads of the live records are looked up by id in a table next to them;
+// this policy folds the payload of every result into an aggregate during the scans of the buffers. Records without one are skipped.
+struct PayloadLookupAggregator
+{
+    struct Result
+    {
+        const unordered_map<RecordId, Payload> *payloads;
+        PayloadAggregate aggregate;
+    };
+    static const bool HAS_AGGREGATES = false;
+    static constexpr const char *NAME = "PAYLOAD";
+
+    static inline void add(Result &result, RecordId id)
+    {
+        auto iter = result.payloads->find(id);
+
+        if (iter != result.payloads->end())
+            result.aggregate.add(iter->second);
+    };
+    static inline void addAll(Result &result, const RecordId *ids, size_t size)
+    {
+        for (size_t i = 0; i < size; i++)
+            add(result, ids[i]);
+    };
+    static inline void merge(Result &result, const Result &other) { result.aggregate.merge(other.aggregate); };
+};
 
 
 
 class LiveIndex
 {
+protected:
+    unordered_map<RecordId, Payload> payloads;      // Payload per live record inserted through insert_payload()
+
+    // Memory and checkpointing of the payloads, for the live indices to add to theirs
+    size_t getPayloadsMemoryUsage()
+    {
+        return this->payloads.size() * getAllocationSize(sizeof(void*) + sizeof(pair<const RecordId, Payload>)) + getAllocationSize(this->payloads.bucket_count() * sizeof(void*));
+    };
+    void savePayloads(SnapshotWriter &writer)
+    {
+        vector<RecordId> ids;
+        vector<Payload> payloads;
+
+        ids.reserve(this->payloads.size());
+        payloads.reserve(this->payloads.size());
+        for (const auto &entry : this->payloads)
+        {
+            ids.push_back(entry.first);
+            payloads.push_back(entry.second);
+        }
+        writer.write(ids);
+        writer.write(payloads);
+    };
+    void loadPayloads(Snapshot &snapshot)
+    {
+        vector<RecordId> ids;
+        vector<Payload> payloads;
+
+        snapshot.read(ids);
+        snapshot.read(payloads);
+        if (ids.size() != payloads.size())
+            throw runtime_error("Corrupt snapshot");
+        this->payloads.clear();
+        this->payloads.reserve(ids.size());
+        for (size_t i = 0; i < ids.size(); i++)
+            this->payloads[ids[i]] = payloads[i];
+    };
+
 public:
     LiveIndex() {};
     virtual void insert(RecordId id, Timestamp start) {};
     virtual void insert_secAttr(RecordId id, Timestamp start, int secAttr) {};
     virtual Timestamp remove(RecordId id) {};
     virtual Timestamp remove_secAttr(RecordId id) {};
+    // Same, keeping the payload of the record for the payload queries; remove_payload() hands it back, 0 if the record has none
+    void insert_payload(RecordId id, Timestamp start, Payload payload) { this->insert(id, start); this->payloads[id] = payload; };
+    Timestamp remove_payload(RecordId id, Payload &payload)
+    {
+        auto iter = this->payloads.find(id);
+
+        payload = 0;
+        if (iter != this->payloads.end())
+        {
+            payload = iter->second;
+            this->payloads.erase(iter);
+        }
+
+        return this->remove(id);
+    };
     virtual size_t getNumBuffers() {};
     virtual size_t getSize() {};
+    virtual Timestamp getLowestStart() { return numeric_limits<Timestamp>::min(); };
     virtual void mergeBuffers() {};
     virtual void reorganize(size_t capacity) {};
 //    virtual void removeEmptyBuffers() {};
@@ -23,11 +107,61 @@ public:
     virtual size_t getMemoryUsage() {};
     virtual ~LiveIndex() {};
 
+    // Checkpointing, read back into a live index of the same type and constraint
+    virtual void save(SnapshotWriter &writer) { throw logic_error("Live index does not support snapshots."); };
+    virtual void load(Snapshot &snapshot) { throw logic_error("Live index does not support snapshots."); };
+
     // Querying
     virtual size_t execute_pureTimeTravel(RangeQuery Q) { return 0; };
+    // Only starts are compared in the live tier, so a stabbing query is the range query that ends at the point
+    size_t execute_pureTimeTravel(StabbingQuery Q) { return this->execute_pureTimeTravel(RangeQuery(Q.id, Q.point, Q.point)); };
+    // Same through the aggregation policy A (see def_global.h), adding to result. Virtual functions cannot be templates,
+    // so there is one overload per policy, told apart by a tag; the live indices implement them with a template on the policy.
+    template <class A>
+    void execute_pureTimeTravel(RangeQuery Q, typename A::Result &result) { this->execute_pureTimeTravel(Q, A(), result); };
+    template <class A>
+    void execute_pureTimeTravel(StabbingQuery Q, typename A::Result &result) { this->execute_pureTimeTravel(RangeQuery(Q.id, Q.point, Q.point), A(), result); };
+    virtual void execute_pureTimeTravel(RangeQuery Q, CountAggregator, size_t &result) {};
+    virtual void execute_pureTimeTravel(RangeQuery Q, XorAggregator, size_t &result) {};
+    virtual void execute_pureTimeTravel(RangeQuery Q, SumAggregator, size_t &result) {};
+    virtual void execute_pureTimeTravel(RangeQuery Q, CollectAggregator, vector<RecordId> &result) {};
+    virtual void execute_pureTimeTravel(RangeQuery Q, PayloadLookupAggregator, PayloadLookupAggregator::Result &result) {};
+    // Aggregates the payloads of the results of Q into result
+    void execute_payloadTimeTravel(RangeQuery Q, PayloadAggregate &result)
+    {
+        PayloadLookupAggregator::Result lookup = {&this->payloads, result};
+
+        this->execute_pureTimeTravel(Q, PayloadLookupAggregator(), lookup);
+        result = lookup.aggregate;
+    };
+    void execute_payloadTimeTravel(StabbingQuery Q, PayloadAggregate &result) { this->execute_payloadTimeTravel(RangeQuery(Q.id, Q.point, Q.point), result); };
     virtual size_t execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint) { return 0; };
     virtual size_t executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint) { return 0; };
     virtual size_t executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUpperConstraint) { return 0; };
+
+    // Pulls the results of Q a part at a time, for the cursor below: appends those of the parts from position on
+    // until about maxSize are added, and moves position past them; returns false once there are none left.
+    // A part is a whole buffer, or a single record of the Fenwick tree; position starts at 0.
+    virtual bool fetch_pureTimeTravel(RangeQuery Q, size_t &position, size_t maxSize, vector<QueryResult> &result) { return false; };
+
+    class Cursor;
+};
+
+
+// Cursor over the results of a query in a live index, see QueryCursor
+class LiveIndex::Cursor : public QueryCursor
+{
+private:
+    LiveIndex *index;
+    RangeQuery Q;
+    size_t position;
+
+protected:
+    bool fill(vector<QueryResult> &results) { return this->index->fetch_pureTimeTravel(this->Q, this->position, this->batchSize, results); };
+
+public:
+    Cursor(LiveIndex *index, RangeQuery Q, size_t batchSize = CURSOR_BATCH_SIZE) : QueryCursor(batchSize), index(index), Q(Q), position(0) {};
+    Cursor(LiveIndex *index, StabbingQuery Q, size_t batchSize = CURSOR_BATCH_SIZE) : Cursor(index, RangeQuery(Q.id, Q.point, Q.point), batchSize) {};
 };
 
 
@@ -43,6 +177,9 @@ private:
     typename vector<T>::iterator lastBuffer;
     size_t lastBufferSize;
     bool merged;
+    size_t memoryUsage;                     // Memory of the buffers, kept up to date by every update
+
+    size_t computeMemoryUsage();
 
 public:
     LiveIndexCapacityConstrainted(size_t maxCapacity);
@@ -51,6 +188,7 @@ public:
     Timestamp remove(RecordId id);
     Timestamp remove_secAttr(RecordId id);
     size_t getNumBuffers();
+    Timestamp getLowestStart();
     void mergeBuffers(size_t from, size_t to);
     void mergeBuffers_secAttr(size_t from, size_t to);
     void mergeBuffers();
@@ -58,10 +196,20 @@ public:
 //    void removeEmptyBuffers();
     void print(char c);
     size_t getMemoryUsage();
+    void save(SnapshotWriter &writer);
+    void load(Snapshot &snapshot);
     ~LiveIndexCapacityConstrainted();
 
     // Querying
+    template <class A>
+    void execute_pureTimeTravel(RangeQuery Q, typename A::Result &result);
     size_t execute_pureTimeTravel(RangeQuery Q);
+    void execute_pureTimeTravel(RangeQuery Q, CountAggregator, size_t &result) { this->execute_pureTimeTravel<CountAggregator>(Q, result); };
+    void execute_pureTimeTravel(RangeQuery Q, XorAggregator, size_t &result) { this->execute_pureTimeTravel<XorAggregator>(Q, result); };
+    void execute_pureTimeTravel(RangeQuery Q, SumAggregator, size_t &result) { this->execute_pureTimeTravel<SumAggregator>(Q, result); };
+    void execute_pureTimeTravel(RangeQuery Q, CollectAggregator, vector<RecordId> &result) { this->execute_pureTimeTravel<CollectAggregator>(Q, result); };
+    void execute_pureTimeTravel(RangeQuery Q, PayloadLookupAggregator, PayloadLookupAggregator::Result &result) { this->execute_pureTimeTravel<PayloadLookupAggregator>(Q, result); };
+    bool fetch_pureTimeTravel(RangeQuery Q, size_t &position, size_t maxSize, vector<QueryResult> &result);
     size_t execute_rangeTimeTravel(RangeQuery Q, int secondAttrLowerConstraint, int secondAttrUpperConstraint);
     size_t executeTimeTravel_greaterthan(RangeQuery Q, int secondAttrLowerConstraint);
     size_t executeTimeTravel_lowerthan(RangeQuery Q, int secondAttrUppclearerConstraint);
@@ -85,18 +233,31 @@ private:
     vector<T> buffers;
     typename vector<T>::iterator lastBuffer;
     Timestamp lastBufferEnd;
+    size_t memoryUsage;                     // Memory of the buffers, kept up to date by every update
 
 public:
     LiveIndexDurationConstrainted(Timestamp duration);
     void insert(RecordId id, Timestamp start);
     Timestamp remove(RecordId id);
     size_t getNumBuffers();
+    Timestamp getLowestStart();
     void mergeBuffers();
     void print(char c);
     size_t getMemoryUsage();
+    void save(SnapshotWriter &writer);
+    void load(Snapshot &snapshot);
     ~LiveIndexDurationConstrainted();
 
     // Querying
+    template <class A>
+    void execute_pureTimeTravel(RangeQuery Q, typename A::Result &result);
+    size_t execute_pureTimeTravel(RangeQuery Q);
+    void execute_pureTimeTravel(RangeQuery Q, CountAggregator, size_t &result) { this->execute_pureTimeTravel<CountAggregator>(Q, result); };
+    void execute_pureTimeTravel(RangeQuery Q, XorAggregator, size_t &result) { this->execute_pureTimeTravel<XorAggregator>(Q, result); };
+    void execute_pureTimeTravel(RangeQuery Q, SumAggregator, size_t &result) { this->execute_pureTimeTravel<SumAggregator>(Q, result); };
+    void execute_pureTimeTravel(RangeQuery Q, CollectAggregator, vector<RecordId> &result) { this->execute_pureTimeTravel<CollectAggregator>(Q, result); };
+    void execute_pureTimeTravel(RangeQuery Q, PayloadLookupAggregator, PayloadLookupAggregator::Result &result) { this->execute_pureTimeTravel<PayloadLookupAggregator>(Q, result); };
+    bool fetch_pureTimeTravel(RangeQuery Q, size_t &position, size_t maxSize, vector<QueryResult> &result);
     size_t execute_gOverlaps(RangeQuery Q);
 };
 
@@ -104,4 +265,67 @@ typedef LiveIndexDurationConstrainted<Buffer_Map>    LiveIndexDurationConstraint
 typedef LiveIndexDurationConstrainted<Buffer_Vector> LiveIndexDurationConstraintedVector;
 typedef LiveIndexDurationConstrainted<Buffer_List>   LiveIndexDurationConstraintedList;
 typedef LiveIndexDurationConstrainted<Buffer_ICDE16> LiveIndexDurationConstraintedICDE16;
+
+
+
+// Live index backed by a Fenwick (binary indexed) tree over the arrival rank of the records.
+// Starts arrive in non-decreasing order, so the rank of the last record with start <= Q.end is found by binary search
+// and the aggregate (count and XOR of ids) of all live records up to that rank is a prefix query, O(log n) regardless of buffers.
+// Policies without aggregates visit the live ranks of the prefix instead.
+class LiveIndexFenwick : public LiveIndex
+{
+private:
+    // Number and XOR of the ids of the live records of the ranks a node covers
+    struct Node
+    {
+        size_t count;
+        RecordId idsXor;
+
+        void add(const Node &other)
+        {
+            this->count  += other.count;
+            this->idsXor ^= other.idsXor;
+        };
+    };
+
+    vector<Timestamp> starts;                   // Start per rank, sorted by construction
+    vector<RecordId>  ids;                      // Id per rank: to rebuild the tree on compaction
+    vector<bool>      alive;                    // Liveness per rank
+    vector<Node>      tree;                     // 1-based Fenwick tree over ranks
+    unordered_map<RecordId, size_t> ranks;      // Id to rank of the live records
+    size_t numRemoved;
+
+    void append(Node value);
+    void update(size_t rank, Node value);
+    Node prefix(size_t numRanks);
+    void compact();
+    template <class A>
+    void report(size_t numRanks, typename A::Result &result, true_type);
+    template <class A>
+    void report(size_t numRanks, typename A::Result &result, false_type);
+
+public:
+    LiveIndexFenwick();
+    void insert(RecordId id, Timestamp start);
+    Timestamp remove(RecordId id);
+    size_t getNumBuffers();
+    size_t getSize();
+    Timestamp getLowestStart();
+    void print(char c);
+    size_t getMemoryUsage();
+    void save(SnapshotWriter &writer);
+    void load(Snapshot &snapshot);
+    ~LiveIndexFenwick() {};
+
+    // Querying
+    template <class A>
+    void execute_pureTimeTravel(RangeQuery Q, typename A::Result &result);
+    size_t execute_pureTimeTravel(RangeQuery Q);
+    void execute_pureTimeTravel(RangeQuery Q, CountAggregator, size_t &result) { this->execute_pureTimeTravel<CountAggregator>(Q, result); };
+    void execute_pureTimeTravel(RangeQuery Q, XorAggregator, size_t &result) { this->execute_pureTimeTravel<XorAggregator>(Q, result); };
+    void execute_pureTimeTravel(RangeQuery Q, SumAggregator, size_t &result) { this->execute_pureTimeTravel<SumAggregator>(Q, result); };
+    void execute_pureTimeTravel(RangeQuery Q, CollectAggregator, vector<RecordId> &result) { this->execute_pureTimeTravel<CollectAggregator>(Q, result); };
+    void execute_pureTimeTravel(RangeQuery Q, PayloadLookupAggregator, PayloadLookupAggregator::Result &result) { this->execute_pureTimeTravel<PayloadLookupAggregator>(Q, result); };
+    bool fetch_pureTimeTravel(RangeQuery Q, size_t &position, size_t maxSize, vector<QueryResult> &result);
+};
 #endif // _LIVE_INDEX_H_
@@ -0,0 +1,157 @@
+#ifndef _QUERY_CURSOR_H_
+#define _QUERY_CURSOR_H_
+
+#include "../def_global.h"
+#include <memory>
+
+
+
+// Default number of results a cursor produces per refill
+static const size_t CURSOR_BATCH_SIZE = 1024;
+
+// End of a result that is still alive
+static const Timestamp OPEN_END = numeric_limits<Timestamp>::max();
+
+
+// A result of a query: the id of the record with its interval
+struct QueryResult
+{
+    RecordId id;
+    Timestamp start, end;
+};
+
+
+// Pull-based access to the results of a query, for when only some of them are needed, e.g., LIMIT or EXISTS.
+// The results are produced lazily, a batch of at most about batchSize at a time, so a cursor that is no longer pulled
+// leaves the rest of the index unvisited. The results come in no particular order;
+// the index must not be updated while a cursor on it is open.
+class QueryCursor
+{
+private:
+    vector<QueryResult> batch;
+    size_t position;
+
+protected:
+    size_t batchSize;
+
+    // Appends the next results to results, possibly none; returns false once there are no more
+    virtual bool fill(vector<QueryResult> &results) = 0;
+
+public:
+    QueryCursor(size_t batchSize) : position(0), batchSize(max<size_t>(batchSize, 1)) {};
+    virtual ~QueryCursor() {};
+
+    // Appends up to maxSize further results to results and returns their number, fewer only once the results run out
+    size_t next(vector<QueryResult> &results, size_t maxSize)
+    {
+        size_t numTaken = 0;
+
+        while (numTaken < maxSize)
+        {
+            if (this->position == this->batch.size())
+            {
+                this->batch.clear();
+                this->position = 0;
+                if (!this->fill(this->batch))
+                    break;
+                continue;
+            }
+
+            size_t n = min(maxSize-numTaken, this->batch.size()-this->position);
+
+            results.insert(results.end(), this->batch.begin()+this->position, this->batch.begin()+this->position+n);
+            this->position += n;
+            numTaken += n;
+        }
+
+        return numTaken;
+    }
+
+    size_t next(vector<QueryResult> &results)
+    {
+        return this->next(results, this->batchSize);
+    }
+
+    // Whether there is a further result; on a new cursor, whether the query has any. Stops at the first one found
+    bool exists()
+    {
+        while (this->position == this->batch.size())
+        {
+            this->batch.clear();
+            this->position = 0;
+            if (!this->fill(this->batch))
+                return false;
+        }
+
+        return true;
+    }
+};
+
+
+// The results of several cursors one after the other, e.g., of the tiers of a LIT; owns them
+class ChainedCursor : public QueryCursor
+{
+private:
+    vector<unique_ptr<QueryCursor> > cursors;
+    size_t current;
+
+protected:
+    bool fill(vector<QueryResult> &results)
+    {
+        for (; this->current < this->cursors.size(); this->current++)
+        {
+            if (this->cursors[this->current]->next(results, this->batchSize) > 0)
+                return true;
+        }
+
+        return false;
+    }
+
+public:
+    ChainedCursor(size_t batchSize = CURSOR_BATCH_SIZE) : QueryCursor(batchSize), current(0) {};
+
+    void add(QueryCursor *cursor)
+    {
+        this->cursors.emplace_back(cursor);
+    }
+};
+
+
+// Appends the results of Q in index to results until there are limit of them, through the cursor of the index
+template <class Index, class Query>
+inline void limitQuery(Index *index, Query Q, size_t limit, vector<QueryResult> &results)
+{
+    if (results.size() < limit)
+        typename Index::Cursor(index, Q).next(results, limit-results.size());
+}
+
+
+// For the drivers: adds the results of Q in index to result through the aggregation of the settings,
+// or under a limit appends them to results as above and sets result to their number
+template <class Index, class Query>
+inline void runQuery(const RunSettings &settings, Index *index, Query Q, vector<QueryResult> &results, size_t &result)
+{
+    if (settings.limit > 0)
+    {
+        limitQuery(index, Q, settings.limit, results);
+        result = results.size();
+    }
+    else
+        aggregateQuery(settings.typeAggregation, index, Q, result);
+}
+
+
+// Same, for a payload aggregation of the settings aggregating the payloads of the results into payloads instead,
+// and setting result to the part of them that the aggregation reports
+template <class Index, class Query>
+inline void runQuery(const RunSettings &settings, Index *index, Query Q, vector<QueryResult> &results, PayloadAggregate &payloads, size_t &result)
+{
+    if ((settings.limit == 0) && (isPayloadAggregation(settings.typeAggregation)))
+    {
+        index->execute_payloadTimeTravel(Q, payloads);
+        result = getPayloadResult(settings.typeAggregation, payloads);
+    }
+    else
+        runQuery(settings, index, Q, results, result);
+}
+#endif // _QUERY_CURSOR_H_
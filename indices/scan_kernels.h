@@ -0,0 +1,701 @@
+#ifndef _SCAN_KERNELS_H_
+#define _SCAN_KERNELS_H_
+
+#include "../def_global.h"
+#include <immintrin.h>
+
+
+
+// Kernels over a contiguous run of ids (and (start, end), start or end timestamps) of a HINT subdivision.
+// Each kernel reports the entries that satisfy its comparison through the aggregation policy A (see def_global.h).
+// The AVX2 and AVX-512 variants are compiled for their target regardless of the build flags and are picked at runtime
+// by CPU feature; the scalar variants handle short runs and the tails.
+// The comparisons are vectorized for every policy; COUNT and XOR also report in vector form, the others report the selected lanes one at a time.
+// The ids are 32-bit offsets from idBase (see HINT_M_Dynamic); XOR widens them to 64-bit lanes and adds idBase before folding.
+
+#define SCAN_SIMD_NONE   0
+#define SCAN_SIMD_AVX2   1
+#define SCAN_SIMD_AVX512 2
+
+static inline int detectScanSimdLevel()
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f"))
+        return SCAN_SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2"))
+        return SCAN_SIMD_AVX2;
+
+    return SCAN_SIMD_NONE;
+}
+
+static const int scanSimdLevel = detectScanSimdLevel();
+
+
+
+// Scalar
+template <class A>
+static inline void scan_NoChecks_scalar(RecordId idBase, const LocalRecordId *ids, size_t size, typename A::Result &result)
+{
+    A::addAll(result, idBase, ids, size);
+}
+
+
+template <class A>
+static inline void scan_CheckStart_scalar(RecordId idBase, const LocalRecordId *ids, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qend, typename A::Result &result)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        if (timestamps[i].first <= qend)
+        {
+            A::add(result, idBase+ids[i]);
+        }
+    }
+}
+
+
+template <class A>
+static inline void scan_CheckEnd_scalar(RecordId idBase, const LocalRecordId *ids, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qstart, typename A::Result &result)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        if (qstart <= timestamps[i].second)
+        {
+            A::add(result, idBase+ids[i]);
+        }
+    }
+}
+
+
+template <class A>
+static inline void scan_CheckStart_scalar(RecordId idBase, const LocalRecordId *ids, const LocalTimestamp *starts, size_t size, LocalTimestamp qend, typename A::Result &result)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        if (starts[i] <= qend)
+        {
+            A::add(result, idBase+ids[i]);
+        }
+    }
+}
+
+
+template <class A>
+static inline void scan_CheckEnd_scalar(RecordId idBase, const LocalRecordId *ids, const LocalTimestamp *ends, size_t size, LocalTimestamp qstart, typename A::Result &result)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        if (qstart <= ends[i])
+        {
+            A::add(result, idBase+ids[i]);
+        }
+    }
+}
+
+
+template <class A>
+static inline void scan_CheckBoth_scalar(RecordId idBase, const LocalRecordId *ids, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qstart, LocalTimestamp qend, typename A::Result &result)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        if ((timestamps[i].first <= qend) && (qstart <= timestamps[i].second))
+        {
+            A::add(result, idBase+ids[i]);
+        }
+    }
+}
+
+
+
+// AVX2, 8 entries per iteration
+__attribute__((target("avx2")))
+static inline void loadTimestamps_avx2(const pair<LocalTimestamp, LocalTimestamp> *timestamps, __m256i &starts, __m256i &ends)
+{
+    const __m256i idx = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+    __m256i lo = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)timestamps), idx);
+    __m256i hi = _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)(timestamps+4)), idx);
+
+    starts = _mm256_permute2x128_si256(lo, hi, 0x20);
+    ends   = _mm256_permute2x128_si256(lo, hi, 0x31);
+}
+
+
+// Reports the entries of the 8 ids not flagged in the rejection mask.
+template <class A>
+__attribute__((target("avx2")))
+static inline void report_avx2(RecordId idBase, const LocalRecordId *ids, __m256i rejected, __m256i &acc, typename A::Result &result)
+{
+    for (unsigned int selected = ~_mm256_movemask_ps(_mm256_castsi256_ps(rejected)) & 0xFF; selected; selected &= selected-1)
+        A::add(result, idBase+ids[__builtin_ctz(selected)]);
+}
+
+
+template <>
+__attribute__((target("avx2")))
+inline void report_avx2<CountAggregator>(RecordId idBase, const LocalRecordId *ids, __m256i rejected, __m256i &acc, size_t &result)
+{
+    result += 8-__builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(rejected)));
+}
+
+
+template <>
+__attribute__((target("avx2")))
+inline void report_avx2<XorAggregator>(RecordId idBase, const LocalRecordId *ids, __m256i rejected, __m256i &acc, size_t &result)
+{
+    const __m256i base = _mm256_set1_epi64x(idBase);
+    __m256i offsets = _mm256_loadu_si256((const __m256i*)ids);
+    __m256i lo = _mm256_add_epi64(_mm256_cvtepi32_epi64(_mm256_castsi256_si128(offsets)), base);
+    __m256i hi = _mm256_add_epi64(_mm256_cvtepi32_epi64(_mm256_extracti128_si256(offsets, 1)), base);
+
+    lo  = _mm256_andnot_si256(_mm256_cvtepi32_epi64(_mm256_castsi256_si128(rejected)), lo);
+    hi  = _mm256_andnot_si256(_mm256_cvtepi32_epi64(_mm256_extracti128_si256(rejected, 1)), hi);
+    acc = _mm256_xor_si256(acc, _mm256_xor_si256(lo, hi));
+}
+
+
+// Adds what report_avx2() folded into acc to the result.
+template <class A>
+__attribute__((target("avx2")))
+static inline void fold_avx2(__m256i acc, typename A::Result &result)
+{
+}
+
+
+template <>
+__attribute__((target("avx2")))
+inline void fold_avx2<XorAggregator>(__m256i acc, size_t &result)
+{
+    __m128i x = _mm_xor_si128(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+
+    result ^= (RecordId)(_mm_cvtsi128_si64(x) ^ _mm_extract_epi64(x, 1));
+}
+
+
+// Only XOR has work to do on a run without comparisons.
+__attribute__((target("avx2")))
+static void scan_NoChecks_avx2(RecordId idBase, const LocalRecordId *ids, size_t size, size_t &result)
+{
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for (; i+8 <= size; i += 8)
+        report_avx2<XorAggregator>(idBase, ids+i, _mm256_setzero_si256(), acc, result);
+    fold_avx2<XorAggregator>(acc, result);
+    scan_NoChecks_scalar<XorAggregator>(idBase, ids+i, size-i, result);
+}
+
+
+template <class A>
+__attribute__((target("avx2")))
+static void scan_CheckStart_avx2(RecordId idBase, const LocalRecordId *ids, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qend, typename A::Result &result)
+{
+    const __m256i vqend = _mm256_set1_epi32(qend);
+    __m256i acc = _mm256_setzero_si256(), starts, ends;
+    size_t i = 0;
+
+    for (; i+8 <= size; i += 8)
+    {
+        loadTimestamps_avx2(timestamps+i, starts, ends);
+        report_avx2<A>(idBase, ids+i, _mm256_cmpgt_epi32(starts, vqend), acc, result);
+    }
+    fold_avx2<A>(acc, result);
+    scan_CheckStart_scalar<A>(idBase, ids+i, timestamps+i, size-i, qend, result);
+}
+
+
+template <class A>
+__attribute__((target("avx2")))
+static void scan_CheckEnd_avx2(RecordId idBase, const LocalRecordId *ids, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qstart, typename A::Result &result)
+{
+    const __m256i vqstart = _mm256_set1_epi32(qstart);
+    __m256i acc = _mm256_setzero_si256(), starts, ends;
+    size_t i = 0;
+
+    for (; i+8 <= size; i += 8)
+    {
+        loadTimestamps_avx2(timestamps+i, starts, ends);
+        report_avx2<A>(idBase, ids+i, _mm256_cmpgt_epi32(vqstart, ends), acc, result);
+    }
+    fold_avx2<A>(acc, result);
+    scan_CheckEnd_scalar<A>(idBase, ids+i, timestamps+i, size-i, qstart, result);
+}
+
+
+template <class A>
+__attribute__((target("avx2")))
+static void scan_CheckBoth_avx2(RecordId idBase, const LocalRecordId *ids, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qstart, LocalTimestamp qend, typename A::Result &result)
+{
+    const __m256i vqstart = _mm256_set1_epi32(qstart), vqend = _mm256_set1_epi32(qend);
+    __m256i acc = _mm256_setzero_si256(), starts, ends;
+    size_t i = 0;
+
+    for (; i+8 <= size; i += 8)
+    {
+        loadTimestamps_avx2(timestamps+i, starts, ends);
+        report_avx2<A>(idBase, ids+i, _mm256_or_si256(_mm256_cmpgt_epi32(starts, vqend), _mm256_cmpgt_epi32(vqstart, ends)), acc, result);
+    }
+    fold_avx2<A>(acc, result);
+    scan_CheckBoth_scalar<A>(idBase, ids+i, timestamps+i, size-i, qstart, qend, result);
+}
+
+
+
+template <class A>
+__attribute__((target("avx2")))
+static void scan_CheckStart_avx2(RecordId idBase, const LocalRecordId *ids, const LocalTimestamp *starts, size_t size, LocalTimestamp qend, typename A::Result &result)
+{
+    const __m256i vqend = _mm256_set1_epi32(qend);
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for (; i+8 <= size; i += 8)
+        report_avx2<A>(idBase, ids+i, _mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i*)(starts+i)), vqend), acc, result);
+    fold_avx2<A>(acc, result);
+    scan_CheckStart_scalar<A>(idBase, ids+i, starts+i, size-i, qend, result);
+}
+
+
+template <class A>
+__attribute__((target("avx2")))
+static void scan_CheckEnd_avx2(RecordId idBase, const LocalRecordId *ids, const LocalTimestamp *ends, size_t size, LocalTimestamp qstart, typename A::Result &result)
+{
+    const __m256i vqstart = _mm256_set1_epi32(qstart);
+    __m256i acc = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for (; i+8 <= size; i += 8)
+        report_avx2<A>(idBase, ids+i, _mm256_cmpgt_epi32(vqstart, _mm256_loadu_si256((const __m256i*)(ends+i))), acc, result);
+    fold_avx2<A>(acc, result);
+    scan_CheckEnd_scalar<A>(idBase, ids+i, ends+i, size-i, qstart, result);
+}
+
+
+
+// AVX-512, 16 entries per iteration
+__attribute__((target("avx512f")))
+static inline void loadTimestamps_avx512(const pair<LocalTimestamp, LocalTimestamp> *timestamps, __m512i &starts, __m512i &ends)
+{
+    const __m512i idxStarts = _mm512_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30);
+    const __m512i idxEnds   = _mm512_setr_epi32(1, 3, 5, 7, 9, 11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31);
+    __m512i lo = _mm512_loadu_si512((const void*)timestamps);
+    __m512i hi = _mm512_loadu_si512((const void*)(timestamps+8));
+
+    starts = _mm512_permutex2var_epi32(lo, idxStarts, hi);
+    ends   = _mm512_permutex2var_epi32(lo, idxEnds, hi);
+}
+
+
+// Reports the entries of the 16 ids flagged in the selection mask.
+template <class A>
+__attribute__((target("avx512f")))
+static inline void report_avx512(RecordId idBase, const LocalRecordId *ids, __mmask16 selected, __m512i &acc, typename A::Result &result)
+{
+    for (unsigned int s = selected; s; s &= s-1)
+        A::add(result, idBase+ids[__builtin_ctz(s)]);
+}
+
+
+template <>
+__attribute__((target("avx512f")))
+inline void report_avx512<CountAggregator>(RecordId idBase, const LocalRecordId *ids, __mmask16 selected, __m512i &acc, size_t &result)
+{
+    result += __builtin_popcount(selected);
+}
+
+
+template <>
+__attribute__((target("avx512f")))
+inline void report_avx512<XorAggregator>(RecordId idBase, const LocalRecordId *ids, __mmask16 selected, __m512i &acc, size_t &result)
+{
+    const __m512i base = _mm512_set1_epi64(idBase);
+    __m512i offsets = _mm512_loadu_si512((const void*)ids);
+    __m512i lo = _mm512_add_epi64(_mm512_cvtepi32_epi64(_mm512_castsi512_si256(offsets)), base);
+    __m512i hi = _mm512_add_epi64(_mm512_cvtepi32_epi64(_mm512_extracti64x4_epi64(offsets, 1)), base);
+
+    acc = _mm512_mask_xor_epi64(acc, (__mmask8)selected, acc, lo);
+    acc = _mm512_mask_xor_epi64(acc, (__mmask8)(selected >> 8), acc, hi);
+}
+
+
+template <class A>
+__attribute__((target("avx512f")))
+static inline void fold_avx512(__m512i acc, typename A::Result &result)
+{
+}
+
+
+template <>
+__attribute__((target("avx512f")))
+inline void fold_avx512<XorAggregator>(__m512i acc, size_t &result)
+{
+    fold_avx2<XorAggregator>(_mm256_xor_si256(_mm512_castsi512_si256(acc), _mm512_extracti64x4_epi64(acc, 1)), result);
+}
+
+
+__attribute__((target("avx512f")))
+static void scan_NoChecks_avx512(RecordId idBase, const LocalRecordId *ids, size_t size, size_t &result)
+{
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+
+    for (; i+16 <= size; i += 16)
+        report_avx512<XorAggregator>(idBase, ids+i, 0xFFFF, acc, result);
+    fold_avx512<XorAggregator>(acc, result);
+    scan_NoChecks_scalar<XorAggregator>(idBase, ids+i, size-i, result);
+}
+
+
+template <class A>
+__attribute__((target("avx512f")))
+static void scan_CheckStart_avx512(RecordId idBase, const LocalRecordId *ids, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qend, typename A::Result &result)
+{
+    const __m512i vqend = _mm512_set1_epi32(qend);
+    __m512i acc = _mm512_setzero_si512(), starts, ends;
+    size_t i = 0;
+
+    for (; i+16 <= size; i += 16)
+    {
+        loadTimestamps_avx512(timestamps+i, starts, ends);
+        report_avx512<A>(idBase, ids+i, _mm512_cmple_epi32_mask(starts, vqend), acc, result);
+    }
+    fold_avx512<A>(acc, result);
+    scan_CheckStart_scalar<A>(idBase, ids+i, timestamps+i, size-i, qend, result);
+}
+
+
+template <class A>
+__attribute__((target("avx512f")))
+static void scan_CheckEnd_avx512(RecordId idBase, const LocalRecordId *ids, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qstart, typename A::Result &result)
+{
+    const __m512i vqstart = _mm512_set1_epi32(qstart);
+    __m512i acc = _mm512_setzero_si512(), starts, ends;
+    size_t i = 0;
+
+    for (; i+16 <= size; i += 16)
+    {
+        loadTimestamps_avx512(timestamps+i, starts, ends);
+        report_avx512<A>(idBase, ids+i, _mm512_cmple_epi32_mask(vqstart, ends), acc, result);
+    }
+    fold_avx512<A>(acc, result);
+    scan_CheckEnd_scalar<A>(idBase, ids+i, timestamps+i, size-i, qstart, result);
+}
+
+
+template <class A>
+__attribute__((target("avx512f")))
+static void scan_CheckBoth_avx512(RecordId idBase, const LocalRecordId *ids, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qstart, LocalTimestamp qend, typename A::Result &result)
+{
+    const __m512i vqstart = _mm512_set1_epi32(qstart), vqend = _mm512_set1_epi32(qend);
+    __m512i acc = _mm512_setzero_si512(), starts, ends;
+    size_t i = 0;
+
+    for (; i+16 <= size; i += 16)
+    {
+        loadTimestamps_avx512(timestamps+i, starts, ends);
+        report_avx512<A>(idBase, ids+i, _mm512_cmple_epi32_mask(starts, vqend) & _mm512_cmple_epi32_mask(vqstart, ends), acc, result);
+    }
+    fold_avx512<A>(acc, result);
+    scan_CheckBoth_scalar<A>(idBase, ids+i, timestamps+i, size-i, qstart, qend, result);
+}
+
+
+
+template <class A>
+__attribute__((target("avx512f")))
+static void scan_CheckStart_avx512(RecordId idBase, const LocalRecordId *ids, const LocalTimestamp *starts, size_t size, LocalTimestamp qend, typename A::Result &result)
+{
+    const __m512i vqend = _mm512_set1_epi32(qend);
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+
+    for (; i+16 <= size; i += 16)
+        report_avx512<A>(idBase, ids+i, _mm512_cmple_epi32_mask(_mm512_loadu_si512((const void*)(starts+i)), vqend), acc, result);
+    fold_avx512<A>(acc, result);
+    scan_CheckStart_scalar<A>(idBase, ids+i, starts+i, size-i, qend, result);
+}
+
+
+template <class A>
+__attribute__((target("avx512f")))
+static void scan_CheckEnd_avx512(RecordId idBase, const LocalRecordId *ids, const LocalTimestamp *ends, size_t size, LocalTimestamp qstart, typename A::Result &result)
+{
+    const __m512i vqstart = _mm512_set1_epi32(qstart);
+    __m512i acc = _mm512_setzero_si512();
+    size_t i = 0;
+
+    for (; i+16 <= size; i += 16)
+        report_avx512<A>(idBase, ids+i, _mm512_cmple_epi32_mask(vqstart, _mm512_loadu_si512((const void*)(ends+i))), acc, result);
+    fold_avx512<A>(acc, result);
+    scan_CheckEnd_scalar<A>(idBase, ids+i, ends+i, size-i, qstart, result);
+}
+
+
+
+// Dispatchers, runs shorter than one vector stay scalar
+template <class A>
+static inline void scan_NoChecks(RecordId idBase, const LocalRecordId *ids, size_t size, typename A::Result &result)
+{
+    scan_NoChecks_scalar<A>(idBase, ids, size, result);
+}
+
+
+template <>
+inline void scan_NoChecks<XorAggregator>(RecordId idBase, const LocalRecordId *ids, size_t size, size_t &result)
+{
+    if ((scanSimdLevel == SCAN_SIMD_AVX512) && (size >= 16))
+        scan_NoChecks_avx512(idBase, ids, size, result);
+    else if ((scanSimdLevel != SCAN_SIMD_NONE) && (size >= 8))
+        scan_NoChecks_avx2(idBase, ids, size, result);
+    else
+        scan_NoChecks_scalar<XorAggregator>(idBase, ids, size, result);
+}
+
+
+template <class A>
+static inline void scan_CheckStart(RecordId idBase, const LocalRecordId *ids, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qend, typename A::Result &result)
+{
+    if ((scanSimdLevel == SCAN_SIMD_AVX512) && (size >= 16))
+        scan_CheckStart_avx512<A>(idBase, ids, timestamps, size, qend, result);
+    else if ((scanSimdLevel != SCAN_SIMD_NONE) && (size >= 8))
+        scan_CheckStart_avx2<A>(idBase, ids, timestamps, size, qend, result);
+    else
+        scan_CheckStart_scalar<A>(idBase, ids, timestamps, size, qend, result);
+}
+
+
+template <class A>
+static inline void scan_CheckEnd(RecordId idBase, const LocalRecordId *ids, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qstart, typename A::Result &result)
+{
+    if ((scanSimdLevel == SCAN_SIMD_AVX512) && (size >= 16))
+        scan_CheckEnd_avx512<A>(idBase, ids, timestamps, size, qstart, result);
+    else if ((scanSimdLevel != SCAN_SIMD_NONE) && (size >= 8))
+        scan_CheckEnd_avx2<A>(idBase, ids, timestamps, size, qstart, result);
+    else
+        scan_CheckEnd_scalar<A>(idBase, ids, timestamps, size, qstart, result);
+}
+
+
+template <class A>
+static inline void scan_CheckStart(RecordId idBase, const LocalRecordId *ids, const LocalTimestamp *starts, size_t size, LocalTimestamp qend, typename A::Result &result)
+{
+    if ((scanSimdLevel == SCAN_SIMD_AVX512) && (size >= 16))
+        scan_CheckStart_avx512<A>(idBase, ids, starts, size, qend, result);
+    else if ((scanSimdLevel != SCAN_SIMD_NONE) && (size >= 8))
+        scan_CheckStart_avx2<A>(idBase, ids, starts, size, qend, result);
+    else
+        scan_CheckStart_scalar<A>(idBase, ids, starts, size, qend, result);
+}
+
+
+template <class A>
+static inline void scan_CheckEnd(RecordId idBase, const LocalRecordId *ids, const LocalTimestamp *ends, size_t size, LocalTimestamp qstart, typename A::Result &result)
+{
+    if ((scanSimdLevel == SCAN_SIMD_AVX512) && (size >= 16))
+        scan_CheckEnd_avx512<A>(idBase, ids, ends, size, qstart, result);
+    else if ((scanSimdLevel != SCAN_SIMD_NONE) && (size >= 8))
+        scan_CheckEnd_avx2<A>(idBase, ids, ends, size, qstart, result);
+    else
+        scan_CheckEnd_scalar<A>(idBase, ids, ends, size, qstart, result);
+}
+
+
+template <class A>
+static inline void scan_CheckBoth(RecordId idBase, const LocalRecordId *ids, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qstart, LocalTimestamp qend, typename A::Result &result)
+{
+    if ((scanSimdLevel == SCAN_SIMD_AVX512) && (size >= 16))
+        scan_CheckBoth_avx512<A>(idBase, ids, timestamps, size, qstart, qend, result);
+    else if ((scanSimdLevel != SCAN_SIMD_NONE) && (size >= 8))
+        scan_CheckBoth_avx2<A>(idBase, ids, timestamps, size, qstart, qend, result);
+    else
+        scan_CheckBoth_scalar<A>(idBase, ids, timestamps, size, qstart, qend, result);
+}
+
+
+// Sorted runs: OrgsIn and OrgsAft entries sorted on start, RepsIn entries sorted on end.
+// A binary search cuts the run into a part that needs no comparisons and a part that needs at most one.
+// The vector kernels sweep short runs faster than the search locates the cut, only runs of at least
+// SCAN_SORTED_MIN_SIZE entries are worth it.
+#define SCAN_SORTED_MIN_SIZE 1024
+
+// Number of leading entries whose key is below t (orEqual == false) or at most t (orEqual == true);
+// branchless, the compiler turns the step into a conditional move.
+template <class T, class Key>
+static inline size_t countKeys(const T *entries, size_t size, LocalTimestamp t, bool orEqual, Key key)
+{
+    const T *base = entries;
+    
+    if (size == 0)
+        return 0;
+    while (size > 1)
+    {
+        size_t half = size/2;
+        
+        base = ((orEqual)? (key(base[half-1]) <= t): (key(base[half-1]) < t))? base+half: base;
+        size -= half;
+    }
+    
+    return (base-entries) + ((orEqual)? (key(*base) <= t): (key(*base) < t));
+}
+
+
+static inline size_t countStartsUpTo(const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp t)
+{
+    return countKeys(timestamps, size, t, true, [](const pair<LocalTimestamp, LocalTimestamp> &p) { return p.first; });
+}
+
+
+static inline size_t countStartsBelow(const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp t)
+{
+    return countKeys(timestamps, size, t, false, [](const pair<LocalTimestamp, LocalTimestamp> &p) { return p.first; });
+}
+
+
+static inline size_t countUpTo(const LocalTimestamp *endpoints, size_t size, LocalTimestamp t)
+{
+    return countKeys(endpoints, size, t, true, [](LocalTimestamp e) { return e; });
+}
+
+
+static inline size_t countBelow(const LocalTimestamp *endpoints, size_t size, LocalTimestamp t)
+{
+    return countKeys(endpoints, size, t, false, [](LocalTimestamp e) { return e; });
+}
+
+
+template <class A>
+static inline void scanSorted_CheckStart(RecordId idBase, const LocalRecordId *ids, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qend, typename A::Result &result)
+{
+    scan_NoChecks<A>(idBase, ids, countStartsUpTo(timestamps, size, qend), result);
+}
+
+
+// An entry starting at or after qstart also ends at or after it, only the ones starting before qstart are compared.
+template <class A>
+static inline void scanSorted_CheckEnd(RecordId idBase, const LocalRecordId *ids, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qstart, typename A::Result &result)
+{
+    size_t cut = countStartsBelow(timestamps, size, qstart);
+
+    scan_CheckEnd<A>(idBase, ids, timestamps, cut, qstart, result);
+    scan_NoChecks<A>(idBase, ids+cut, size-cut, result);
+}
+
+
+template <class A>
+static inline void scanSorted_CheckBoth(RecordId idBase, const LocalRecordId *ids, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qstart, LocalTimestamp qend, typename A::Result &result)
+{
+    scanSorted_CheckEnd<A>(idBase, ids, timestamps, countStartsUpTo(timestamps, size, qend), qstart, result);
+}
+
+
+template <class A>
+static inline void scanSorted_CheckStart(RecordId idBase, const LocalRecordId *ids, const LocalTimestamp *starts, size_t size, LocalTimestamp qend, typename A::Result &result)
+{
+    scan_NoChecks<A>(idBase, ids, countUpTo(starts, size, qend), result);
+}
+
+
+template <class A>
+static inline void scanSorted_CheckEnd(RecordId idBase, const LocalRecordId *ids, const LocalTimestamp *ends, size_t size, LocalTimestamp qstart, typename A::Result &result)
+{
+    size_t cut = countBelow(ends, size, qstart);
+
+    scan_NoChecks<A>(idBase, ids+cut, size-cut, result);
+}
+
+
+// Payload kernels: the same scans aggregating the payloads of the entries that pass, which lie at the same positions as their ids.
+// Each comparison selects either the payload or the identity of each part of the aggregate, so the loops have no branches.
+static inline void scanPayloads_NoChecks(const Payload *payloads, size_t size, PayloadAggregate &result)
+{
+    PayloadAggregate aggregate;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        aggregate.sum += payloads[i];
+        aggregate.min = min(aggregate.min, payloads[i]);
+        aggregate.max = max(aggregate.max, payloads[i]);
+    }
+    result.merge(aggregate);
+}
+
+
+template <class T, class Pass>
+static inline void scanPayloads(const Payload *payloads, const T *timestamps, size_t size, Pass pass, PayloadAggregate &result)
+{
+    PayloadAggregate aggregate;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        bool passed = pass(timestamps[i]);
+
+        aggregate.sum += (passed)? payloads[i]: 0;
+        aggregate.min = min(aggregate.min, (passed)? payloads[i]: numeric_limits<Payload>::max());
+        aggregate.max = max(aggregate.max, (passed)? payloads[i]: numeric_limits<Payload>::min());
+    }
+    result.merge(aggregate);
+}
+
+
+static inline void scanPayloads_CheckStart(const Payload *payloads, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qend, PayloadAggregate &result)
+{
+    scanPayloads(payloads, timestamps, size, [qend](const pair<LocalTimestamp, LocalTimestamp> &t) { return (t.first <= qend); }, result);
+}
+
+
+static inline void scanPayloads_CheckEnd(const Payload *payloads, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qstart, PayloadAggregate &result)
+{
+    scanPayloads(payloads, timestamps, size, [qstart](const pair<LocalTimestamp, LocalTimestamp> &t) { return (qstart <= t.second); }, result);
+}
+
+
+static inline void scanPayloads_CheckStart(const Payload *payloads, const LocalTimestamp *starts, size_t size, LocalTimestamp qend, PayloadAggregate &result)
+{
+    scanPayloads(payloads, starts, size, [qend](LocalTimestamp start) { return (start <= qend); }, result);
+}
+
+
+static inline void scanPayloads_CheckEnd(const Payload *payloads, const LocalTimestamp *ends, size_t size, LocalTimestamp qstart, PayloadAggregate &result)
+{
+    scanPayloads(payloads, ends, size, [qstart](LocalTimestamp end) { return (qstart <= end); }, result);
+}
+
+
+static inline void scanPayloads_CheckBoth(const Payload *payloads, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qstart, LocalTimestamp qend, PayloadAggregate &result)
+{
+    scanPayloads(payloads, timestamps, size, [qstart, qend](const pair<LocalTimestamp, LocalTimestamp> &t) { return ((t.first <= qend) && (qstart <= t.second)); }, result);
+}
+
+
+static inline void scanSortedPayloads_CheckStart(const Payload *payloads, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qend, PayloadAggregate &result)
+{
+    scanPayloads_NoChecks(payloads, countStartsUpTo(timestamps, size, qend), result);
+}
+
+
+static inline void scanSortedPayloads_CheckEnd(const Payload *payloads, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qstart, PayloadAggregate &result)
+{
+    size_t cut = countStartsBelow(timestamps, size, qstart);
+
+    scanPayloads_CheckEnd(payloads, timestamps, cut, qstart, result);
+    scanPayloads_NoChecks(payloads+cut, size-cut, result);
+}
+
+
+static inline void scanSortedPayloads_CheckBoth(const Payload *payloads, const pair<LocalTimestamp, LocalTimestamp> *timestamps, size_t size, LocalTimestamp qstart, LocalTimestamp qend, PayloadAggregate &result)
+{
+    scanSortedPayloads_CheckEnd(payloads, timestamps, countStartsUpTo(timestamps, size, qend), qstart, result);
+}
+
+
+static inline void scanSortedPayloads_CheckStart(const Payload *payloads, const LocalTimestamp *starts, size_t size, LocalTimestamp qend, PayloadAggregate &result)
+{
+    scanPayloads_NoChecks(payloads, countUpTo(starts, size, qend), result);
+}
+
+
+static inline void scanSortedPayloads_CheckEnd(const Payload *payloads, const LocalTimestamp *ends, size_t size, LocalTimestamp qstart, PayloadAggregate &result)
+{
+    size_t cut = countBelow(ends, size, qstart);
+
+    scanPayloads_NoChecks(payloads+cut, size-cut, result);
+}
+#endif // _SCAN_KERNELS_H_
@@ -204,69 +204,41 @@ int main(int argc, char **argv)
 
                         tim.start();
                         if (first <= idxR[indexStart]->gend){
-#ifdef WORKLOAD_COUNT
-                            queryresult += idxR[indexStart]->executeTimeTravel_greaterthan(RangeQuery(numQueries, first, second), third);
-#else
-                            queryresult ^= idxR[indexStart]->executeTimeTravel_greaterthan(RangeQuery(numQueries, first, second), third);
-#endif
+                            WorkloadAggregator::merge(queryresult, idxR[indexStart]->executeTimeTravel_greaterthan(RangeQuery(numQueries, first, second), third));
                         }
                         i_querytime = tim.stop();
 
                         for(int i = indexStart+1; i < indexEnd; i++){
                             tim.start();
-#ifdef WORKLOAD_COUNT
-                            queryresult += lidxR[i]->execute_pureTimeTravel(RangeQuery(numQueries, first, second));
-#else
-                            queryresult ^= lidxR[i]->execute_pureTimeTravel(RangeQuery(numQueries, first, second));
-#endif
+                            WorkloadAggregator::merge(queryresult, lidxR[i]->execute_pureTimeTravel(RangeQuery(numQueries, first, second)));
                             b_querytime += tim.stop();
 
                             tim.start();
                             if (first <= idxR[i]->gend){
-#ifdef WORKLOAD_COUNT
-                                queryresult += idxR[i]->execute_pureTimeTravel(RangeQuery(numQueries, first, second));
-#else
-                                queryresult ^= idxR[i]->execute_pureTimeTravel(RangeQuery(numQueries, first, second));
-#endif
+                                WorkloadAggregator::merge(queryresult, idxR[i]->execute_pureTimeTravel(RangeQuery(numQueries, first, second)));
                             }
                                 i_querytime += tim.stop();
                         }
 
 
                         tim.start();
-#ifdef WORKLOAD_COUNT
-                        queryresult += lidxR[indexEnd]->executeTimeTravel_lowerthan(RangeQuery(numQueries, first, second), fourth);
-#else
-                        queryresult ^= lidxR[indexEnd]->executeTimeTravel_lowerthan(RangeQuery(numQueries, first, second), fourth);
-#endif
+                        WorkloadAggregator::merge(queryresult, lidxR[indexEnd]->executeTimeTravel_lowerthan(RangeQuery(numQueries, first, second), fourth));
                         b_querytime += tim.stop();
 
                         tim.start();
                         if (first <= idxR[indexEnd]->gend){
-#ifdef WORKLOAD_COUNT
-                            queryresult += idxR[indexEnd]->executeTimeTravel_lowerthan(RangeQuery(numQueries, first, second), fourth);
-#else
-                            queryresult ^= idxR[indexEnd]->executeTimeTravel_lowerthan(RangeQuery(numQueries, first, second), fourth);
-#endif
+                            WorkloadAggregator::merge(queryresult, idxR[indexEnd]->executeTimeTravel_lowerthan(RangeQuery(numQueries, first, second), fourth));
                         }
                         i_querytime += tim.stop();
                     }
                     else{
                         tim.start();
-#ifdef WORKLOAD_COUNT
                         queryresult = lidxR[indexStart]->execute_rangeTimeTravel(RangeQuery(numQueries, first, second), third, fourth);
-#else
-                        queryresult = lidxR[indexStart]->execute_rangeTimeTravel(RangeQuery(numQueries, first, second), third, fourth);
-#endif
                         b_querytime = tim.stop();
 
                         tim.start();
                         if (first <= idxR[indexStart]->gend){
-#ifdef WORKLOAD_COUNT
-                            queryresult += idxR[indexStart]->execute_rangeTimeTravel(RangeQuery(numQueries, first, second), third, fourth);
-#else
-                            queryresult ^= idxR[indexStart]->execute_rangeTimeTravel(RangeQuery(numQueries, first, second), third, fourth);
-#endif
+                            WorkloadAggregator::merge(queryresult, idxR[indexStart]->execute_rangeTimeTravel(RangeQuery(numQueries, first, second), third, fourth));
                         }
                         i_querytime = tim.stop();
                     }
@@ -307,13 +279,7 @@ int main(int argc, char **argv)
     cout << "Queries report" << endl;
     cout << "Num of queries                     : " << numQueries << endl;
     cout << "Num of runs per query              : " << settings.numRuns << endl;
-    cout << "Total result [";
-#ifdef WORKLOAD_COUNT
-    cout << "COUNT]               : ";
-#else
-    cout << "XOR]                 : ";
-#endif
-    cout << totalResult << endl;
+    cout << "Total result [" << WorkloadAggregator::NAME << "]" << string(20-strlen(WorkloadAggregator::NAME), ' ') << ": " << totalResult << endl;
     printf( "Total querying time (buffer) [secs]: %f\n", totalQueryTime_b/settings.numRuns);
     printf( "Total querying time (index)  [secs]: %f\n\n", totalQueryTime_i/settings.numRuns);
 
@@ -53,6 +53,7 @@ int main(int argc, char **argv){
     size_t totalResult = 0, totalFossilResults = 0, queryresult = 0, numQueries = 0, numUpdates = 0, numFossilizations = 0;
 
     Timestamp first, second, startEndpoint, leafPartitionExtent = 0, maxDuration = -1;
+    Timestamp nextFreezeTime = 0;
     Timestamp Tf = 0;
 
     double totalBufferStartTime = 0, totalBufferEndTime = 0, totalIndexEndTime = 0, totalFossilizationTime = 0;
@@ -60,6 +61,7 @@ int main(int argc, char **argv){
     double unused1, unused2; // Dummy variables consuming the data stream
     double memoryThreshold = 50 * (1024 * 1024);
     
+    vector<QueryResult> limitResults; // Results of a query under a limit
     char operation;
     string typeBuffer, queryFile;
     
@@ -71,10 +73,18 @@ int main(int argc, char **argv){
         usage("fossilLIT_recon");
         return 1;
     }
+    if (isPayloadAggregation(settings.typeAggregation)) {
+        cerr << "Error: payload aggregations are supported by pureLIT only" << endl;
+        return 1;
+    }
 
     // Create indexes
     liveIndex = createLiveIndex(typeBuffer, maxCapacity, maxDuration);
     deadIndex = new HINT_Reconstructable(leafPartitionExtent);
+    if (settings.limit > 0)
+        deadIndex->enableEndpoints();
+    deadIndex->setQueryThreads(settings.numThreads);
+    deadIndex->setCompression(settings.compressFrozen);
     FossilIndex fossilIndex("fossil_index.db");
 
     // Load stream
@@ -86,16 +96,16 @@ int main(int argc, char **argv){
     }
 
     // Explanation:
-    // Operation is S/E to start/end an interval, or Q to query.
-    // Fist is the inteval ID if S/E, or query start time if Q.
-    // Second is the start/end time if S/E, or query end time if Q.
+    // Operation is S/E to start/end an interval, Q to query a range, or P to query a point (stabbing query).
+    // Fist is the inteval ID if S/E, query start time if Q, or the point if P.
+    // Second is the start/end time if S/E, query end time if Q, and is not used if P.
     // unused1 is the end time but is not used
     // unused2 is only used by aLit. It is probably extra attribute to index.
     bool flag = true;
     while (fQ >> operation >> first >> second >> unused1 >> unused2){
         if (operation == 'S') {
             numUpdates++;
-            int id = first;
+            RecordId id = first;
             Timestamp startTime = second;
 
             tim.start();
@@ -104,7 +114,7 @@ int main(int argc, char **argv){
         }
         else if (operation == 'E') {
             numUpdates++;
-            int id = first;
+            RecordId id = first;
             Timestamp endTime = second;
 
             tim.start();
@@ -113,6 +123,12 @@ int main(int argc, char **argv){
 
             tim.start();
             deadIndex->insert(Record(id, startEndpoint, endTime));
+            
+            // Compact the partitions that can no longer receive inserts, checked once per leaf partition extent
+            if (endTime >= nextFreezeTime) {
+                deadIndex->freeze(liveIndex->getLowestStart());
+                nextFreezeTime = endTime + leafPartitionExtent;
+            }
             totalIndexEndTime += tim.stop();
 
             // Fossilize intervals
@@ -138,19 +154,62 @@ int main(int argc, char **argv){
             for (auto r = 0; r < settings.numRuns; r++){
                 tim.start();
                 // Question: Why does the query takes numQueries and uses it as id?
-                queryresult = liveIndex->execute_pureTimeTravel(RangeQuery(numQueries, qStart, qEnd));
+                queryresult = 0;
+                limitResults.clear();
+                runQuery(settings, liveIndex, RangeQuery(numQueries, qStart, qEnd), limitResults, queryresult);
                 totalQueryTime_b += tim.stop();
                 // Question: Is buffer time synonymous to live index time?
 
                 tim.start();
                 if (qStart <= deadIndex->gend){
-                    queryresult ^= deadIndex->execute_pureTimeTravel(RangeQuery(numQueries, qStart, qEnd));
+                    runQuery(settings, deadIndex, RangeQuery(numQueries, qStart, qEnd), limitResults, queryresult);
                 }
                 totalQueryTime_i += tim.stop();
 
                 tim.start();
                 if (qStart <= Tf){
-                    int temp = fossilIndex.query(qStart, qEnd);
+                    int temp;
+                    if (settings.limit > 0) {
+                        temp = limitResults.size();
+                        limitQuery(&fossilIndex, RangeQuery(numQueries, qStart, qEnd), settings.limit, limitResults);
+                        temp = limitResults.size() - temp;
+                    }
+                    else
+                        temp = fossilIndex.query(qStart, qEnd);
+                    totalFossilResults += temp;
+                    queryresult += temp;
+                }
+                totalQueryTimeFossil += tim.stop();
+            }
+            totalResult += queryresult;
+        }
+        else if (operation == 'P') {
+            Timestamp qPoint = first;
+            numQueries++;
+
+            for (auto r = 0; r < settings.numRuns; r++){
+                tim.start();
+                queryresult = 0;
+                limitResults.clear();
+                runQuery(settings, liveIndex, StabbingQuery(numQueries, qPoint), limitResults, queryresult);
+                totalQueryTime_b += tim.stop();
+
+                tim.start();
+                if (qPoint <= deadIndex->gend){
+                    runQuery(settings, deadIndex, StabbingQuery(numQueries, qPoint), limitResults, queryresult);
+                }
+                totalQueryTime_i += tim.stop();
+
+                tim.start();
+                if (qPoint <= Tf){
+                    int temp;
+                    if (settings.limit > 0) {
+                        temp = limitResults.size();
+                        limitQuery(&fossilIndex, StabbingQuery(numQueries, qPoint), settings.limit, limitResults);
+                        temp = limitResults.size() - temp;
+                    }
+                    else
+                        temp = fossilIndex.query(qPoint);
                     totalFossilResults += temp;
                     queryresult += temp;
                 }
@@ -184,7 +243,7 @@ int main(int argc, char **argv){
     cout << "Queries report" << endl;
     cout << "Num of queries                     : " << numQueries << endl;
     cout << "Num of runs per query              : " << settings.numRuns << endl;
-    cout << "Total result [XOR]                 : " << totalResult << endl;
+    cout << "Total result [" << getAggregationName(settings.typeAggregation) << "]" << string(20-strlen(getAggregationName(settings.typeAggregation)), ' ') << ": " << totalResult << endl;
     cout << "Total fossil results               : " << totalFossilResults << endl;
     cout << "Total querying time (buffer) [secs]: " << (totalQueryTime_b / settings.numRuns) << endl;
     cout << "Total querying time (index)  [secs]: " << (totalQueryTime_i / settings.numRuns) << endl;
@@ -3,11 +3,16 @@
 #include "./containers/relation.h"
 #include "./indices/live_index.cpp"
 #include "./indices/hint_m.h"
+#include "./indices/hint_m_segmented.h"
+#include "./indices/hint_m_logarithmic.h"
 
 using namespace std;
 
 // Creates Live Index
 LiveIndex* createLiveIndex(const string& typeBuffer, size_t maxCapacity, Timestamp maxDuration) {
+    // Single Fenwick tree, no capacity or duration constraint applies
+    if (typeBuffer == "FENWICK") return new LiveIndexFenwick();
+
     if (maxCapacity != -1) {
         if (typeBuffer == "MAP") return new LiveIndexCapacityConstraintedMap(maxCapacity);
         if (typeBuffer == "VECTOR") return new LiveIndexCapacityConstraintedVector(maxCapacity);
@@ -21,7 +26,14 @@ LiveIndex* createLiveIndex(const string& typeBuffer, size_t maxCapacity, Timesta
     throw invalid_argument("Invalid buffer type or constraints for Live Index.");
 }
 
-void displayMemoryUsage(LiveIndex* liveIndex, HINT_M_Dynamic* deadIndex) {
+// Creates Dead Index
+DeadIndex* createDeadIndex(Timestamp leafPartitionExtent, const RunSettings &settings) {
+    if (settings.segmentExtent > 0) return new HINT_M_Segmented(leafPartitionExtent, settings.segmentExtent);
+    if (settings.batchSize > 0) return new HINT_M_Logarithmic(leafPartitionExtent, settings.batchSize, settings.numThreads);
+    return new HINT_M_Dynamic(leafPartitionExtent);
+}
+
+void displayMemoryUsage(LiveIndex* liveIndex, DeadIndex* deadIndex) {
     size_t liveIndexSize = liveIndex->getMemoryUsage();
     size_t deadIndexSize = deadIndex->getMemoryUsage();
 
@@ -35,7 +47,7 @@ void displayMemoryUsage(LiveIndex* liveIndex, HINT_M_Dynamic* deadIndex) {
 
 int main(int argc, char **argv){
     Timer tim;
-    HINT_M_Dynamic *deadIndex;
+    DeadIndex *deadIndex;
     LiveIndex *liveIndex;
     RunSettings settings;
 
@@ -43,13 +55,20 @@ int main(int argc, char **argv){
     size_t totalResult = 0, queryresult = 0, numQueries = 0, numUpdates = 0;
 
     Timestamp first, second, startEndpoint, leafPartitionExtent = 0, maxDuration = -1;
+    Timestamp nextFreezeTime = 0;
     Timestamp Tf = 0;
 
     double totalBufferStartTime = 0, totalBufferEndTime = 0, totalIndexEndTime = 0;
     double totalQueryTime_b = 0, totalQueryTime_i = 0;
-    double unused1, unused2; // Dummy variables consuming the data stream
+    double totalRestartTime = 0, totalSnapshotTime = 0;
+    int64_t streamPosition = 0;
+    double unused1; // Dummy variable consuming the data stream
+    string lastField; // Payload of a start line, parsed as an integer: a double rounds it past 2^53
     double memoryThreshold = 50 * (1024 * 1024);
     
+    vector<QueryResult> limitResults; // Results of a query under a limit
+    PayloadAggregate queryPayloads; // Payloads of the results of a query, for the payload aggregations
+    Payload payload;
     char operation;
     string typeBuffer, queryFile;
     
@@ -61,41 +80,99 @@ int main(int argc, char **argv){
         usage("pureLIT");
         return 1;
     }
+    if ((settings.segmentExtent > 0) && (settings.batchSize > 0)) {
+        cerr << "Error: the dead index is either segmented or logarithmic" << endl;
+        return 1;
+    }
+    if (((settings.segmentExtent > 0) || (settings.batchSize > 0)) && (!settings.snapshotFile.empty())) {
+        cerr << "Error: snapshots are supported by the default dead index only" << endl;
+        return 1;
+    }
+    if ((settings.batchSize > 0) && (isPayloadAggregation(settings.typeAggregation))) {
+        cerr << "Error: the logarithmic dead index keeps no payloads" << endl;
+        return 1;
+    }
 
-    // Create indexes
+    // Create indexes, resuming from the snapshot if there is one
     liveIndex = createLiveIndex(typeBuffer, maxCapacity, maxDuration);
-    deadIndex = new HINT_M_Dynamic(leafPartitionExtent);
+    if ((!settings.snapshotFile.empty()) && (ifstream(settings.snapshotFile))) {
+        try {
+            tim.start();
+            auto snapshot = make_shared<Snapshot>(settings.snapshotFile);
+            streamPosition = snapshot->read<int64_t>();
+            nextFreezeTime = snapshot->read<Timestamp>();
+            liveIndex->load(*snapshot);
+            deadIndex = new HINT_M_Dynamic(snapshot);
+            totalRestartTime = tim.stop();
+        } catch (const exception& e) {
+            cerr << "Error: " << e.what() << endl;
+            return 1;
+        }
+    }
+    else {
+        deadIndex = createDeadIndex(leafPartitionExtent, settings);
+        if (isPayloadAggregation(settings.typeAggregation))
+            deadIndex->enablePayloads();
+        if (settings.limit > 0)
+            deadIndex->enableEndpoints();
+    }
+    if ((isPayloadAggregation(settings.typeAggregation)) && (!deadIndex->hasPayloads())) {
+        cerr << "Error: the snapshot keeps no payloads" << endl;
+        return 1;
+    }
+    if ((settings.limit > 0) && (!deadIndex->hasEndpoints())) {
+        cerr << "Error: the snapshot keeps no endpoints" << endl;
+        return 1;
+    }
+    deadIndex->setQueryThreads(settings.numThreads);
+    deadIndex->setCompression(settings.compressFrozen);
 
-    // Load stream
+    // Load stream, skipping the part the snapshot covers
     settings.queryFile = argv[optind];
     ifstream fQ(settings.queryFile);
     if (!fQ){
         usage("pureLIT");
         return 1;
     }
+    fQ.seekg(streamPosition);
 
     bool flag = true;
-    while (fQ >> operation >> first >> second >> unused1 >> unused2){
+    while (fQ >> operation >> first >> second >> unused1 >> lastField){
         if (operation == 'S') {
             numUpdates++;
-            int id = first;
+            RecordId id = first;
             Timestamp startTime = second;
 
             tim.start();
-            liveIndex->insert(id, startTime);
+            if (isPayloadAggregation(settings.typeAggregation))
+                liveIndex->insert_payload(id, startTime, Payload(strtoll(lastField.c_str(), NULL, 10)));
+            else
+                liveIndex->insert(id, startTime);
             totalBufferStartTime += tim.stop();
         }
         else if (operation == 'E') {
             numUpdates++;
-            int id = first;
+            RecordId id = first;
             Timestamp endTime = second;
 
             tim.start();
-            startEndpoint = liveIndex->remove(id); 
+            if (isPayloadAggregation(settings.typeAggregation))
+                startEndpoint = liveIndex->remove_payload(id, payload);
+            else
+                startEndpoint = liveIndex->remove(id); 
             totalBufferEndTime += tim.stop();
 
             tim.start();
-            deadIndex->insert(Record(id, startEndpoint, endTime));
+            if (isPayloadAggregation(settings.typeAggregation))
+                deadIndex->insert(Record(id, startEndpoint, endTime), payload);
+            else
+                deadIndex->insert(Record(id, startEndpoint, endTime));
+            
+            // Compact the partitions that can no longer receive inserts, checked once per leaf partition extent
+            if (endTime >= nextFreezeTime) {
+                deadIndex->freeze(liveIndex->getLowestStart());
+                nextFreezeTime = endTime + leafPartitionExtent;
+            }
             totalIndexEndTime += tim.stop();
         }
         else if (operation == 'Q') {
@@ -105,20 +182,61 @@ int main(int argc, char **argv){
 
             for (auto r = 0; r < settings.numRuns; r++){
                 tim.start();
-                queryresult = liveIndex->execute_pureTimeTravel(RangeQuery(numQueries, qStart, qEnd));
+                queryresult = 0;
+                limitResults.clear();
+                queryPayloads = PayloadAggregate();
+                runQuery(settings, liveIndex, RangeQuery(numQueries, qStart, qEnd), limitResults, queryPayloads, queryresult);
                 totalQueryTime_b += tim.stop();
 
                 tim.start();
                 if (qStart <= deadIndex->gend)
-                    queryresult ^= deadIndex->execute_pureTimeTravel(RangeQuery(numQueries, qStart, qEnd));
+                    runQuery(settings, deadIndex, RangeQuery(numQueries, qStart, qEnd), limitResults, queryPayloads, queryresult);
+                totalQueryTime_i += tim.stop();
+            }
+            totalResult += queryresult;
+        }
+        else if (operation == 'P') {
+            Timestamp qPoint = first;
+            numQueries++;
+
+            for (auto r = 0; r < settings.numRuns; r++){
+                tim.start();
+                queryresult = 0;
+                limitResults.clear();
+                queryPayloads = PayloadAggregate();
+                runQuery(settings, liveIndex, StabbingQuery(numQueries, qPoint), limitResults, queryPayloads, queryresult);
+                totalQueryTime_b += tim.stop();
+
+                tim.start();
+                if (qPoint <= deadIndex->gend)
+                    runQuery(settings, deadIndex, StabbingQuery(numQueries, qPoint), limitResults, queryPayloads, queryresult);
                 totalQueryTime_i += tim.stop();
             }
             totalResult += queryresult;
         }
         maxNumBuffers = max(maxNumBuffers, liveIndex->getNumBuffers());
     }
+    fQ.clear();
+    streamPosition = fQ.tellg();
     fQ.close();
 
+    // Checkpoint for the next run
+    if (!settings.snapshotFile.empty()) {
+        try {
+            tim.start();
+            SnapshotWriter writer(settings.snapshotFile);
+            writer.write(streamPosition);
+            writer.write(nextFreezeTime);
+            liveIndex->save(writer);
+            deadIndex->save(writer);
+            writer.close();
+            totalSnapshotTime = tim.stop();
+        } catch (const exception& e) {
+            cerr << "Error: " << e.what() << endl;
+            return 1;
+        }
+    }
+
     // Report
     cout << endl << "purelLIT" << endl;
     cout << "====================" << endl << endl;
@@ -134,11 +252,15 @@ int main(int argc, char **argv){
     cout << "Num of buffers  (max)              : " << maxNumBuffers << endl;
     cout << "Total updating time (buffer) [secs]: " << (totalBufferStartTime + totalBufferEndTime) << endl;
     cout << "Total updating time (index)  [secs]: " << totalIndexEndTime << endl;
+    if (!settings.snapshotFile.empty()) {
+        cout << "Restart time (snapshot)      [secs]: " << totalRestartTime << endl;
+        cout << "Checkpoint time (snapshot)   [secs]: " << totalSnapshotTime << endl;
+    }
 
     cout << "Queries report" << endl;
     cout << "Num of queries                     : " << numQueries << endl;
     cout << "Num of runs per query              : " << settings.numRuns << endl;
-    cout << "Total result [XOR]                 : " << totalResult << endl;
+    cout << "Total result [" << getAggregationName(settings.typeAggregation) << "]" << string(20-strlen(getAggregationName(settings.typeAggregation)), ' ') << ": " << totalResult << endl;
     cout << "Total querying time (buffer) [secs]: " << (totalQueryTime_b / settings.numRuns) << endl;
     cout << "Total querying time (index)  [secs]: " << (totalQueryTime_i / settings.numRuns) << endl;
 
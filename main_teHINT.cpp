@@ -200,13 +200,7 @@ int main(int argc, char **argv)
     cout << "Queries report" << endl;
     cout << "Num of queries                     : " << numQueries << endl;
     cout << "Num of runs per query              : " << settings.numRuns << endl;
-    cout << "Total result [";
-#ifdef WORKLOAD_COUNT
-    cout << "COUNT]               : ";
-#else
-    cout << "XOR]                 : ";
-#endif
-    cout << totalResult << endl;
+    cout << "Total result [" << WorkloadAggregator::NAME << "]" << string(20-strlen(WorkloadAggregator::NAME), ' ') << ": " << totalResult << endl;
     printf( "Total querying time (index)  [secs]: %f\n\n", totalQueryTime_i/settings.numRuns);
 
 
@@ -0,0 +1,67 @@
+#!/bin/bash
+# Runs the pureLIT and fossilLIT executables on tests/NS.mix and compares their totals against those of a brute-force scan.
+# The stream has 1200 intervals with nanosecond timestamps from 1.7e18: half of them last up to 1 ms, most others 0.1 to 6 seconds
+# and some 10 to 90 seconds, and the ids of the last 400 lie 2^32 past the first ones; its queries include stabbing queries into the past.
+# Run from the root of the repository after make all, e.g., with make test.
+
+STREAM=tests/NS.mix
+XOR=249108276618
+COUNT=44261
+SUM=45741425160740
+LIMIT10=3673
+SETTINGS="-e 1000000 -b ENHANCEDHASHMAP -c 100"
+
+TMPDIR=$(mktemp -d)
+trap 'rm -rf $TMPDIR; rm -f fossil_index.db.*' EXIT
+numFailed=0
+
+
+# check <name> <expected> <executable> <options>
+check()
+{
+    local name=$1 expected=$2 executable=$3
+    shift 3
+    local result=$(./$executable $SETTINGS "$@" $STREAM 2>&1 | grep "Total result" | awk '{print $NF}')
+
+    rm -f fossil_index.db.*
+    if [ "$result" == "$expected" ]; then
+        echo "PASS  $name"
+    else
+        echo "FAIL  $name: got '$result', expected $expected"
+        numFailed=$((numFailed+1))
+    fi
+}
+
+
+for executable in query_pureLIT.exec query_fossilLIT_delete.exec query_fossilLIT_recon.exec; do
+    check "$executable XOR"            $XOR     $executable -a XOR
+    check "$executable COUNT"          $COUNT   $executable -a COUNT
+    check "$executable SUM"            $SUM     $executable -a SUM
+    check "$executable compressed"     $XOR     $executable -a XOR -z
+    check "$executable 4 threads"      $XOR     $executable -a XOR -t 4
+    check "$executable limit"          $LIMIT10 $executable -k 10
+    check "$executable MAP live index" $XOR     $executable -a XOR -b MAP -c 50
+    if [ $executable != query_fossilLIT_recon.exec ]; then
+        check "$executable segmented"   $XOR $executable -a XOR -g 10000000000
+        check "$executable logarithmic" $XOR $executable -a XOR -l 100
+    fi
+done
+check "query_pureLIT.exec FENWICK live index" $XOR query_pureLIT.exec -a XOR -b FENWICK
+
+# A run resumed from the snapshot of a prefix of the stream answers the rest of the queries
+head -n 2000 $STREAM > $TMPDIR/prefix.mix
+first=$(./query_pureLIT.exec $SETTINGS -a XOR -s $TMPDIR/snapshot $TMPDIR/prefix.mix 2>&1 | grep "Total result" | awk '{print $NF}')
+rest=$(./query_pureLIT.exec $SETTINGS -a XOR -s $TMPDIR/snapshot $STREAM 2>&1 | grep "Total result" | awk '{print $NF}')
+if [ -n "$first" ] && [ -n "$rest" ] && [ $((first+rest)) == $XOR ]; then
+    echo "PASS  query_pureLIT.exec snapshot"
+else
+    echo "FAIL  query_pureLIT.exec snapshot: got '$first' + '$rest', expected $XOR in total"
+    numFailed=$((numFailed+1))
+fi
+
+
+if [ $numFailed -gt 0 ]; then
+    echo "$numFailed test(s) failed"
+    exit 1
+fi
+echo "All tests passed"
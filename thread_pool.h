@@ -0,0 +1,114 @@
+#ifndef _THREAD_POOL_H_
+#define _THREAD_POOL_H_
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+using namespace std;
+
+
+
+// Fixed pool for fork-join parallelism: run(n, f) calls f(0), ..., f(n-1) on the workers and the calling thread,
+// and returns once all of them are done. Tasks are handed out dynamically, one at a time.
+class ThreadPool
+{
+private:
+    vector<thread> workers;
+    mutex m;
+    condition_variable cvWork, cvDone;
+    const function<void(size_t)> *job;
+    size_t numTasks;
+    atomic<size_t> nextTask, numDone;
+    unsigned int generation, numActive;
+    bool stop;
+
+    void work()
+    {
+        size_t t;
+
+        while ((t = this->nextTask.fetch_add(1)) < this->numTasks)
+        {
+            (*this->job)(t);
+            this->numDone.fetch_add(1);
+        }
+    }
+
+    void workerLoop()
+    {
+        unsigned int seen = 0;
+
+        while (true)
+        {
+            {
+                unique_lock<mutex> lock(this->m);
+
+                this->cvWork.wait(lock, [&] { return (this->stop) || (this->generation != seen); });
+                if (this->stop)
+                    return;
+                seen = this->generation;
+                this->numActive++;
+            }
+            this->work();
+            {
+                lock_guard<mutex> lock(this->m);
+
+                this->numActive--;
+            }
+            this->cvDone.notify_all();
+        }
+    }
+
+public:
+    // numThreads counts the calling thread, which takes part in every run.
+    ThreadPool(unsigned int numThreads) : job(NULL), numTasks(0), nextTask(0), numDone(0), generation(0), numActive(0), stop(false)
+    {
+        for (unsigned int i = 1; i < numThreads; i++)
+            this->workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool& operator=(const ThreadPool &) = delete;
+
+    ~ThreadPool()
+    {
+        {
+            lock_guard<mutex> lock(this->m);
+
+            this->stop = true;
+        }
+        this->cvWork.notify_all();
+        for (auto &w : this->workers)
+            w.join();
+    }
+
+    unsigned int getNumThreads() const
+    {
+        return this->workers.size()+1;
+    }
+
+    void run(size_t numTasks, const function<void(size_t)> &f)
+    {
+        {
+            unique_lock<mutex> lock(this->m);
+
+            // Workers still leaving the previous run must not see this one half set up
+            this->cvDone.wait(lock, [&] { return this->numActive == 0; });
+            this->job      = &f;
+            this->numTasks = numTasks;
+            this->nextTask = 0;
+            this->numDone  = 0;
+            this->generation++;
+        }
+        this->cvWork.notify_all();
+        this->work();
+
+        unique_lock<mutex> lock(this->m);
+
+        this->cvDone.wait(lock, [&] { return (this->numDone == this->numTasks) && (this->numActive == 0); });
+    }
+};
+#endif // _THREAD_POOL_H_
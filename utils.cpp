@@ -187,6 +187,43 @@ void process_mem_usage(double& vm_usage, double& resident_set)
 }
 
 // Display instructions
+bool checkAggregation(string strAggregation, RunSettings &settings)
+{
+    if (strAggregation == "COUNT")
+    {
+        settings.typeAggregation = AGGREGATION_COUNT;
+        return true;
+    }
+    else if (strAggregation == "XOR")
+    {
+        settings.typeAggregation = AGGREGATION_XOR;
+        return true;
+    }
+    else if (strAggregation == "SUM")
+    {
+        settings.typeAggregation = AGGREGATION_SUM;
+        return true;
+    }
+    else if (strAggregation == "PAYLOAD_SUM")
+    {
+        settings.typeAggregation = AGGREGATION_PAYLOAD_SUM;
+        return true;
+    }
+    else if (strAggregation == "PAYLOAD_MIN")
+    {
+        settings.typeAggregation = AGGREGATION_PAYLOAD_MIN;
+        return true;
+    }
+    else if (strAggregation == "PAYLOAD_MAX")
+    {
+        settings.typeAggregation = AGGREGATION_PAYLOAD_MAX;
+        return true;
+    }
+    
+    return false;
+}
+
+
 void usage(string indexName){
     cerr << endl << "PROJECT" << endl;
     cerr << "       LIT Variant: " << indexName << endl << endl;
@@ -196,13 +233,32 @@ void usage(string indexName){
     cerr << "       -e" << endl;
     cerr << "              set the leaf partition extent; it is set in seconds" << endl;
     cerr << "       -b" << endl;
-    cerr << "              set the type of data structure for the LIVE INDEX" << endl;
+    cerr << "              set the type of data structure for the LIVE INDEX; MAP, VECTOR, ENHANCEDHASHMAP or FENWICK" << endl;
     cerr << "       -c" << endl;
     cerr << "              set the capacity constraint number for the LIVE INDEX" << endl; 
     cerr << "       -d" << endl;
     cerr << "              set the duration constraint number for the LIVE INDEX" << endl;      
     cerr << "       -r runs" << endl;
-    cerr << "              set the number of runs per query; by default 1" << endl << endl;
+    cerr << "              set the number of runs per query; by default 1" << endl;
+    cerr << "       -t threads" << endl;
+    cerr << "              set the number of threads for rebuilding the DEAD INDEX, and for scanning its large SUM and payload queries; by default 1" << endl;
+    cerr << "       -s file" << endl;
+    cerr << "              resume from the snapshot in file if it exists, and write one there at the end of the stream; pureLIT only" << endl;
+    cerr << "       -z" << endl;
+    cerr << "              bit-pack the partitions of the DEAD INDEX that no longer receive inserts" << endl;
+    cerr << "       -a aggregation" << endl;
+    cerr << "              set the aggregation of the query results; COUNT, XOR or SUM (of ids); by default XOR, or COUNT if built with WORKLOAD_COUNT" << endl;
+    cerr << "              or PAYLOAD_SUM, PAYLOAD_MIN or PAYLOAD_MAX of the payloads of the results, read from the last column of the starts; pureLIT only" << endl;
+    cerr << "              the FOSSIL INDEX always counts" << endl;
+    cerr << "       -k limit" << endl;
+    cerr << "              answer each query with at most limit results, pulled through the query cursors tier by tier, and count them;" << endl;
+    cerr << "              -k 1 tests for existence" << endl;
+    cerr << "       -g extent" << endl;
+    cerr << "              split the DEAD INDEX into segments of extent, with the intervals that cross them in an index of their own;" << endl;
+    cerr << "              pureLIT and fossilLIT_delete only" << endl;
+    cerr << "       -l size" << endl;
+    cerr << "              build the DEAD INDEX with the logarithmic method: batches of size intervals become static indices," << endl;
+    cerr << "              merged when two hold as many intervals; not with -g or the payload aggregations, pureLIT and fossilLIT_delete only" << endl << endl;
     cerr << "EXAMPLE" << endl;
     cerr << "       ./query_" << indexName << ".exec -e 86400 -b ENHANCEDHASHMAP -c 10000 streams/BOOKS.mix" << endl << endl;
 }
@@ -214,7 +270,7 @@ void parseArguments(int argc, char** argv, RunSettings& settings, Timestamp& lea
     settings.init();
     settings.method = "fossilLIT";
 
-    while ((c = getopt(argc, argv, "q:e:c:d:b:r:")) != -1) {
+    while ((c = getopt(argc, argv, "q:e:c:d:b:r:t:s:za:k:g:l:")) != -1) {
         switch (c) {
             case 'e':
                 leafPartitionExtent = atoi(optarg);
@@ -231,6 +287,28 @@ void parseArguments(int argc, char** argv, RunSettings& settings, Timestamp& lea
             case 'r':
                 settings.numRuns = atoi(optarg);
                 break;
+            case 't':
+                settings.numThreads = atoi(optarg);
+                break;
+            case 's':
+                settings.snapshotFile = optarg;
+                break;
+            case 'z':
+                settings.compressFrozen = true;
+                break;
+            case 'a':
+                if (!checkAggregation(toUpperCase(optarg), settings))
+                    throw invalid_argument("Unknown aggregation.");
+                break;
+            case 'k':
+                settings.limit = atoi(optarg);
+                break;
+            case 'g':
+                settings.segmentExtent = atoi(optarg);
+                break;
+            case 'l':
+                settings.batchSize = atoi(optarg);
+                break;
             case '?':
             default:
                 throw invalid_argument("Invalid argument or option.");
@@ -240,5 +318,9 @@ void parseArguments(int argc, char** argv, RunSettings& settings, Timestamp& lea
     if (argc - optind != 1 || leafPartitionExtent <= 0) 
         throw invalid_argument("Invalid number of arguments. A stream file is required.");
 
+    // The results of a limited query are counted
+    if (settings.limit > 0)
+        settings.typeAggregation = AGGREGATION_COUNT;
+
     queryFile = argv[optind];
 }